@@ -0,0 +1,78 @@
+/*
+ * Host simulation stand-in for Adafruit_ZeroDMA.
+ *
+ * Only peripheral-to-memory jobs triggered by the ADC's RESRDY are modelled. startJob() takes the
+ * ADC configuration in sam.h as it is at that moment, fills the destination with the results of the
+ * free-running conversions and calls the callback when the last one would have been transferred,
+ * waking the MCU from IDLE.
+ */
+#ifndef SIM_ADAFRUIT_ZERODMA_H
+#define SIM_ADAFRUIT_ZERODMA_H
+
+#include "Arduino.h"
+
+enum ZeroDMAstatus {
+  DMA_STATUS_OK = 0,
+  DMA_STATUS_ERR_NOT_FOUND,
+  DMA_STATUS_ERR_NOT_INITIALIZED,
+  DMA_STATUS_ERR_INVALID_ARG,
+  DMA_STATUS_ERR_IO,
+  DMA_STATUS_ERR_TIMEOUT,
+  DMA_STATUS_BUSY,
+  DMA_STATUS_SUSPEND,
+  DMA_STATUS_ABORTED,
+  DMA_STATUS_JOBSTATUS = -1
+};
+
+enum dma_beat_size {
+  DMA_BEAT_SIZE_BYTE,
+  DMA_BEAT_SIZE_HWORD,
+  DMA_BEAT_SIZE_WORD,
+};
+
+enum dma_transfer_trigger_action {
+  DMA_TRIGGER_ACTON_BLOCK = 0,
+  DMA_TRIGGER_ACTON_BEAT = 2,
+  DMA_TRIGGER_ACTON_TRANSACTION = 3,
+};
+
+enum dma_callback_type {
+  DMA_CALLBACK_TRANSFER_ERROR,
+  DMA_CALLBACK_TRANSFER_DONE,
+  DMA_CALLBACK_CHANNEL_SUSPEND,
+  DMA_CALLBACK_N,
+};
+
+struct DmacDescriptor {
+  void *src;
+  void *dst;
+  uint32_t count;
+  dma_beat_size size;
+  bool src_inc;
+  bool dst_inc;
+};
+
+class Adafruit_ZeroDMA {
+  public:
+    ZeroDMAstatus allocate();
+    void setTrigger(uint8_t trigger);
+    void setAction(dma_transfer_trigger_action action);
+    DmacDescriptor *addDescriptor(void *src, void *dst, uint32_t count = 0,
+                                  dma_beat_size size = DMA_BEAT_SIZE_BYTE, bool srcInc = true,
+                                  bool dstInc = true, uint32_t stepSize = 0, bool stepSel = 0);
+    void setCallback(void (*callback)(Adafruit_ZeroDMA *) = NULL,
+                     dma_callback_type type = DMA_CALLBACK_TRANSFER_DONE);
+    ZeroDMAstatus startJob();
+    void abort();
+
+  private:
+    bool allocated = false;
+    bool busy = false;
+    uint8_t trigger = 0;
+    DmacDescriptor descriptor = {};
+    bool has_descriptor = false;
+    void (*done_callback)(Adafruit_ZeroDMA *) = NULL;
+    uint32_t job = 0;
+};
+
+#endif
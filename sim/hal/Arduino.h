@@ -0,0 +1,213 @@
+/*
+ * Host simulation stand-in for the Arduino SAMD core.
+ *
+ * Only the subset of the core used by the tri-sensor firmware is provided. Time is virtual: delay()
+ * advances the simulated clock instead of blocking, and millis()/micros() follow the SAMD21 SysTick,
+ * which does not run while the MCU is in deep sleep.
+ */
+#ifndef SIM_ARDUINO_H
+#define SIM_ARDUINO_H
+
+#include <ctype.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+
+#include "sam.h"
+
+// The SAMD core takes min/max from the standard library.
+using std::min;
+using std::max;
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define PROGMEM
+#define F(str) (str)
+
+#define LOW 0
+#define HIGH 1
+
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+
+#define DEC 10
+#define HEX 16
+#define BIN 2
+
+// MKR WiFi 1010 pin numbering
+#define LED_BUILTIN 6
+#define A0 15
+#define A1 16
+#define A2 17
+#define A3 18
+#define A4 19
+#define A5 20
+#define A6 21
+#define NINA_RESETN 27
+#define ADC_BATTERY 32
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void analogReadResolution(int bits);
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void randomSeed(unsigned long seed);
+long random(long howbig);
+long random(long howsmall, long howbig);
+
+char *itoa(int value, char *str, int base);
+char *ltoa(long value, char *str, int base);
+char *utoa(unsigned value, char *str, int base);
+char *ultoa(unsigned long value, char *str, int base);
+
+class String {
+  public:
+    String(const char *cstr = "") : buf(cstr ? cstr : "") {}
+    String(const String &str) = default;
+    String(char c) : buf(1, c) {}
+    String(unsigned char value, unsigned char base = 10);
+    String(int value, unsigned char base = 10);
+    String(unsigned int value, unsigned char base = 10);
+    String(long value, unsigned char base = 10);
+    String(unsigned long value, unsigned char base = 10);
+    String(float value, unsigned char decimal_places = 2);
+    String(double value, unsigned char decimal_places = 2);
+
+    String &operator=(const String &rhs) = default;
+    String &operator=(const char *cstr) { buf = cstr ? cstr : ""; return *this; }
+
+    String &operator+=(const String &rhs) { buf += rhs.buf; return *this; }
+    String &operator+=(const char *cstr) { buf += cstr; return *this; }
+    String &operator+=(char c) { buf += c; return *this; }
+    String &operator+=(int value) { return *this += String(value); }
+
+    bool concat(const String &rhs) { buf += rhs.buf; return true; }
+    bool concat(const char *cstr) { buf += cstr; return true; }
+    bool concat(char c) { buf += c; return true; }
+    bool reserve(unsigned int size) { buf.reserve(size); return true; }
+
+    friend String operator+(const String &lhs, const String &rhs) { String s(lhs); s += rhs; return s; }
+    friend String operator+(const String &lhs, const char *rhs) { String s(lhs); s += rhs; return s; }
+    friend String operator+(const char *lhs, const String &rhs) { String s(lhs); s += rhs; return s; }
+
+    bool operator==(const String &rhs) const { return buf == rhs.buf; }
+    bool operator==(const char *rhs) const { return buf == rhs; }
+    bool operator!=(const String &rhs) const { return buf != rhs.buf; }
+    bool operator!=(const char *rhs) const { return buf != rhs; }
+    char operator[](unsigned int index) const { return index < buf.size() ? buf[index] : 0; }
+
+    unsigned int length() const { return buf.size(); }
+    const char *c_str() const { return buf.c_str(); }
+    char charAt(unsigned int index) const { return (*this)[index]; }
+    int indexOf(char c) const { size_t i = buf.find(c); return i == std::string::npos ? -1 : (int) i; }
+    int toInt() const { return atoi(buf.c_str()); }
+
+  private:
+    std::string buf;
+};
+
+class Printable;
+
+class Print {
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size);
+    size_t write(const char *str) { return str ? write((const uint8_t *) str, strlen(str)) : 0; }
+    size_t write(const char *buffer, size_t size) { return write((const uint8_t *) buffer, size); }
+
+    size_t print(const char str[]) { return write(str); }
+    size_t print(const String &str) { return write(str.c_str(), str.length()); }
+    size_t print(char c) { return write((uint8_t) c); }
+    size_t print(unsigned char value, int base = DEC) { return print((unsigned long) value, base); }
+    size_t print(int value, int base = DEC) { return print((long) value, base); }
+    size_t print(unsigned int value, int base = DEC) { return print((unsigned long) value, base); }
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+    size_t print(double value, int digits = 2);
+    size_t print(const Printable &p);
+
+    template <typename T> size_t println(const T &value) { size_t n = print(value); return n + println(); }
+    template <typename T> size_t println(const T &value, int format) { size_t n = print(value, format); return n + println(); }
+    size_t println() { return write("\r\n"); }
+};
+
+class Printable {
+  public:
+    virtual ~Printable() {}
+    virtual size_t printTo(Print &p) const = 0;
+};
+
+class Stream : public Print {
+  public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+};
+
+class Client : public Stream {
+  public:
+    virtual int connect(const char *host, uint16_t port) = 0;
+    virtual uint8_t connected() = 0;
+    virtual void stop() = 0;
+    virtual operator bool() = 0;
+    using Print::write;
+};
+
+class IPAddress : public Printable {
+  public:
+    IPAddress() : bytes{0, 0, 0, 0} {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : bytes{a, b, c, d} {}
+    IPAddress(uint32_t address) { memcpy(bytes, &address, 4); }
+    IPAddress(const uint8_t *address) { memcpy(bytes, address, 4); }
+
+    operator uint32_t() const { uint32_t a; memcpy(&a, bytes, 4); return a; }
+    bool operator==(const IPAddress &rhs) const { return memcmp(bytes, rhs.bytes, 4) == 0; }
+    bool operator!=(const IPAddress &rhs) const { return !(*this == rhs); }
+    uint8_t operator[](int index) const { return bytes[index]; }
+    uint8_t &operator[](int index) { return bytes[index]; }
+
+    size_t printTo(Print &p) const override;
+
+  private:
+    uint8_t bytes[4];
+};
+
+class Serial_ : public Stream {
+  public:
+    void begin(unsigned long baud) { (void) baud; }
+    void end() {}
+    operator bool() { return true; }
+
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    void flush() {}
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+};
+
+extern Serial_ Serial;
+
+// Provided by the sketch.
+void setup();
+void loop();
+
+#endif
@@ -0,0 +1,337 @@
+/*
+ * Host simulation stand-in for ArduinoJson 6.
+ *
+ * Implements the document/object/array API the firmware uses and serializes the way ArduinoJson 6
+ * does: members in insertion order, no whitespace, floats with their shortest round-trip
+ * representation and NaN/Inf as null. Capacity limits are not enforced.
+ */
+#ifndef SIM_ARDUINOJSON_H
+#define SIM_ARDUINOJSON_H
+
+#include "Arduino.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Capacity helpers, same slot sizes as ArduinoJson 6 on a 32-bit target.
+#define JSON_ARRAY_SIZE(n) ((n) * 16)
+#define JSON_OBJECT_SIZE(n) ((n) * 16)
+
+namespace ArduinoJsonSim {
+
+struct Node;
+typedef std::shared_ptr<Node> NodePtr;
+
+struct Node {
+  enum Type { Null, Bool, Int, Uint, Float, Double, Str, Raw, Object, Array } type = Null;
+  bool b = false;
+  long long i = 0;
+  unsigned long long u = 0;
+  double d = 0;
+  std::string s;
+  std::vector<std::pair<std::string, NodePtr>> members;
+  std::vector<NodePtr> elements;
+
+  NodePtr member(const std::string &key) {
+    if (type != Object) {
+      *this = Node();
+      type = Object;
+    }
+    for (auto &m : members) {
+      if (m.first == key) return m.second;
+    }
+    members.emplace_back(key, std::make_shared<Node>());
+    return members.back().second;
+  }
+
+  NodePtr append() {
+    if (type != Array) {
+      *this = Node();
+      type = Array;
+    }
+    elements.push_back(std::make_shared<Node>());
+    return elements.back();
+  }
+
+  void make(Type t) {
+    *this = Node();
+    type = t;
+  }
+};
+
+struct RawJson {
+  std::string json;
+};
+
+inline void assign(Node &n, bool v) { n.make(Node::Bool); n.b = v; }
+inline void assign(Node &n, signed char v) { n.make(Node::Int); n.i = v; }
+inline void assign(Node &n, unsigned char v) { n.make(Node::Uint); n.u = v; }
+inline void assign(Node &n, short v) { n.make(Node::Int); n.i = v; }
+inline void assign(Node &n, unsigned short v) { n.make(Node::Uint); n.u = v; }
+inline void assign(Node &n, int v) { n.make(Node::Int); n.i = v; }
+inline void assign(Node &n, unsigned int v) { n.make(Node::Uint); n.u = v; }
+inline void assign(Node &n, long v) { n.make(Node::Int); n.i = v; }
+inline void assign(Node &n, unsigned long v) { n.make(Node::Uint); n.u = v; }
+inline void assign(Node &n, long long v) { n.make(Node::Int); n.i = v; }
+inline void assign(Node &n, unsigned long long v) { n.make(Node::Uint); n.u = v; }
+inline void assign(Node &n, float v) { n.make(Node::Float); n.d = v; }
+inline void assign(Node &n, double v) { n.make(Node::Double); n.d = v; }
+inline void assign(Node &n, const char *v) {
+  if (!v) { n.make(Node::Null); return; }
+  n.make(Node::Str);
+  n.s = v;
+}
+inline void assign(Node &n, char *v) { assign(n, (const char *) v); }
+inline void assign(Node &n, const String &v) { assign(n, v.c_str()); }
+inline void assign(Node &n, const RawJson &v) { n.make(Node::Raw); n.s = v.json; }
+inline void assign(Node &n, std::nullptr_t) { n.make(Node::Null); }
+
+inline void write(std::string &out, const Node &n);
+
+}
+
+inline ArduinoJsonSim::RawJson serialized(const char *json) { return {json}; }
+inline ArduinoJsonSim::RawJson serialized(const char *json, size_t n) { return {std::string(json, n)}; }
+inline ArduinoJsonSim::RawJson serialized(const String &json) { return {json.c_str()}; }
+
+class JsonObject;
+class JsonArray;
+
+class JsonVariant {
+  public:
+    JsonVariant() {}
+    explicit JsonVariant(ArduinoJsonSim::NodePtr node) : node(node) {}
+
+    template <typename T> JsonVariant &operator=(const T &value) {
+      if (node) ArduinoJsonSim::assign(*node, value);
+      return *this;
+    }
+    JsonVariant &operator=(const char *value) {
+      if (node) ArduinoJsonSim::assign(*node, value);
+      return *this;
+    }
+    JsonVariant &operator=(char *value) {
+      if (node) ArduinoJsonSim::assign(*node, value);
+      return *this;
+    }
+
+    bool isNull() const { return !node || node->type == ArduinoJsonSim::Node::Null; }
+    JsonObject createNestedObject(const char *key);
+    JsonArray createNestedArray(const char *key);
+    JsonVariant operator[](const char *key);
+
+    ArduinoJsonSim::NodePtr node;
+};
+
+class JsonObject {
+  public:
+    JsonObject() {}
+    explicit JsonObject(ArduinoJsonSim::NodePtr node) : node(node) {}
+
+    JsonVariant operator[](const char *key) { return JsonVariant(node ? node->member(key) : nullptr); }
+    JsonVariant operator[](const String &key) { return (*this)[key.c_str()]; }
+    JsonObject createNestedObject(const char *key);
+    JsonArray createNestedArray(const char *key);
+    bool isNull() const { return !node; }
+    size_t size() const { return node ? node->members.size() : 0; }
+
+    ArduinoJsonSim::NodePtr node;
+};
+
+class JsonArray {
+  public:
+    JsonArray() {}
+    explicit JsonArray(ArduinoJsonSim::NodePtr node) : node(node) {}
+
+    template <typename T> bool add(const T &value) {
+      if (!node) return false;
+      ArduinoJsonSim::assign(*node->append(), value);
+      return true;
+    }
+    bool add(const char *value) {
+      if (!node) return false;
+      ArduinoJsonSim::assign(*node->append(), value);
+      return true;
+    }
+    bool add(char *value) { return add((const char *) value); }
+    JsonObject createNestedObject() {
+      if (!node) return JsonObject();
+      ArduinoJsonSim::NodePtr n = node->append();
+      n->make(ArduinoJsonSim::Node::Object);
+      return JsonObject(n);
+    }
+    JsonArray createNestedArray() {
+      if (!node) return JsonArray();
+      ArduinoJsonSim::NodePtr n = node->append();
+      n->make(ArduinoJsonSim::Node::Array);
+      return JsonArray(n);
+    }
+    bool isNull() const { return !node; }
+    size_t size() const { return node ? node->elements.size() : 0; }
+
+    ArduinoJsonSim::NodePtr node;
+};
+
+inline JsonObject JsonObject::createNestedObject(const char *key) {
+  if (!node) return JsonObject();
+  ArduinoJsonSim::NodePtr n = node->member(key);
+  n->make(ArduinoJsonSim::Node::Object);
+  return JsonObject(n);
+}
+
+inline JsonArray JsonObject::createNestedArray(const char *key) {
+  if (!node) return JsonArray();
+  ArduinoJsonSim::NodePtr n = node->member(key);
+  n->make(ArduinoJsonSim::Node::Array);
+  return JsonArray(n);
+}
+
+inline JsonObject JsonVariant::createNestedObject(const char *key) { return JsonObject(node).createNestedObject(key); }
+inline JsonArray JsonVariant::createNestedArray(const char *key) { return JsonObject(node).createNestedArray(key); }
+inline JsonVariant JsonVariant::operator[](const char *key) { return JsonObject(node)[key]; }
+
+class JsonDocument {
+  public:
+    explicit JsonDocument(size_t capacity) : cap(capacity), root(std::make_shared<ArduinoJsonSim::Node>()) {}
+
+    JsonVariant operator[](const char *key) { return JsonVariant(root->member(key)); }
+    JsonVariant operator[](const String &key) { return (*this)[key.c_str()]; }
+    JsonObject createNestedObject(const char *key) { return JsonObject(root).createNestedObject(key); }
+    JsonArray createNestedArray(const char *key) { return JsonObject(root).createNestedArray(key); }
+    JsonObject createNestedObject() {
+      if (root->type != ArduinoJsonSim::Node::Array) root->make(ArduinoJsonSim::Node::Array);
+      return JsonArray(root).createNestedObject();
+    }
+
+    template <typename T> bool add(const T &value) {
+      if (root->type != ArduinoJsonSim::Node::Array) root->make(ArduinoJsonSim::Node::Array);
+      return JsonArray(root).add(value);
+    }
+
+    template <typename T> T to();
+
+    void clear() { root->make(ArduinoJsonSim::Node::Null); }
+    bool isNull() const { return root->type == ArduinoJsonSim::Node::Null; }
+    bool overflowed() const { return false; }
+    size_t capacity() const { return cap; }
+
+    const ArduinoJsonSim::Node &data() const { return *root; }
+
+  private:
+    size_t cap;
+    ArduinoJsonSim::NodePtr root;
+};
+
+template <> inline JsonObject JsonDocument::to<JsonObject>() { root->make(ArduinoJsonSim::Node::Object); return JsonObject(root); }
+template <> inline JsonArray JsonDocument::to<JsonArray>() { root->make(ArduinoJsonSim::Node::Array); return JsonArray(root); }
+
+template <size_t N> class StaticJsonDocument : public JsonDocument {
+  public:
+    StaticJsonDocument() : JsonDocument(N) {}
+};
+
+class DynamicJsonDocument : public JsonDocument {
+  public:
+    explicit DynamicJsonDocument(size_t capacity) : JsonDocument(capacity) {}
+};
+
+inline size_t measureJson(const JsonDocument &doc) {
+  std::string out;
+  ArduinoJsonSim::write(out, doc.data());
+  return out.size();
+}
+
+inline size_t serializeJson(const JsonDocument &doc, String &output) {
+  std::string out;
+  ArduinoJsonSim::write(out, doc.data());
+  output = out.c_str();
+  return out.size();
+}
+
+inline size_t serializeJson(const JsonDocument &doc, char *output, size_t size) {
+  std::string out;
+  ArduinoJsonSim::write(out, doc.data());
+  if (size == 0) return 0;
+  size_t n = out.size() < size - 1 ? out.size() : size - 1;
+  memcpy(output, out.data(), n);
+  output[n] = 0;
+  return n;
+}
+
+inline size_t serializeJson(const JsonDocument &doc, Print &output) {
+  std::string out;
+  ArduinoJsonSim::write(out, doc.data());
+  return output.write((const uint8_t *) out.data(), out.size());
+}
+
+namespace ArduinoJsonSim {
+
+inline void write_string(std::string &out, const std::string &s) {
+  out += '"';
+  for (char c : s) {
+    switch (c) {
+      case '"': out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\b': out += "\\b"; break;
+      case '\f': out += "\\f"; break;
+      case '\n': out += "\\n"; break;
+      case '\r': out += "\\r"; break;
+      case '\t': out += "\\t"; break;
+      default: out += c;
+    }
+  }
+  out += '"';
+}
+
+inline void write_float(std::string &out, double v, bool single) {
+  if (isnan(v) || isinf(v)) {
+    out += "null";
+    return;
+  }
+
+  // Plain decimal notation in the usual range, exponent notation outside of it.
+  bool plain = v == 0 || (fabs(v) >= 1e-5 && fabs(v) < 1e7);
+  char buf[48];
+  for (int precision = plain ? 0 : 1; precision <= 17; precision++) {
+    snprintf(buf, sizeof(buf), plain ? "%.*f" : "%.*g", precision, v);
+    if (single ? strtof(buf, NULL) == (float) v : strtod(buf, NULL) == v) break;
+  }
+  out += buf;
+}
+
+inline void write(std::string &out, const Node &n) {
+  switch (n.type) {
+    case Node::Null: out += "null"; break;
+    case Node::Bool: out += n.b ? "true" : "false"; break;
+    case Node::Int: out += std::to_string(n.i); break;
+    case Node::Uint: out += std::to_string(n.u); break;
+    case Node::Float: write_float(out, n.d, true); break;
+    case Node::Double: write_float(out, n.d, false); break;
+    case Node::Str: write_string(out, n.s); break;
+    case Node::Raw: out += n.s; break;
+    case Node::Object:
+      out += '{';
+      for (size_t i = 0; i < n.members.size(); i++) {
+        if (i) out += ',';
+        write_string(out, n.members[i].first);
+        out += ':';
+        write(out, *n.members[i].second);
+      }
+      out += '}';
+      break;
+    case Node::Array:
+      out += '[';
+      for (size_t i = 0; i < n.elements.size(); i++) {
+        if (i) out += ',';
+        write(out, *n.elements[i]);
+      }
+      out += ']';
+      break;
+  }
+}
+
+}
+
+#endif
@@ -0,0 +1,35 @@
+/*
+ * Host simulation stand-in for ArduinoLowPower.
+ *
+ * deepSleep() ends the current wake cycle and advances the virtual clock by the sleep duration.
+ * Sleeping without a timeout never wakes up, so it ends the simulation.
+ */
+#ifndef SIM_ARDUINOLOWPOWER_H
+#define SIM_ARDUINOLOWPOWER_H
+
+#include "Arduino.h"
+
+typedef void (*onOffFuncPtr)(bool);
+typedef void (*voidFuncPtr)(void);
+
+class ArduinoLowPowerClass {
+  public:
+    void idle() { idle(1); } // Until the next interrupt, SysTick at the latest
+    void idle(uint32_t millis);
+    void idle(int millis) { idle((uint32_t) millis); }
+
+    void sleep() { sleep(0); }
+    void sleep(uint32_t millis);
+    void sleep(int millis) { sleep((uint32_t) millis); }
+
+    void deepSleep();
+    void deepSleep(uint32_t millis);
+    void deepSleep(int millis) { deepSleep((uint32_t) millis); }
+    void deepSleep(unsigned long millis) { deepSleep((uint32_t) millis); }
+
+    void attachInterruptWakeup(uint32_t pin, voidFuncPtr callback, uint32_t mode);
+};
+
+extern ArduinoLowPowerClass LowPower;
+
+#endif
@@ -0,0 +1,34 @@
+/*
+ * Host simulation stand-in for the Adafruit DHT sensor library.
+ *
+ * Readings follow a slow daily temperature/humidity cycle quantized to the DHT22's 0.1 resolution.
+ */
+#ifndef SIM_DHT_H
+#define SIM_DHT_H
+
+#include "Arduino.h"
+
+#define DHT11 11
+#define DHT12 12
+#define DHT21 21
+#define DHT22 22
+#define AM2301 21
+
+class DHT {
+  public:
+    DHT(uint8_t pin, uint8_t type, uint8_t count = 6) : pin(pin), type(type) { (void) count; }
+    void begin(uint8_t usec = 55);
+    float readTemperature(bool S = false, bool force = false);
+    float readHumidity(bool force = false);
+    bool read(bool force = false);
+
+  private:
+    uint8_t pin;
+    uint8_t type;
+    float temperature = NAN;
+    float humidity = NAN;
+    unsigned long last_read_ms = 0;
+    bool has_read = false;
+};
+
+#endif
@@ -0,0 +1,9 @@
+/*
+ * Host simulation stand-in for the Adafruit Unified Sensor wrapper of the DHT library.
+ */
+#ifndef SIM_DHT_U_H
+#define SIM_DHT_U_H
+
+#include "DHT.h"
+
+#endif
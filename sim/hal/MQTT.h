@@ -0,0 +1,105 @@
+/*
+ * Host simulation stand-in for 256dpi/arduino-mqtt.
+ *
+ * Publishes are delivered to the simulated broker. QoS 1 publishes block until the PUBACK arrives or
+ * the command timeout elapses, like the real lwmqtt-based client. Subscribing delivers the broker's
+ * matching retained messages on the next loop(). A received message that doesn't fit the read buffer
+ * fails loop() and closes the connection, as lwmqtt does.
+ */
+#ifndef SIM_MQTT_H
+#define SIM_MQTT_H
+
+#include "Arduino.h"
+
+#include <deque>
+#include <string>
+#include <utility>
+
+class MQTTClient;
+
+typedef void (*MQTTClientCallbackSimple)(String &topic, String &payload);
+
+typedef enum {
+  LWMQTT_SUCCESS = 0,
+  LWMQTT_BUFFER_TOO_SHORT = -1,
+  LWMQTT_NETWORK_FAILED_CONNECT = -3,
+  LWMQTT_NETWORK_TIMEOUT = -4,
+  LWMQTT_MISSING_OR_WRONG_PACKET = -9,
+  LWMQTT_CONNECTION_DENIED = -10,
+} lwmqtt_err_t;
+
+class MQTTClient {
+  public:
+    explicit MQTTClient(int buf_size = 128) : read_buf_size(buf_size), write_buf_size(buf_size) {}
+    MQTTClient(int read_buf_size, int write_buf_size)
+        : read_buf_size(read_buf_size), write_buf_size(write_buf_size) {}
+
+    void begin(const char host[], int port, Client &client);
+    void begin(const char host[], Client &client) { begin(host, 1883, client); }
+    void onMessage(MQTTClientCallbackSimple cb) { callback = cb; }
+
+    void setWill(const char topic[], const char payload[], bool retained, int qos);
+    void clearWill();
+    void setKeepAlive(int keep_alive) { keep_alive_s = keep_alive; }
+    void setCleanSession(bool clean) { clean_session = clean; }
+    void setTimeout(int timeout) { timeout_ms = timeout; }
+    void setOptions(int keep_alive, bool clean, int timeout) {
+      keep_alive_s = keep_alive;
+      clean_session = clean;
+      timeout_ms = timeout;
+    }
+
+    bool connect(const char client_id[], bool skip = false);
+    bool connect(const char client_id[], const char username[], bool skip = false);
+    bool connect(const char client_id[], const char username[], const char password[], bool skip = false);
+
+    bool publish(const String &topic) { return publish(topic.c_str(), ""); }
+    bool publish(const char topic[]) { return publish(topic, ""); }
+    bool publish(const String &topic, const String &payload) { return publish(topic.c_str(), payload.c_str()); }
+    bool publish(const String &topic, const String &payload, bool retained, int qos) {
+      return publish(topic.c_str(), payload.c_str(), retained, qos);
+    }
+    bool publish(const char topic[], const String &payload) { return publish(topic, payload.c_str()); }
+    bool publish(const char topic[], const String &payload, bool retained, int qos) {
+      return publish(topic, payload.c_str(), retained, qos);
+    }
+    bool publish(const char topic[], const char payload[]) { return publish(topic, payload, false, 0); }
+    bool publish(const char topic[], const char payload[], bool retained, int qos) {
+      return publish(topic, payload, (int) strlen(payload), retained, qos);
+    }
+    bool publish(const char topic[], const char payload[], int length) { return publish(topic, payload, length, false, 0); }
+    bool publish(const char topic[], const char payload[], int length, bool retained, int qos);
+
+    bool subscribe(const char topic[], int qos = 0);
+    bool unsubscribe(const char topic[]);
+
+    bool loop();
+    bool connected();
+    bool disconnect();
+
+    lwmqtt_err_t lastError() { return last_error; }
+    int returnCode() { return return_code; }
+
+  private:
+    int read_buf_size;
+    int write_buf_size;
+    char host[128] = "";
+    int port = 1883;
+    int keep_alive_s = 10;
+    bool clean_session = true;
+    int timeout_ms = 1000;
+    String will_topic;
+    String will_payload;
+    bool will_retained = false;
+    bool has_will = false;
+    MQTTClientCallbackSimple callback = nullptr;
+
+    std::deque<std::pair<std::string, std::string>> inbox; // Received, delivered by loop()
+
+    bool is_connected = false;
+    unsigned long link_generation = 0;
+    lwmqtt_err_t last_error = LWMQTT_SUCCESS;
+    int return_code = 0;
+};
+
+#endif
@@ -0,0 +1,30 @@
+/*
+ * Host simulation stand-in for arduino-libraries/NTPClient.
+ */
+#ifndef SIM_NTPCLIENT_H
+#define SIM_NTPCLIENT_H
+
+#include "Arduino.h"
+#include "WiFiUdp.h"
+
+class NTPClient {
+  public:
+    NTPClient(WiFiUDP &udp, const char *pool_server_name) : udp(udp), server(pool_server_name) {}
+
+    void begin();
+    void begin(unsigned int port) { (void) port; begin(); }
+    bool update();
+    bool forceUpdate();
+    bool isTimeSet() const { return last_update_ms != 0; }
+    unsigned long getEpochTime() const;
+    void end();
+
+  private:
+    WiFiUDP &udp;
+    const char *server;
+    unsigned long epoch = 0;
+    unsigned long last_update_ms = 0;
+    bool started = false;
+};
+
+#endif
@@ -0,0 +1,42 @@
+/*
+ * Host simulation stand-in for RTCZero.
+ *
+ * The RTC keeps running in deep sleep and drifts from true time by Options::rtc_drift_ppm.
+ */
+#ifndef SIM_RTCZERO_H
+#define SIM_RTCZERO_H
+
+#include "Arduino.h"
+
+typedef void (*voidFuncPtr)(void);
+
+class RTCZero {
+  public:
+    enum Alarm_Match : uint8_t {
+      MATCH_OFF = 0,
+      MATCH_SS,
+      MATCH_MMSS,
+      MATCH_HHMMSS,
+      MATCH_DHHMMSS,
+      MATCH_MMDDHHMMSS,
+      MATCH_YYMMDDHHMMSS
+    };
+
+    void begin(bool reset_time = false);
+    void enableAlarm(Alarm_Match match);
+    void disableAlarm();
+    void attachInterrupt(voidFuncPtr callback);
+    void detachInterrupt();
+    void standbyMode();
+
+    uint32_t getEpoch();
+    uint32_t getY2kEpoch();
+    void setEpoch(uint32_t ts);
+    void setAlarmEpoch(uint32_t ts);
+    bool isConfigured() { return configured; }
+
+  private:
+    bool configured = false;
+};
+
+#endif
@@ -0,0 +1,66 @@
+/*
+ * Host simulation stand-in for PaulStoffregen/Time.
+ *
+ * Like the real library, the system clock free-runs on millis() between syncs, so it stalls while
+ * the SAMD21 is in deep sleep until the sync provider is consulted again.
+ */
+#ifndef SIM_TIMELIB_H
+#define SIM_TIMELIB_H
+
+#include "Arduino.h"
+
+#include <time.h>
+
+typedef enum { timeNotSet, timeNeedsSync, timeSet } timeStatus_t;
+
+typedef enum {
+  dowInvalid, dowSunday, dowMonday, dowTuesday, dowWednesday, dowThursday, dowFriday, dowSaturday
+} timeDayOfWeek_t;
+
+typedef struct {
+  uint8_t Second;
+  uint8_t Minute;
+  uint8_t Hour;
+  uint8_t Wday;   // day of week, sunday is day 1
+  uint8_t Day;
+  uint8_t Month;
+  uint8_t Year;   // offset from 1970
+} tmElements_t, TimeElements, *tmElementsPtr_t;
+
+#define tmYearToCalendar(Y) ((Y) + 1970)
+#define CalendarYrToTm(Y) ((Y) - 1970)
+
+#define SECS_PER_MIN ((time_t) (60UL))
+#define SECS_PER_HOUR ((time_t) (3600UL))
+#define SECS_PER_DAY ((time_t) (SECS_PER_HOUR * 24UL))
+#define SECS_PER_WEEK ((time_t) (SECS_PER_DAY * 7UL))
+
+typedef time_t (*getExternalTime)();
+
+time_t now();
+void setTime(time_t t);
+void adjustTime(long adjustment);
+timeStatus_t timeStatus();
+void setSyncProvider(getExternalTime getTimeFunction);
+void setSyncInterval(time_t interval);
+
+void breakTime(time_t time, tmElements_t &tm);
+time_t makeTime(const tmElements_t &tm);
+
+int hour(time_t t);
+int minute(time_t t);
+int second(time_t t);
+int day(time_t t);
+int weekday(time_t t);
+int month(time_t t);
+int year(time_t t);
+
+inline int hour() { return hour(now()); }
+inline int minute() { return minute(now()); }
+inline int second() { return second(now()); }
+inline int day() { return day(now()); }
+inline int weekday() { return weekday(now()); }
+inline int month() { return month(now()); }
+inline int year() { return year(now()); }
+
+#endif
@@ -0,0 +1,42 @@
+/*
+ * Host simulation stand-in for khoih-prog/Timezone_Generic (a port of JChristensen/Timezone).
+ */
+#ifndef SIM_TIMEZONE_GENERIC_H
+#define SIM_TIMEZONE_GENERIC_H
+
+#include "TimeLib.h"
+
+enum week_t { Last, First, Second, Third, Fourth };
+enum dow_t { Sun = 1, Mon, Tue, Wed, Thu, Fri, Sat };
+enum month_t { Jan = 1, Feb, Mar, Apr, May, Jun, Jul, Aug, Sep, Oct, Nov, Dec };
+
+struct TimeChangeRule {
+  char abbrev[6];
+  uint8_t week;
+  uint8_t dow;
+  uint8_t month;
+  uint8_t hour;
+  int offset;
+};
+
+class Timezone {
+  public:
+    Timezone(TimeChangeRule dst_start, TimeChangeRule std_start) : dst(dst_start), std(std_start) {}
+
+    time_t toLocal(time_t utc);
+    time_t toLocal(time_t utc, TimeChangeRule **tcr);
+    bool utcIsDST(time_t utc);
+
+  private:
+    void calcTimeChanges(int yr);
+    time_t toTime_t(TimeChangeRule r, int yr);
+
+    TimeChangeRule dst;
+    TimeChangeRule std;
+    time_t dst_utc = 0;
+    time_t std_utc = 0;
+    time_t dst_loc = 0;
+    time_t std_loc = 0;
+};
+
+#endif
@@ -0,0 +1,167 @@
+/*
+ * Host simulation stand-in for WiFiNINA.
+ *
+ * Models a single access point and a NINA-W102 reached over SPI. Association, scanning, DHCP and
+ * WiFiStorage transfers are charged against the virtual clock.
+ */
+#ifndef SIM_WIFININA_H
+#define SIM_WIFININA_H
+
+#include "Arduino.h"
+
+#include <memory>
+#include <string>
+
+enum wl_status_t {
+  WL_NO_SHIELD = 255,
+  WL_NO_MODULE = WL_NO_SHIELD,
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL,
+  WL_SCAN_COMPLETED,
+  WL_CONNECTED,
+  WL_CONNECT_FAILED,
+  WL_CONNECTION_LOST,
+  WL_DISCONNECTED,
+  WL_AP_LISTENING,
+  WL_AP_CONNECTED,
+  WL_AP_FAILED
+};
+
+class WiFiClass {
+  public:
+    uint8_t status();
+    int begin(const char *ssid, const char *passphrase);
+    void setTimeout(unsigned long timeout);
+    uint8_t beginAP(const char *ssid, uint8_t channel);
+    int disconnect();
+    void end();
+
+    void config(IPAddress local_ip);
+    void config(IPAddress local_ip, IPAddress dns_server);
+    void config(IPAddress local_ip, IPAddress dns_server, IPAddress gateway);
+    void config(IPAddress local_ip, IPAddress dns_server, IPAddress gateway, IPAddress subnet);
+    void setDNS(IPAddress dns_server1);
+
+    int32_t RSSI();
+    const char *SSID();
+    uint8_t *BSSID(uint8_t *bssid);
+    uint8_t *macAddress(uint8_t *mac);
+    IPAddress localIP();
+    IPAddress subnetMask();
+    IPAddress gatewayIP();
+    IPAddress dnsIP(int n = 0);
+    const char *firmwareVersion();
+
+    void lowPowerMode();
+    void noLowPowerMode();
+};
+
+extern WiFiClass WiFi;
+
+namespace sim {
+  struct Socket;
+}
+
+class WiFiClient : public Client {
+  public:
+    WiFiClient() {}
+    explicit WiFiClient(std::shared_ptr<sim::Socket> socket) : sock(socket) {}
+
+    int connect(const char *host, uint16_t port) override;
+    uint8_t connected() override;
+    void stop() override;
+    operator bool() override { return sock != nullptr; }
+    bool operator==(const WiFiClient &other) const { return sock == other.sock; }
+    bool operator!=(const WiFiClient &other) const { return sock != other.sock; }
+
+    int available() override;
+    int read() override;
+    int read(uint8_t *buf, size_t size);
+    int peek() override;
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+
+  private:
+    std::shared_ptr<sim::Socket> sock;
+};
+
+class WiFiServer {
+  public:
+    explicit WiFiServer(uint16_t port) : port(port) {}
+    void begin();
+    WiFiClient available();
+
+  private:
+    uint16_t port;
+};
+
+class WiFiStorageClass {
+  public:
+    bool exists(const char *filename, uint32_t *size = NULL);
+    bool remove(const char *filename);
+    bool read(const char *filename, uint32_t offset, uint8_t *buffer, uint32_t buffer_len);
+    bool write(const char *filename, uint32_t offset, const uint8_t *buffer, uint32_t buffer_len);
+
+    class WiFiStorageFile open(const char *filename);
+};
+
+extern WiFiStorageClass WiFiStorage;
+
+// Mirrors WiFiNINA's WiFiStorageFile: a cursor on a NINA file, every call is an SPI round trip.
+class WiFiStorageFile {
+  public:
+    explicit WiFiStorageFile(const char *name) : filename(name) {
+      WiFiStorage.exists(filename.c_str(), &length);
+    }
+
+    operator bool() { return WiFiStorage.exists(filename.c_str(), &length); }
+
+    uint32_t read(void *buf, uint32_t rdlen) {
+      if (offset + rdlen > length) {
+        if (offset >= length) return 0;
+        rdlen = length - offset;
+      }
+      WiFiStorage.read(filename.c_str(), offset, (uint8_t *) buf, rdlen);
+      offset += rdlen;
+      return rdlen;
+    }
+
+    uint32_t write(const void *buf, uint32_t wrlen) {
+      WiFiStorage.write(filename.c_str(), offset, (const uint8_t *) buf, wrlen);
+      offset += wrlen;
+      if (offset > length) length = offset;
+      return wrlen;
+    }
+
+    void seek(uint32_t n) { offset = n; }
+    uint32_t position() { return offset; }
+    uint32_t size() { WiFiStorage.exists(filename.c_str(), &length); return length; }
+    uint32_t available() { WiFiStorage.exists(filename.c_str(), &length); return length - offset; }
+
+    void erase() {
+      offset = 0;
+      length = 0;
+      WiFiStorage.remove(filename.c_str());
+    }
+
+    void close() {}
+
+  private:
+    std::string filename;
+    uint32_t offset = 0;
+    uint32_t length = 0;
+};
+
+inline WiFiStorageFile WiFiStorageClass::open(const char *filename) {
+  return WiFiStorageFile(filename);
+}
+
+class WiFiDrv {
+  public:
+    static void pinMode(uint8_t pin, uint8_t mode);
+    static void digitalWrite(uint8_t pin, uint8_t value);
+    static void analogWrite(uint8_t pin, uint8_t value);
+};
+
+#endif
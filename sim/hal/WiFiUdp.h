@@ -0,0 +1,39 @@
+/*
+ * Host simulation stand-in for WiFiNINA's WiFiUDP.
+ */
+#ifndef SIM_WIFIUDP_H
+#define SIM_WIFIUDP_H
+
+#include "Arduino.h"
+
+#include <vector>
+
+class WiFiUDP {
+  public:
+    uint8_t begin(uint16_t port);
+    void stop();
+
+    int parsePacket();
+    int available();
+    int read();
+    int read(unsigned char *buffer, size_t len);
+    IPAddress remoteIP();
+    uint16_t remotePort();
+
+    int beginPacket(IPAddress ip, uint16_t port);
+    size_t write(uint8_t b);
+    size_t write(const uint8_t *buffer, size_t size);
+    int endPacket();
+
+  private:
+    uint16_t local_port = 0;
+    std::vector<uint8_t> rx;
+    size_t rx_pos = 0;
+    IPAddress rx_ip;
+    uint16_t rx_port = 0;
+    std::vector<uint8_t> tx;
+    IPAddress tx_ip;
+    uint16_t tx_port = 0;
+};
+
+#endif
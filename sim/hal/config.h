@@ -0,0 +1,8 @@
+/*
+ * Local build configuration for the host simulation. The firmware build uses the config.h kept next
+ * to the sketch.
+ */
+#ifndef SIM_CONFIG_H
+#define SIM_CONFIG_H
+
+#endif
@@ -0,0 +1,205 @@
+/*
+ * Host simulation stand-in for the Arduino SAMD core.
+ */
+#include "Arduino.h"
+#include "sim.h"
+
+Serial_ Serial;
+
+static uint64_t systick_us = 0; // Advances only while the MCU is awake
+static unsigned long rand_state = 1;
+
+namespace sim {
+  void systick_advance(uint64_t us) {
+    systick_us += us;
+  }
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  (void) pin;
+  (void) mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+  sim::set_pin(pin, val);
+}
+
+int digitalRead(uint8_t pin) {
+  return sim::pin_level(pin);
+}
+
+void analogReadResolution(int bits) {
+  (void) bits;
+}
+
+static const uint8_t photores_pwr_pin = 1;
+
+namespace sim {
+
+double adc_level(uint8_t pin) {
+  if (pin == ADC_BATTERY) {
+    // MKR WiFi 1010 divider: R8 = 330k, R9 = 1.2M. 10-bit reading against the 3.3V reference.
+    double mv = sim::battery_mv(sim::radio_on()) * 1200.0 / 1530.0;
+    return mv * 1024.0 / 3300.0;
+  }
+
+  if (pin == A1) {
+    // Photoresistor divider follows daylight, and reads ground while its power pin is low.
+    if (!sim::pin_level(photores_pwr_pin)) return 0;
+    time_t t = sim::true_epoch();
+    double day_frac = (double) ((t - 6 * 3600) % 86400) / 86400.0; // Local solar time, roughly UTC-6
+    double daylight = sin(2 * M_PI * (day_frac - 0.25));
+    if (daylight < 0) daylight = 0;
+    if (sim::opts.stable_room) daylight = 0.3; // Artificial light
+    return 90 + (int) (780.0 * daylight);
+  }
+
+  return 512;
+}
+
+double adc_noise_gain(uint8_t pin) {
+  if (pin == ADC_BATTERY) return 0.5;
+  if (pin == A1 && sim::pin_level(photores_pwr_pin)) return 2;
+  return 1;
+}
+
+}
+
+int analogRead(uint8_t pin) {
+  sim::advance_us(sim::cost::adc_sample_us);
+
+  // Small deterministic noise of a few LSB, as seen on the un-averaged SAMD21 ADC.
+  int noise = (int) (random(0, 9)) - 4;
+  int counts = (int) sim::adc_level(pin) + (int) (noise * sim::adc_noise_gain(pin));
+  return counts < 0 ? 0 : (counts > 1023 ? 1023 : counts);
+}
+
+unsigned long millis() {
+  return (unsigned long) (systick_us / 1000);
+}
+
+unsigned long micros() {
+  return (unsigned long) systick_us;
+}
+
+void delay(unsigned long ms) {
+  sim::advance_ms(ms);
+}
+
+void delayMicroseconds(unsigned int us) {
+  sim::advance_us(us);
+}
+
+void randomSeed(unsigned long seed) {
+  rand_state = seed ? seed : 1;
+}
+
+long random(long howbig) {
+  if (howbig <= 0) return 0;
+  rand_state = rand_state * 1103515245UL + 12345UL;
+  return (long) ((rand_state >> 16) % (unsigned long) howbig);
+}
+
+long random(long howsmall, long howbig) {
+  if (howsmall >= howbig) return howsmall;
+  return random(howbig - howsmall) + howsmall;
+}
+
+char *ultoa(unsigned long value, char *str, int base) {
+  char tmp[33];
+  int i = 0;
+  do {
+    int digit = value % base;
+    tmp[i++] = digit < 10 ? '0' + digit : 'a' + digit - 10;
+    value /= base;
+  } while (value);
+
+  int j = 0;
+  while (i > 0) str[j++] = tmp[--i];
+  str[j] = 0;
+  return str;
+}
+
+char *ltoa(long value, char *str, int base) {
+  if (value < 0 && base == 10) {
+    str[0] = '-';
+    ultoa((unsigned long) -value, str + 1, base);
+    return str;
+  }
+  return ultoa((unsigned long) value, str, base);
+}
+
+char *itoa(int value, char *str, int base) {
+  return ltoa(value, str, base);
+}
+
+char *utoa(unsigned value, char *str, int base) {
+  return ultoa(value, str, base);
+}
+
+String::String(unsigned char value, unsigned char base) : String((unsigned long) value, base) {}
+String::String(int value, unsigned char base) : String((long) value, base) {}
+String::String(unsigned int value, unsigned char base) : String((unsigned long) value, base) {}
+
+String::String(long value, unsigned char base) {
+  char tmp[34];
+  buf = ltoa(value, tmp, base);
+}
+
+String::String(unsigned long value, unsigned char base) {
+  char tmp[34];
+  buf = ultoa(value, tmp, base);
+}
+
+String::String(float value, unsigned char decimal_places) : String((double) value, decimal_places) {}
+
+String::String(double value, unsigned char decimal_places) {
+  char tmp[48];
+  snprintf(tmp, sizeof(tmp), "%.*f", decimal_places, value);
+  buf = tmp;
+}
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+  size_t n = 0;
+  while (size--) n += write(*buffer++);
+  return n;
+}
+
+size_t Print::print(long value, int base) {
+  char tmp[34];
+  return write(ltoa(value, tmp, base));
+}
+
+size_t Print::print(unsigned long value, int base) {
+  char tmp[34];
+  return write(ultoa(value, tmp, base));
+}
+
+size_t Print::print(double value, int digits) {
+  char tmp[48];
+  snprintf(tmp, sizeof(tmp), "%.*f", digits, value);
+  return write(tmp);
+}
+
+size_t Print::print(const Printable &p) {
+  return p.printTo(*this);
+}
+
+size_t IPAddress::printTo(Print &p) const {
+  size_t n = 0;
+  for (int i = 0; i < 4; i++) {
+    n += p.print(bytes[i], DEC);
+    if (i < 3) n += p.print('.');
+  }
+  return n;
+}
+
+size_t Serial_::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t Serial_::write(const uint8_t *buffer, size_t size) {
+  if (sim::opts.serial_out) fwrite(buffer, 1, size, sim::opts.serial_out);
+  else if (!sim::opts.quiet) fwrite(buffer, 1, size, stdout);
+  return size;
+}
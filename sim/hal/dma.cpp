@@ -0,0 +1,132 @@
+/*
+ * Host simulation of the SAMD21 ADC registers and the DMA controller, see sam.h and Adafruit_ZeroDMA.h.
+ */
+#include "Arduino.h"
+#include "Adafruit_ZeroDMA.h"
+#include "sam.h"
+#include "sim.h"
+
+Adc sim_adc_regs;
+
+#define NO_ADC 0xff
+
+// MKR WiFi 1010: A0..A6 are AIN0, AIN10, AIN11, AIN4, AIN5, AIN6, AIN7, ADC_BATTERY (PB09) is AIN3.
+const PinDescription g_APinDescription[] = {
+  {NO_ADC}, {NO_ADC}, {NO_ADC}, {NO_ADC}, {NO_ADC}, {NO_ADC}, {NO_ADC}, {NO_ADC},   // 0..7
+  {NO_ADC}, {NO_ADC}, {NO_ADC}, {NO_ADC}, {NO_ADC}, {NO_ADC}, {NO_ADC},             // 8..14
+  {0}, {10}, {11}, {4}, {5}, {6}, {7},                                              // A0..A6
+  {NO_ADC}, {NO_ADC}, {NO_ADC}, {NO_ADC}, {NO_ADC}, {NO_ADC}, {NO_ADC}, {NO_ADC},   // 22..29
+  {NO_ADC}, {NO_ADC},                                                               // 30..31
+  {3},                                                                              // ADC_BATTERY
+};
+
+static const uint8_t adc_pins = sizeof(g_APinDescription) / sizeof(g_APinDescription[0]);
+
+// Time from power-up to the first valid reading.
+static const uint32_t adc_startup_us = 3;
+
+static uint8_t muxpos_pin(uint8_t muxpos) {
+  for (uint8_t pin = 0; pin < adc_pins; pin++) {
+    if (g_APinDescription[pin].ulADCChannelNumber == muxpos) return pin;
+  }
+  return NO_ADC;
+}
+
+/**
+ * One 12-bit conversion, with noise at the 12-bit scale of the same amplitude analogRead() sees.
+ */
+static int convert(uint8_t pin) {
+  if (pin == NO_ADC) return 2048;
+  int noise = (int) (random(0, 33)) - 16;
+  int counts = (int) (sim::adc_level(pin) * 4 + noise * sim::adc_noise_gain(pin));
+  return counts < 0 ? 0 : (counts > 4095 ? 4095 : counts);
+}
+
+/**
+ * The RESULT register after one averaging run: the sum of 2^SAMPLENUM conversions, shifted down
+ * automatically beyond 16 samples and then by ADJRES.
+ */
+static uint16_t accumulate(uint8_t pin) {
+  uint8_t samplenum = ADC->AVGCTRL.bit.SAMPLENUM;
+  uint32_t sum = 0;
+
+  for (uint32_t i = 0; i < (1u << samplenum); i++) sum += convert(pin);
+
+  if (samplenum > 4) sum >>= samplenum - 4;
+  sum >>= ADC->AVGCTRL.bit.ADJRES;
+  return sum > 0xffff ? 0xffff : sum;
+}
+
+/**
+ * @return The time one RESULT takes: 2^SAMPLENUM conversions, each (SAMPLEN + 1) / 2 ADC clocks of
+ * sampling and 6 of 12-bit conversion, the ADC clock being 48MHz / (4 << PRESCALER).
+ */
+static double result_us() {
+  double adc_clock_mhz = 48.0 / (4 << ADC->CTRLB.bit.PRESCALER);
+  double conversion_clocks = (ADC->SAMPCTRL.bit.SAMPLEN + 1) / 2.0 + 6;
+  return (1u << ADC->AVGCTRL.bit.SAMPLENUM) * conversion_clocks / adc_clock_mhz;
+}
+
+ZeroDMAstatus Adafruit_ZeroDMA::allocate() {
+  if (allocated) return DMA_STATUS_ERR_NOT_FOUND;
+  allocated = true;
+  return DMA_STATUS_OK;
+}
+
+void Adafruit_ZeroDMA::setTrigger(uint8_t trigger_) {
+  trigger = trigger_;
+}
+
+void Adafruit_ZeroDMA::setAction(dma_transfer_trigger_action action) {
+  (void) action;
+}
+
+DmacDescriptor *Adafruit_ZeroDMA::addDescriptor(void *src, void *dst, uint32_t count, dma_beat_size size,
+                                                bool srcInc, bool dstInc, uint32_t stepSize, bool stepSel) {
+  (void) stepSize;
+  (void) stepSel;
+  descriptor = {src, dst, count, size, srcInc, dstInc};
+  has_descriptor = true;
+  return &descriptor;
+}
+
+void Adafruit_ZeroDMA::setCallback(void (*callback)(Adafruit_ZeroDMA *), dma_callback_type type) {
+  if (type == DMA_CALLBACK_TRANSFER_DONE) done_callback = callback;
+}
+
+ZeroDMAstatus Adafruit_ZeroDMA::startJob() {
+  if (!allocated || !has_descriptor) return DMA_STATUS_ERR_NOT_INITIALIZED;
+  if (busy) return DMA_STATUS_BUSY;
+  if (trigger != ADC_DMAC_ID_RESRDY || descriptor.src != &ADC->RESULT.reg ||
+      descriptor.size != DMA_BEAT_SIZE_HWORD) {
+    return DMA_STATUS_ERR_INVALID_ARG;
+  }
+
+  sim::advance_us(2); // Channel setup over the bus
+
+  uint8_t pin = muxpos_pin(ADC->INPUTCTRL.bit.MUXPOS);
+  uint16_t *dst = (uint16_t *) descriptor.dst;
+  for (uint32_t i = 0; i < descriptor.count; i++) {
+    uint16_t result = accumulate(pin);
+    ADC->RESULT.reg = result;
+    *dst = result;
+    if (descriptor.dst_inc) dst++;
+  }
+
+  busy = true;
+  uint32_t this_job = ++job;
+  uint64_t done_us = sim::now_us() + adc_startup_us + (uint64_t) (descriptor.count * result_us());
+
+  sim::schedule_at(done_us, [this, this_job]() {
+    if (!busy || job != this_job) return;
+    busy = false;
+    if (done_callback) done_callback(this);
+  });
+
+  return DMA_STATUS_OK;
+}
+
+void Adafruit_ZeroDMA::abort() {
+  busy = false;
+  job++;
+}
@@ -0,0 +1,1178 @@
+/*
+ * Host simulation of the NINA-W102 network side: WiFi, WiFiStorage, sockets, UDP, NTP and MQTT.
+ */
+#include "WiFiNINA.h"
+#include "WiFiUdp.h"
+#include "NTPClient.h"
+#include "MQTT.h"
+#include "sim.h"
+
+#include <algorithm>
+#include <deque>
+
+WiFiClass WiFi;
+WiFiStorageClass WiFiStorage;
+
+namespace sim {
+
+struct Socket {
+  std::string rx;
+  size_t rx_pos = 0;
+  std::string tx;
+  bool open = true;
+  uint64_t rx_start_us = 0;           // First request byte in, for the portal latencies
+  uint64_t first_tx_us = 0;           // First reply byte out
+  std::function<void()> on_close;     // Called when the firmware closes the socket
+};
+
+static const char *ap_ssid = "SimNet";
+static const char *ap_pass = "sim-password";
+
+static uint8_t wifi_status = WL_IDLE_STATUS;
+static unsigned long begin_timeout_ms = 50000; // WiFiNINA's default
+
+// AP portal: phones join the AP and fetch its pages, a request arriving in TCP segments.
+static unsigned long portal_session = 0;     // Bumped when the AP opens or closes, ends the phones' scripts
+static std::vector<std::shared_ptr<Socket>> server_sockets;
+static size_t server_next = 0;
+
+static const uint32_t phone_join_ms = 2000;     // AP up to the first phone associated
+static const uint32_t phone_stagger_ms = 700;   // Between phones joining
+static const uint32_t phone_probe_ms = 3000;    // Between captive portal probes of a phone
+static const uint32_t phone_form_ms = 20000;    // Joined to the form submitted, the user typing
+static const uint32_t phone_segment_ms = 200;   // Between the TCP segments of a request, Nagle on the
+                                                // phone waiting for the NINA's delayed ACK
+static const uint32_t phone_empty_post_ms = 100; // Form taken to the same phone posting it again, empty
+
+enum PhoneRequest { PHONE_GET, PHONE_FORM, PHONE_EMPTY_FORM };
+
+// Captive DNS: phones resolve names when they join and before each probe, a resolver sending a query
+// again when no answer came. Queries wait in the NINA's UDP receive queue, which drops them when full.
+static const uint32_t dns_queue_max = 6;        // lwIP's UDP receive mailbox on the NINA
+static const uint32_t dns_retry_ms = 1000;      // Resolver retransmission timeout
+static const uint32_t dns_tries = 3;            // Sends of a query before the resolver gives up
+static const uint32_t dns_burst_ms = 5;         // Between the queries a phone sends when it joins
+
+// Names a phone's OS and apps look up as soon as it joins.
+static const char *phone_join_names[] = {
+  "connectivitycheck.gstatic.com", "www.google.com", "clients3.google.com", "mtalk.google.com",
+  "play.googleapis.com", "captive.apple.com", "www.apple.com", "time.apple.com",
+  "gsp-ssl.ls.apple.com", "api.push.apple.com",
+};
+
+struct DnsDatagram {
+  std::vector<uint8_t> packet;
+  IPAddress ip;
+  uint16_t port;
+};
+
+struct DnsLookup {
+  std::vector<uint8_t> query;
+  IPAddress ip;
+  uint16_t port;
+  uint64_t sent_us;               // First send
+  uint32_t tries;
+  bool load;                      // From the --dns-qps load, which doesn't retry
+  std::function<void(bool answered)> done;
+};
+
+static std::deque<DnsDatagram> dns_queue;
+static std::map<uint32_t, DnsLookup> dns_lookups;   // By port << 16 | ID
+static bool dns_listening = false;                  // A WiFiUDP is bound to port 53
+static uint16_t dns_next_id = 1;
+static uint16_t dns_next_port = 49152;
+static uint64_t dns_load_start_us = 0;
+
+static const char *phone_form_body =
+  "wifi_ssid=SimNet&wifi_pass=sim-password&mqtt_host=broker.sim&mqtt_port=1883&mqtt_user=sensor"
+  "&mqtt_pass=sensor-pass&device_name=Office&action=Submit";
+
+// A join started by WiFi.begin() with a zero timeout completes in the background.
+static bool join_pending = false;
+static uint64_t join_done_us = 0;
+static uint8_t join_result = WL_IDLE_STATUS;
+static bool static_config = false;
+static IPAddress static_ip;
+static IPAddress static_gw;
+static IPAddress static_subnet;
+
+// Bumped whenever the association is torn down so sessions opened on it can notice.
+unsigned long link_generation = 0;
+
+// Broker side of the device's MQTT session. A session dropped without DISCONNECT is only noticed
+// 1.5 keep alive intervals after its last packet, or when the client connects again (takeover).
+// Either way the broker then publishes the will.
+struct Session {
+  bool dropped = false;
+  uint64_t last_packet_us = 0;
+  int keep_alive_s = 0;
+  bool has_will = false;
+  bool will_retained = false;
+  std::string will_topic;
+  std::string will_payload;
+  bool offline = false;            // The will is the last thing published on its topic
+  uint64_t offline_since_us = 0;
+};
+
+static Session session;
+
+static void publish_will(uint64_t at_us) {
+  session.dropped = false;
+  if (!session.has_will) return;
+
+  stats.mqtt_wills++;
+  if (session.will_retained) broker.retained[session.will_topic] = session.will_payload;
+  broker.log.push_back({session.will_topic, session.will_payload, session.will_retained, 1, true_epoch()});
+  session.offline = true;
+  session.offline_since_us = at_us;
+}
+
+static void expire_session(bool takeover) {
+  if (!session.dropped) return;
+
+  uint64_t expiry = session.keep_alive_s > 0 ?
+    session.last_packet_us + session.keep_alive_s * 1500000ULL : UINT64_MAX;
+
+  if (now_us() >= expiry) publish_will(expiry);
+  else if (takeover) publish_will(now_us());
+}
+
+static void session_publish(const char *topic, const std::string &payload) {
+  if (session.offline && session.will_topic == topic && session.will_payload != payload) {
+    stats.offline_s += (now_us() - session.offline_since_us) / 1e6;
+    session.offline = false;
+  }
+}
+
+void finish_network() {
+  expire_session(false);
+  if (session.offline) {
+    stats.offline_s += (now_us() - session.offline_since_us) / 1e6;
+    session.offline = false;
+  }
+}
+
+static void spi_cmd() {
+  advance_us(cost::spi_cmd_us);
+}
+
+static bool link_up() {
+  if (join_pending && now_us() >= join_done_us) {
+    join_pending = false;
+    wifi_status = join_result;
+    if (wifi_status == WL_CONNECTED) stats.wifi_associations++;
+  }
+
+  if (wifi_status == WL_CONNECTED && !wifi_ap_up()) {
+    wifi_status = WL_CONNECTION_LOST;
+    link_generation++;
+  }
+  return wifi_status == WL_CONNECTED;
+}
+
+
+// Opens a connection to the portal and sends segments to it, the first at once, then one every
+// phone_segment_ms. done runs once the firmware closes it, if the AP is still the same.
+static void phone_request(const std::vector<std::string> &segments, PhoneRequest kind,
+                          std::function<void(const std::string &reply)> done) {
+  auto sock = std::make_shared<Socket>();
+  Socket *s = sock.get();
+  unsigned long session = portal_session;
+
+  sock->rx_start_us = now_us();
+  sock->rx = segments[0];
+  for (size_t i = 1; i < segments.size(); i++) {
+    std::string segment = segments[i];
+    schedule_at(now_us() + i * phone_segment_ms * 1000, [sock, segment]() { sock->rx += segment; });
+  }
+
+  sock->on_close = [s, kind, session, done]() {
+    double total_s = (now_us() - s->rx_start_us) / 1e6;
+    bool ok = s->tx.compare(0, 12, "HTTP/1.1 200") == 0;
+    bool not_modified = s->tx.compare(0, 12, "HTTP/1.1 304") == 0;
+
+    if (kind == PHONE_EMPTY_FORM) {
+      // Has to be refused, there is no form in it.
+      stats.portal_empty_posts++;
+      if (ok) stats.portal_empty_accepted++;
+    }
+    else if (!ok && !not_modified) {
+      stats.portal_failed++;
+    }
+    else if (kind == PHONE_FORM) {
+      stats.portal_posts++;
+      stats.portal_post_s += total_s;
+      stats.portal_post_max_s = std::max(stats.portal_post_max_s, total_s);
+    }
+    else {
+      double ttfb_s = (s->first_tx_us - s->rx_start_us) / 1e6;
+      stats.portal_gets++;
+      if (not_modified) stats.portal_not_modified++;
+      stats.portal_ttfb_s += ttfb_s;
+      stats.portal_ttfb_max_s = std::max(stats.portal_ttfb_max_s, ttfb_s);
+      stats.portal_load_s += total_s;
+      stats.portal_load_max_s = std::max(stats.portal_load_max_s, total_s);
+      stats.portal_bytes += s->tx.size();
+    }
+
+    if (session == portal_session) done(s->tx);
+  };
+
+  server_sockets.push_back(sock);
+}
+
+static IPAddress phone_ip(unsigned phone) {
+  return IPAddress(static_ip[0], static_ip[1], static_ip[2], 100 + phone);
+}
+
+static void dns_send(uint32_t key) {
+  DnsLookup &lookup = dns_lookups[key];
+  lookup.tries++;
+
+  if (!dns_listening) return; // Refused, the resolver retries
+  if (dns_queue.size() >= dns_queue_max) {
+    stats.dns_dropped++;
+    return;
+  }
+  dns_queue.push_back({lookup.query, lookup.ip, lookup.port});
+}
+
+// Sends a lookup again when no answer came in time, or gives up on it.
+static void dns_retry(uint32_t key, unsigned long session) {
+  auto it = dns_lookups.find(key);
+  if (session != portal_session || it == dns_lookups.end()) return;
+
+  if (it->second.load || it->second.tries >= dns_tries) {
+    std::function<void(bool)> done = it->second.done;
+    dns_lookups.erase(it);
+    stats.dns_unanswered++;
+    if (done) done(false);
+    return;
+  }
+
+  stats.dns_retries++;
+  dns_send(key);
+  schedule_at(now_us() + dns_retry_ms * 1000, [key, session]() { dns_retry(key, session); });
+}
+
+// Sends a query for name with qtype from ip and calls done once it's answered or given up on.
+static void dns_query(IPAddress ip, const std::string &name, uint16_t qtype, bool load,
+                      std::function<void(bool answered)> done) {
+  uint16_t id = dns_next_id;
+  dns_next_id += 7919;
+  uint16_t port = dns_next_port;
+  dns_next_port = dns_next_port == 65535 ? 49152 : dns_next_port + 1;
+
+  // Header with RD set and one question, then the question and an EDNS0 OPT record, as phones send.
+  std::vector<uint8_t> query = {(uint8_t) (id >> 8), (uint8_t) id, 0x01, 0x00, 0, 1, 0, 0, 0, 0, 0, 1};
+  size_t start = 0;
+  while (start <= name.size()) {
+    size_t dot = name.find('.', start);
+    if (dot == std::string::npos) dot = name.size();
+    query.push_back((uint8_t) (dot - start));
+    query.insert(query.end(), name.begin() + start, name.begin() + dot);
+    start = dot + 1;
+  }
+  query.insert(query.end(), {0, (uint8_t) (qtype >> 8), (uint8_t) qtype, 0, 1});
+  query.insert(query.end(), {0, 0, 0x29, 0x05, 0xc0, 0, 0, 0, 0, 0, 0});
+
+  uint32_t key = (uint32_t) port << 16 | id;
+  dns_lookups[key] = {query, ip, port, now_us(), 0, load, done};
+  stats.dns_queries++;
+  if (load) stats.dns_load_queries++;
+  dns_send(key);
+
+  unsigned long session = portal_session;
+  schedule_at(now_us() + dns_retry_ms * 1000, [key, session]() { dns_retry(key, session); });
+}
+
+// Skips the name at offset of a DNS message, labels or a compression pointer.
+// @return The offset after it, 0 if it runs past the end.
+static size_t dns_skip_name(const std::vector<uint8_t> &msg, size_t offset) {
+  while (offset < msg.size()) {
+    if ((msg[offset] & 0xc0) == 0xc0) return offset + 2 <= msg.size() ? offset + 2 : 0;
+    if (msg[offset] == 0) return offset + 1;
+    offset += 1 + msg[offset];
+  }
+  return 0;
+}
+
+// Matches a reply the firmware sent to its lookup and checks it's one a resolver takes: the question
+// echoed, the AP's address for an A query, no records or records of the queried type for the others.
+static void dns_reply(IPAddress ip, uint16_t port, const std::vector<uint8_t> &reply) {
+  if (reply.size() < 12) return;
+
+  auto it = dns_lookups.find((uint32_t) port << 16 | (reply[0] << 8 | reply[1]));
+  if (it == dns_lookups.end() || it->second.ip != ip) return; // Late, a retry was answered already
+
+  DnsLookup lookup = it->second;
+  dns_lookups.erase(it);
+
+  const std::vector<uint8_t> &query = lookup.query;
+  size_t question_end = dns_skip_name(query, 12) + 4;
+  uint16_t qtype = query[question_end - 4] << 8 | query[question_end - 3];
+  uint16_t ancount = reply[6] << 8 | reply[7];
+
+  bool ok = reply.size() >= question_end && (reply[2] & 0x80) && (reply[3] & 0x0f) == 0 &&
+            reply[4] == 0 && reply[5] == 1 && std::equal(query.begin() + 12, query.begin() + question_end,
+                                                         reply.begin() + 12);
+  bool negative = ancount == 0;
+
+  size_t offset = question_end;
+  for (uint16_t i = 0; ok && i < ancount; i++) {
+    offset = dns_skip_name(reply, offset);
+    if (offset == 0 || offset + 10 > reply.size()) {
+      ok = false;
+      break;
+    }
+
+    uint16_t type = reply[offset] << 8 | reply[offset + 1];
+    uint16_t rdlength = reply[offset + 8] << 8 | reply[offset + 9];
+    offset += 10;
+    if (type != qtype || offset + rdlength > reply.size()) ok = false;
+    else if (type == 1 && (rdlength != 4 || IPAddress(&reply[offset]) != static_ip)) ok = false;
+    offset += rdlength;
+  }
+  if (qtype == 1 && negative) ok = false;
+
+  double latency_s = (now_us() - lookup.sent_us) / 1e6;
+  if (!ok) {
+    stats.dns_wrong++;
+  }
+  else {
+    stats.dns_answered++;
+    if (negative) stats.dns_negative++;
+    if (lookup.load) stats.dns_load_answered++;
+    stats.dns_latency_s += latency_s;
+    stats.dns_latency_max_s = std::max(stats.dns_latency_max_s, latency_s);
+  }
+
+  if (lookup.done) lookup.done(ok);
+}
+
+// Looks up name the way a phone's resolver does, A and AAAA, and HTTPS on iPhones. done runs with the
+// outcome of the A query.
+static void phone_resolve(unsigned phone, const std::string &name, std::function<void(bool answered)> done) {
+  dns_query(phone_ip(phone), name, 1, false, done);
+  dns_query(phone_ip(phone), name, 28, false, nullptr);
+  if (phone % 2 == 0) dns_query(phone_ip(phone), name, 65, false, nullptr);
+}
+
+// The --dns-qps load: a client sending queries at a steady rate without retrying, a mix of A, AAAA and
+// HTTPS for names that don't repeat.
+static void dns_load(unsigned long session, uint64_t n) {
+  if (session != portal_session) return;
+
+  static const uint16_t qtypes[] = {1, 28, 1, 28, 65};
+  dns_query(IPAddress(static_ip[0], static_ip[1], static_ip[2], 250), "host" + std::to_string(n) + ".example.com",
+            qtypes[n % 5], true, nullptr);
+  schedule_at(dns_load_start_us + (n + 1) * 1000000 / opts.dns_qps,
+              [session, n]() { dns_load(session, n + 1); });
+}
+
+// The ETag of the page a phone last got, which it revalidates with If-None-Match.
+static std::map<unsigned, std::string> phone_etags;
+
+// Captive portal detection: iPhones fetch /hotspot-detect.html, Android phones /generate_204.
+static void phone_probe(unsigned phone) {
+  std::string request = std::string("GET ") + (phone % 2 ? "/generate_204" : "/hotspot-detect.html") +
+    " HTTP/1.1\r\nHost: captive.apple.com\r\nUser-Agent: CaptiveNetworkSupport/1.0\r\nAccept: */*\r\n"
+    "Accept-Language: en-us\r\nAccept-Encoding: gzip, deflate\r\nConnection: keep-alive\r\n";
+  if (!phone_etags[phone].empty()) request += "If-None-Match: " + phone_etags[phone] + "\r\n";
+  request += "\r\n";
+  unsigned long session = portal_session;
+
+  auto next_probe = [phone, session]() {
+    schedule_at(now_us() + phone_probe_ms * 1000, [phone, session]() {
+      if (session == portal_session) phone_probe(phone);
+    });
+  };
+
+  // The probe host is looked up first, a probe without an answer is given up until the next one.
+  phone_resolve(phone, phone % 2 ? "connectivitycheck.gstatic.com" : "captive.apple.com",
+                [phone, session, request, next_probe](bool answered) {
+    if (session != portal_session) return;
+    if (!answered) {
+      stats.dns_probes_failed++;
+      next_probe();
+      return;
+    }
+
+    phone_request({request}, PHONE_GET, [phone, next_probe](const std::string &reply) {
+      if (reply.compare(0, 12, "HTTP/1.1 200") == 0) {
+        size_t etag = reply.find("\r\nETag: ");
+        size_t end = etag == std::string::npos ? etag : reply.find("\r\n", etag + 8);
+        phone_etags[phone] = etag == std::string::npos ? "" : reply.substr(etag + 8, end - etag - 8);
+      }
+
+      next_probe();
+    });
+  });
+}
+
+// A POST of the form with no body, which must not pass for the form taken before it.
+static void phone_submit_empty() {
+  std::string headers = "POST /checkpass.html HTTP/1.1\r\nHost: 172.16.0.1\r\n"
+    "Content-Type: application/x-www-form-urlencoded\r\nOrigin: http://172.16.0.1\r\n"
+    "Content-Length: 0\r\nConnection: keep-alive\r\n\r\n";
+  phone_request({headers}, PHONE_EMPTY_FORM, [](const std::string &) {});
+}
+
+// The form goes out as the headers, then the body in two segments. Submitted again until it's taken.
+// Once it is, the phone posts it again empty, while the AP is still up.
+static void phone_submit() {
+  std::string body = phone_form_body;
+  std::string headers = "POST /checkpass.html HTTP/1.1\r\nHost: 172.16.0.1\r\n"
+    "Content-Type: application/x-www-form-urlencoded\r\nOrigin: http://172.16.0.1\r\n"
+    "Content-Length: " + std::to_string(body.size()) + "\r\nConnection: keep-alive\r\n\r\n";
+  unsigned long session = portal_session;
+
+  phone_request({headers, body.substr(0, body.size() / 2), body.substr(body.size() / 2)}, PHONE_FORM,
+                [session](const std::string &reply) {
+    if (reply.compare(0, 12, "HTTP/1.1 200") == 0) {
+      schedule_at(now_us() + phone_empty_post_ms * 1000, [session]() {
+        if (session == portal_session) phone_submit_empty();
+      });
+      return;
+    }
+    schedule_at(now_us() + phone_probe_ms * 1000, [session]() {
+      if (session == portal_session) phone_submit();
+    });
+  });
+}
+
+static void phone_join(unsigned phone) {
+  if (wifi_status == WL_AP_LISTENING) wifi_status = WL_AP_CONNECTED;
+
+  unsigned long session = portal_session;
+  size_t names = sizeof(phone_join_names) / sizeof(phone_join_names[0]);
+  for (size_t i = 0; i < names; i++) {
+    schedule_at(now_us() + i * dns_burst_ms * 1000, [phone, session, i]() {
+      if (session == portal_session) phone_resolve(phone, phone_join_names[i], nullptr);
+    });
+  }
+
+  phone_probe(phone);
+
+  if (phone == 0) {
+    schedule_at(now_us() + phone_form_ms * 1000, [session]() {
+      if (session == portal_session) phone_submit();
+    });
+  }
+}
+
+// Ends the phones' scripts and their connections, when the AP opens or closes.
+static void portal_reset() {
+  if (dns_load_start_us) stats.dns_load_s += (now_us() - dns_load_start_us) / 1e6;
+  dns_load_start_us = 0;
+
+  portal_session++;
+  phone_etags.clear();
+  dns_queue.clear();
+  dns_lookups.clear();
+  server_sockets.clear();
+  server_next = 0;
+}
+
+}
+
+using namespace sim;
+
+uint8_t WiFiClass::status() {
+  spi_cmd();
+  link_up();
+  return wifi_status;
+}
+
+void WiFiClass::setTimeout(unsigned long timeout) {
+  begin_timeout_ms = timeout;
+}
+
+/**
+ * Joins the simulated access point. With a zero timeout (setTimeout(0)) the join runs in the
+ * background and status() reports WL_IDLE_STATUS until it completes, like WiFiNINA does.
+ */
+int WiFiClass::begin(const char *ssid, const char *passphrase) {
+  spi_cmd();
+  stats.wifi_begins++;
+  set_radio(true);
+
+  uint64_t join_ms;
+
+  if (!wifi_ap_up() || strcmp(ssid, ap_ssid) != 0 || strcmp(passphrase, ap_pass) != 0) {
+    join_ms = cost::wifi_fail_ms;
+    join_result = wifi_ap_up() ? WL_CONNECT_FAILED : WL_NO_SSID_AVAIL;
+  }
+  else {
+    join_ms = cost::wifi_scan_ms + cost::wifi_assoc_ms;
+    join_result = WL_CONNECTED;
+
+    if (!static_config) {
+      join_ms += cost::wifi_dhcp_ms;
+      stats.dhcp_leases++;
+    }
+  }
+
+  join_pending = true;
+  join_done_us = now_us() + join_ms * 1000;
+  wifi_status = WL_IDLE_STATUS;
+
+  if (begin_timeout_ms == 0) return wifi_status;
+
+  advance_ms(join_ms);
+  link_up();
+  return wifi_status;
+}
+
+uint8_t WiFiClass::beginAP(const char *ssid, uint8_t channel) {
+  (void) ssid;
+  (void) channel;
+  spi_cmd();
+  join_pending = false;
+  set_radio(true);
+  advance_ms(600);
+  wifi_status = WL_AP_LISTENING;
+
+  portal_reset();
+  unsigned long session = portal_session;
+  for (unsigned phone = 0; phone < opts.portal_phones; phone++) {
+    schedule_at(now_us() + (phone_join_ms + phone * phone_stagger_ms) * 1000, [phone, session]() {
+      if (session == portal_session) phone_join(phone);
+    });
+  }
+
+  if (opts.dns_qps > 0) {
+    schedule_at(now_us() + phone_join_ms * 1000, [session]() {
+      if (session != portal_session) return;
+      if (wifi_status == WL_AP_LISTENING) wifi_status = WL_AP_CONNECTED;
+      dns_load_start_us = now_us();
+      dns_load(session, 0);
+    });
+  }
+
+  return wifi_status;
+}
+
+int WiFiClass::disconnect() {
+  spi_cmd();
+  join_pending = false;
+  if (wifi_status != WL_IDLE_STATUS) wifi_status = WL_DISCONNECTED;
+  link_generation++;
+  return wifi_status;
+}
+
+void WiFiClass::end() {
+  spi_cmd();
+  join_pending = false;
+  advance_ms(cost::wifi_end_ms);
+  set_radio(false);
+  wifi_status = WL_IDLE_STATUS;
+  portal_reset();
+  static_config = false;
+  link_generation++;
+}
+
+void WiFiClass::config(IPAddress local_ip) {
+  config(local_ip, IPAddress(local_ip[0], local_ip[1], local_ip[2], 1));
+}
+
+void WiFiClass::config(IPAddress local_ip, IPAddress dns_server) {
+  config(local_ip, dns_server, IPAddress(local_ip[0], local_ip[1], local_ip[2], 1));
+}
+
+void WiFiClass::config(IPAddress local_ip, IPAddress dns_server, IPAddress gateway) {
+  config(local_ip, dns_server, gateway, IPAddress(255, 255, 255, 0));
+}
+
+void WiFiClass::config(IPAddress local_ip, IPAddress dns_server, IPAddress gateway, IPAddress subnet) {
+  (void) dns_server;
+  spi_cmd();
+  static_config = true;
+  static_ip = local_ip;
+  static_gw = gateway;
+  static_subnet = subnet;
+}
+
+void WiFiClass::setDNS(IPAddress dns_server1) {
+  (void) dns_server1;
+  spi_cmd();
+}
+
+int32_t WiFiClass::RSSI() {
+  spi_cmd();
+  return link_up() ? -58 - (int32_t) random(0, 6) : 0;
+}
+
+const char *WiFiClass::SSID() {
+  spi_cmd();
+  return link_up() ? ap_ssid : "";
+}
+
+uint8_t *WiFiClass::BSSID(uint8_t *bssid) {
+  static const uint8_t ap_bssid[6] = {0x66, 0x55, 0x44, 0x33, 0x22, 0x11};
+  spi_cmd();
+  memcpy(bssid, ap_bssid, 6);
+  return bssid;
+}
+
+uint8_t *WiFiClass::macAddress(uint8_t *mac) {
+  // NINA reports the MAC least significant byte first. Runs with different seeds are different
+  // boards, the default seed keeps the original address.
+  static const uint8_t nina_mac[6] = {0x5C, 0x3E, 0x12, 0xC4, 0x0A, 0x24};
+  spi_cmd();
+  memcpy(mac, nina_mac, 6);
+  mac[0] += (uint8_t) (opts.seed - 1);
+  return mac;
+}
+
+IPAddress WiFiClass::localIP() {
+  spi_cmd();
+  if (!link_up()) return IPAddress();
+  return static_config ? static_ip : IPAddress(192, 168, 1, 57);
+}
+
+IPAddress WiFiClass::subnetMask() {
+  spi_cmd();
+  if (!link_up()) return IPAddress();
+  return static_config ? static_subnet : IPAddress(255, 255, 255, 0);
+}
+
+IPAddress WiFiClass::gatewayIP() {
+  spi_cmd();
+  if (!link_up()) return IPAddress();
+  return static_config ? static_gw : IPAddress(192, 168, 1, 1);
+}
+
+IPAddress WiFiClass::dnsIP(int n) {
+  spi_cmd();
+  if (!link_up()) return IPAddress();
+  return n == 0 ? IPAddress(192, 168, 1, 1) : IPAddress(1, 1, 1, 1);
+}
+
+const char *WiFiClass::firmwareVersion() {
+  return "1.4.8-sim";
+}
+
+void WiFiClass::lowPowerMode() {
+  spi_cmd();
+}
+
+void WiFiClass::noLowPowerMode() {
+  spi_cmd();
+}
+
+void WiFiDrv::pinMode(uint8_t pin, uint8_t mode) {
+  (void) pin;
+  (void) mode;
+  spi_cmd();
+}
+
+void WiFiDrv::digitalWrite(uint8_t pin, uint8_t value) {
+  (void) pin;
+  (void) value;
+  spi_cmd();
+}
+
+void WiFiDrv::analogWrite(uint8_t pin, uint8_t value) {
+  (void) pin;
+  (void) value;
+  spi_cmd();
+}
+
+namespace sim {
+
+std::function<bool(const char *filename, uint32_t &len)> storage_fault_hook;
+
+struct FlashBlock {
+  std::vector<bool> programmed = std::vector<bool>(flash_block);
+  bool dirty = false;
+  unsigned long erases = 0;
+};
+
+static std::map<std::string, std::vector<FlashBlock>> flash;
+
+static void erase_block(FlashBlock &block) {
+  std::fill(block.programmed.begin(), block.programmed.end(), false);
+  block.dirty = false;
+  block.erases++;
+  stats.flash_block_erases++;
+}
+
+// Programs the bytes of a write, erasing the blocks it reprograms first.
+static void program_flash(const std::string &filename, uint32_t offset, uint32_t len) {
+  std::vector<FlashBlock> &blocks = flash[filename];
+  if (blocks.size() < (offset + len + flash_block - 1) / flash_block) {
+    blocks.resize((offset + len + flash_block - 1) / flash_block);
+  }
+
+  for (uint32_t i = offset; i < offset + len; ) {
+    FlashBlock &block = blocks[i / flash_block];
+    uint32_t end = std::min(offset + len, (i / flash_block + 1) * flash_block);
+
+    for (uint32_t j = i; j < end; j++) {
+      if (block.programmed[j % flash_block]) {
+        advance_ms(cost::storage_erase_ms);
+        erase_block(block);
+        break;
+      }
+    }
+    for (uint32_t j = i; j < end; j++) block.programmed[j % flash_block] = true;
+    block.dirty = true;
+    i = end;
+  }
+}
+
+unsigned long flash_block_wear_max(const std::string &prefix) {
+  unsigned long wear = 0;
+  for (auto &file : flash) {
+    if (file.first.compare(0, prefix.size(), prefix) != 0) continue;
+    for (FlashBlock &block : file.second) wear = std::max(wear, block.erases);
+  }
+  return wear;
+}
+
+}
+
+bool WiFiStorageClass::exists(const char *filename, uint32_t *size) {
+  advance_ms(cost::storage_op_ms);
+  stats.storage_opens++;
+
+  auto it = storage.find(filename);
+  if (it == storage.end()) return false;
+  if (size) *size = it->second.size();
+  return true;
+}
+
+bool WiFiStorageClass::remove(const char *filename) {
+  advance_ms(cost::storage_erase_ms);
+  stats.storage_erases++;
+
+  uint32_t none = 0;
+  if (storage_fault_hook && !storage_fault_hook(filename, none)) return false;
+
+  for (FlashBlock &block : flash[filename]) {
+    if (block.dirty) erase_block(block);
+  }
+
+  return storage.erase(filename) > 0;
+}
+
+bool WiFiStorageClass::read(const char *filename, uint32_t offset, uint8_t *buffer, uint32_t buffer_len) {
+  advance_us(cost::storage_op_ms * 1000 + buffer_len * cost::storage_byte_us);
+  stats.storage_reads++;
+
+  auto it = storage.find(filename);
+  if (it == storage.end() || offset + buffer_len > it->second.size()) return false;
+
+  memcpy(buffer, &it->second[offset], buffer_len);
+  stats.storage_bytes_read += buffer_len;
+  return true;
+}
+
+// The NINA firmware opens the file with fopen(..., "ab") whatever the offset, so every write lands at
+// the end of the file. The offset is ignored here the same way.
+bool WiFiStorageClass::write(const char *filename, uint32_t offset, const uint8_t *buffer, uint32_t buffer_len) {
+  (void) offset;
+  advance_us(cost::storage_op_ms * 1000 + buffer_len * cost::storage_byte_us);
+  stats.storage_writes++;
+
+  uint32_t len = buffer_len;
+  bool ok = !storage_fault_hook || storage_fault_hook(filename, len);
+  len = std::min(len, buffer_len);
+
+  std::vector<uint8_t> &file = storage[filename];
+  uint32_t end = file.size();
+  program_flash(filename, end, len);
+
+  file.resize(end + len);
+  memcpy(&file[end], buffer, len);
+  stats.storage_bytes_written += len;
+  return ok && len == buffer_len;
+}
+
+int WiFiClient::connect(const char *host, uint16_t port) {
+  (void) host;
+  (void) port;
+  spi_cmd();
+  return 0;
+}
+
+uint8_t WiFiClient::connected() {
+  spi_cmd();
+  return sock && (sock->open || sock->rx_pos < sock->rx.size());
+}
+
+void WiFiClient::stop() {
+  spi_cmd();
+  if (sock && sock->open) {
+    sock->open = false;
+    if (sock->on_close) sock->on_close();
+  }
+  sock = nullptr;
+}
+
+int WiFiClient::available() {
+  spi_cmd();
+  return sock ? (int) (sock->rx.size() - sock->rx_pos) : 0;
+}
+
+int WiFiClient::read() {
+  spi_cmd();
+  if (!sock || sock->rx_pos >= sock->rx.size()) return -1;
+  return (uint8_t) sock->rx[sock->rx_pos++];
+}
+
+int WiFiClient::read(uint8_t *buf, size_t size) {
+  spi_cmd();
+  if (!sock) return -1;
+  size_t n = sock->rx.size() - sock->rx_pos;
+  if (n > size) n = size;
+  advance_us(n * cost::spi_byte_us);
+  memcpy(buf, sock->rx.data() + sock->rx_pos, n);
+  sock->rx_pos += n;
+  return (int) n;
+}
+
+int WiFiClient::peek() {
+  spi_cmd();
+  if (!sock || sock->rx_pos >= sock->rx.size()) return -1;
+  return (uint8_t) sock->rx[sock->rx_pos];
+}
+
+size_t WiFiClient::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t WiFiClient::write(const uint8_t *buffer, size_t size) {
+  spi_cmd();
+  if (!sock) return 0;
+  advance_us(size * cost::spi_byte_us);
+  if (sock->tx.empty()) sock->first_tx_us = now_us();
+  sock->tx.append((const char *) buffer, size);
+  return size;
+}
+
+void WiFiServer::begin() {
+  spi_cmd();
+}
+
+/**
+ * Hands out a portal connection that has bytes to read, taking turns between them like the NINA.
+ */
+WiFiClient WiFiServer::available() {
+  spi_cmd();
+
+  server_sockets.erase(std::remove_if(server_sockets.begin(), server_sockets.end(),
+                                      [](const std::shared_ptr<Socket> &sock) { return !sock->open; }),
+                       server_sockets.end());
+
+  for (size_t n = 0; n < server_sockets.size(); n++) {
+    size_t i = (server_next + n) % server_sockets.size();
+    if (server_sockets[i]->rx_pos < server_sockets[i]->rx.size()) {
+      server_next = i + 1;
+      return WiFiClient(server_sockets[i]);
+    }
+  }
+
+  return WiFiClient();
+}
+
+uint8_t WiFiUDP::begin(uint16_t port) {
+  spi_cmd();
+  local_port = port;
+  if (port == 53) dns_listening = true;
+  return 1;
+}
+
+void WiFiUDP::stop() {
+  spi_cmd();
+  if (local_port == 53) dns_listening = false;
+  local_port = 0;
+}
+
+/**
+ * Takes the next queued datagram, dropping what is left of the one before, like WiFiNINA.
+ */
+int WiFiUDP::parsePacket() {
+  spi_cmd();
+  rx.clear();
+  rx_pos = 0;
+
+  if (local_port != 53 || dns_queue.empty()) return 0;
+
+  rx = dns_queue.front().packet;
+  rx_ip = dns_queue.front().ip;
+  rx_port = dns_queue.front().port;
+  dns_queue.pop_front();
+  return (int) rx.size();
+}
+
+int WiFiUDP::available() {
+  return (int) (rx.size() - rx_pos);
+}
+
+int WiFiUDP::read() {
+  spi_cmd();
+  return rx_pos < rx.size() ? rx[rx_pos++] : -1;
+}
+
+int WiFiUDP::read(unsigned char *buffer, size_t len) {
+  spi_cmd();
+  size_t n = rx.size() - rx_pos;
+  if (n > len) n = len;
+  advance_us(n * cost::spi_byte_us);
+  memcpy(buffer, rx.data() + rx_pos, n);
+  rx_pos += n;
+  return (int) n;
+}
+
+IPAddress WiFiUDP::remoteIP() {
+  return rx_ip;
+}
+
+uint16_t WiFiUDP::remotePort() {
+  return rx_port;
+}
+
+int WiFiUDP::beginPacket(IPAddress ip, uint16_t port) {
+  spi_cmd();
+  tx.clear();
+  tx_ip = ip;
+  tx_port = port;
+  return 1;
+}
+
+size_t WiFiUDP::write(uint8_t b) {
+  tx.push_back(b);
+  return 1;
+}
+
+size_t WiFiUDP::write(const uint8_t *buffer, size_t size) {
+  spi_cmd();
+  advance_us(size * cost::spi_byte_us);
+  tx.insert(tx.end(), buffer, buffer + size);
+  return size;
+}
+
+int WiFiUDP::endPacket() {
+  spi_cmd();
+  if (local_port == 53) dns_reply(tx_ip, tx_port, tx);
+  return 1;
+}
+
+void NTPClient::begin() {
+  udp.begin(123);
+  started = true;
+}
+
+bool NTPClient::forceUpdate() {
+  udp.beginPacket(IPAddress(), 123);
+  udp.endPacket();
+
+  if (!link_up()) {
+    advance_ms(1000); // NTPClient gives up after a second without a reply
+    return false;
+  }
+
+  advance_ms(cost::net_rtt_ms);
+  stats.ntp_queries++;
+  epoch = (unsigned long) true_epoch();
+  last_update_ms = millis() ? millis() : 1;
+  return true;
+}
+
+bool NTPClient::update() {
+  if (last_update_ms == 0 || millis() - last_update_ms >= 60000) {
+    if (!started) begin();
+    return forceUpdate();
+  }
+  return false;
+}
+
+unsigned long NTPClient::getEpochTime() const {
+  return epoch + (millis() - last_update_ms) / 1000;
+}
+
+void NTPClient::end() {
+  udp.stop();
+  started = false;
+}
+
+void MQTTClient::begin(const char host_[], int port_, Client &client) {
+  (void) client;
+  strncpy(host, host_, sizeof(host) - 1);
+  port = port_;
+}
+
+void MQTTClient::setWill(const char topic[], const char payload[], bool retained, int qos) {
+  (void) qos;
+  will_topic = topic;
+  will_payload = payload;
+  will_retained = retained;
+  has_will = true;
+}
+
+void MQTTClient::clearWill() {
+  has_will = false;
+}
+
+bool MQTTClient::connect(const char client_id[], bool skip) {
+  return connect(client_id, NULL, NULL, skip);
+}
+
+bool MQTTClient::connect(const char client_id[], const char username[], bool skip) {
+  return connect(client_id, username, NULL, skip);
+}
+
+bool MQTTClient::connect(const char client_id[], const char username[], const char password[], bool skip) {
+  (void) client_id;
+  (void) username;
+  (void) password;
+  (void) skip;
+
+  if (connected()) disconnect();
+
+  spi_cmd();
+  if (!link_up() || !broker_up()) {
+    advance_ms(link_up() ? cost::tcp_fail_ms : 1);
+    stats.mqtt_refused++;
+    last_error = LWMQTT_NETWORK_FAILED_CONNECT;
+    return false;
+  }
+
+  // TCP handshake, then CONNECT/CONNACK.
+  advance_ms(2 * cost::net_rtt_ms);
+  stats.mqtt_connects++;
+  note_mqtt_connect();
+
+  expire_session(true);
+  session.keep_alive_s = keep_alive_s;
+  session.has_will = has_will;
+  session.will_retained = will_retained;
+  session.will_topic = will_topic.c_str();
+  session.will_payload = will_payload.c_str();
+  session.last_packet_us = now_us();
+
+  is_connected = true;
+  inbox.clear();
+  link_generation = sim::link_generation;
+  last_error = LWMQTT_SUCCESS;
+  return_code = 0;
+  return true;
+}
+
+bool MQTTClient::publish(const char topic[], const char payload[], int length, bool retained, int qos) {
+  if (!connected()) {
+    last_error = LWMQTT_NETWORK_FAILED_CONNECT;
+    return false;
+  }
+
+  // Fixed header + topic length + packet id must fit the client's write buffer.
+  int packet = 5 + 2 + (int) strlen(topic) + (qos > 0 ? 2 : 0) + length;
+  if (packet > write_buf_size) {
+    last_error = LWMQTT_BUFFER_TOO_SHORT;
+    return false;
+  }
+
+  advance_us(cost::spi_cmd_us + packet * cost::spi_byte_us);
+
+  if (qos > 0) {
+    // Blocks until PUBACK, bounded by the command timeout.
+    if ((int) cost::net_rtt_ms > timeout_ms) {
+      advance_ms(timeout_ms);
+      last_error = LWMQTT_NETWORK_TIMEOUT;
+      is_connected = false;
+      return false;
+    }
+    advance_ms(cost::net_rtt_ms);
+  }
+
+  std::string p(payload, length);
+  session.last_packet_us = now_us();
+  session_publish(topic, p);
+  broker.log.push_back({topic, p, retained, qos, true_epoch()});
+  if (retained) {
+    if (p.empty()) broker.retained.erase(topic);
+    else broker.retained[topic] = p;
+  }
+
+  stats.mqtt_publishes++;
+  stats.mqtt_bytes += packet;
+  last_error = LWMQTT_SUCCESS;
+  return true;
+}
+
+// MQTT topic filter match with + and # wildcards.
+static bool topic_matches(const char *filter, const char *topic) {
+  while (*filter) {
+    if (*filter == '#') return true;
+
+    if (*filter == '+') {
+      while (*topic && *topic != '/') topic++;
+      filter++;
+      continue;
+    }
+
+    if (*filter != *topic) return false;
+    filter++;
+    topic++;
+  }
+  return *topic == 0;
+}
+
+bool MQTTClient::subscribe(const char topic[], int qos) {
+  (void) qos;
+  if (!connected()) return false;
+  advance_ms(cost::net_rtt_ms);
+
+  // The broker sends the matching retained messages right after the SUBACK.
+  for (auto &r : broker.retained) {
+    if (topic_matches(topic, r.first.c_str())) inbox.push_back(r);
+  }
+  return true;
+}
+
+bool MQTTClient::unsubscribe(const char topic[]) {
+  (void) topic;
+  if (!connected()) return false;
+  advance_ms(cost::net_rtt_ms);
+  return true;
+}
+
+bool MQTTClient::loop() {
+  spi_cmd();
+  if (!connected()) return false;
+
+  while (!inbox.empty()) {
+    String topic = inbox.front().first.c_str();
+    String payload = inbox.front().second.c_str();
+    inbox.pop_front();
+
+    advance_us(cost::spi_cmd_us + (topic.length() + payload.length()) * cost::spi_byte_us);
+    if (5 + 2 + (int) (topic.length() + payload.length()) > read_buf_size) {
+      last_error = LWMQTT_BUFFER_TOO_SHORT;
+      is_connected = false;
+      session.dropped = true;
+      return false;
+    }
+    if (callback) callback(topic, payload);
+  }
+
+  return true;
+}
+
+bool MQTTClient::connected() {
+  if (is_connected && (link_generation != sim::link_generation || !link_up() || !broker_up())) {
+    is_connected = false;
+    session.dropped = true;
+  }
+  return is_connected;
+}
+
+bool MQTTClient::disconnect() {
+  if (!is_connected) return false;
+  spi_cmd();
+  is_connected = false;
+  session.dropped = false; // A clean DISCONNECT discards the will
+  return true;
+}
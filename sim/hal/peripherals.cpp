@@ -0,0 +1,302 @@
+/*
+ * Host simulation of the on-board peripherals: RTC, low power modes, DHT22 and the Time/Timezone
+ * libraries.
+ */
+#include "Arduino.h"
+#include "ArduinoLowPower.h"
+#include "DHT.h"
+#include "RTCZero.h"
+#include "TimeLib.h"
+#include "Timezone_Generic.h"
+#include "sim.h"
+
+ArduinoLowPowerClass LowPower;
+
+using namespace sim;
+
+// Power pin the firmware drives to supply the DHT22 (DHT22_PWR).
+static const uint8_t dht_pwr_pin = 0;
+// The DHT22 needs about a second after power-up before it answers.
+static const uint64_t dht_settle_us = 1000000;
+
+static uint32_t rtc_base = 946684800; // RTCZero resets to 2000-01-01
+static uint64_t rtc_base_us = 0;
+
+static uint32_t rtc_now() {
+  double elapsed_s = (now_us() - rtc_base_us) / 1e6 * (1.0 + opts.rtc_drift_ppm * 1e-6);
+  return rtc_base + (uint32_t) elapsed_s;
+}
+
+void RTCZero::begin(bool reset_time) {
+  advance_us(200);
+  if (!configured || reset_time) {
+    rtc_base = 946684800;
+    rtc_base_us = now_us();
+  }
+  configured = true;
+}
+
+void RTCZero::enableAlarm(Alarm_Match match) {
+  (void) match;
+}
+
+void RTCZero::disableAlarm() {}
+
+void RTCZero::attachInterrupt(voidFuncPtr callback) {
+  (void) callback;
+}
+
+void RTCZero::detachInterrupt() {}
+
+void RTCZero::standbyMode() {
+  low_power_ms(1, STANDBY);
+}
+
+uint32_t RTCZero::getEpoch() {
+  advance_us(60); // Register read synchronization with the 32kHz domain
+  return rtc_now();
+}
+
+uint32_t RTCZero::getY2kEpoch() {
+  return getEpoch() - 946684800;
+}
+
+void RTCZero::setEpoch(uint32_t ts) {
+  advance_us(120);
+  rtc_base = ts;
+  rtc_base_us = now_us();
+}
+
+void RTCZero::setAlarmEpoch(uint32_t ts) {
+  (void) ts;
+  advance_us(120);
+}
+
+void ArduinoLowPowerClass::idle(uint32_t millis) {
+  low_power_ms(millis, IDLE);
+}
+
+void ArduinoLowPowerClass::sleep(uint32_t millis) {
+  low_power_ms(millis, STANDBY);
+}
+
+void ArduinoLowPowerClass::deepSleep() {
+  finish("deep sleep without wake-up source");
+}
+
+void ArduinoLowPowerClass::deepSleep(uint32_t millis) {
+  deep_sleep(millis);
+}
+
+void ArduinoLowPowerClass::attachInterruptWakeup(uint32_t pin, voidFuncPtr callback, uint32_t mode) {
+  (void) pin;
+  (void) callback;
+  (void) mode;
+}
+
+void DHT::begin(uint8_t usec) {
+  (void) usec;
+  has_read = false;
+}
+
+bool DHT::read(bool force) {
+  if (!force && has_read && millis() - last_read_ms < 2000) {
+    return !isnan(temperature);
+  }
+
+  advance_ms(cost::dht_read_ms);
+  last_read_ms = millis();
+  has_read = true;
+
+  if (pin_high_for_us(dht_pwr_pin) < dht_settle_us) {
+    temperature = NAN;
+    humidity = NAN;
+    return false;
+  }
+
+  // Slow daily cycle plus a little sensor noise, in the DHT22's raw tenths.
+  time_t t = true_epoch();
+  long period = (long) (opts.climate_period_h * 3600);
+  double phase = opts.stable_room ? 0 : 2 * M_PI * ((double) ((t - 6 * 3600) % period) / period - 0.375);
+  int t_raw = (int) lround(215 + 20 * sin(phase)) + (int) random(-1, 2);
+  int h_raw = (int) lround(450 - 60 * sin(phase)) + (int) random(-2, 3);
+
+  float f = t_raw;
+  f *= 0.1;
+  temperature = f;
+
+  f = h_raw;
+  f *= 0.1;
+  humidity = f;
+
+  return true;
+}
+
+float DHT::readTemperature(bool S, bool force) {
+  (void) S;
+  read(force);
+  return temperature;
+}
+
+float DHT::readHumidity(bool force) {
+  read(force);
+  return humidity;
+}
+
+static time_t sys_time = 0;
+static unsigned long prev_millis = 0;
+static time_t next_sync_time = 0;
+static timeStatus_t status = timeNotSet;
+static getExternalTime get_time_ptr = nullptr;
+static time_t sync_interval = 300;
+
+time_t now() {
+  while (millis() - prev_millis >= 1000) {
+    sys_time++;
+    prev_millis += 1000;
+  }
+
+  if (next_sync_time <= sys_time) {
+    if (get_time_ptr) {
+      time_t t = (*get_time_ptr)();
+      if (t != 0) {
+        setTime(t);
+      }
+      else {
+        next_sync_time = sys_time + sync_interval;
+        status = (status == timeNotSet) ? timeNotSet : timeNeedsSync;
+      }
+    }
+  }
+
+  return sys_time;
+}
+
+namespace sim {
+  time_t system_time() {
+    return sys_time + (time_t) ((millis() - prev_millis) / 1000);
+  }
+}
+
+void setTime(time_t t) {
+  sys_time = t;
+  next_sync_time = t + sync_interval;
+  status = timeSet;
+  prev_millis = millis();
+}
+
+void adjustTime(long adjustment) {
+  sys_time += adjustment;
+}
+
+timeStatus_t timeStatus() {
+  now();
+  return status;
+}
+
+void setSyncProvider(getExternalTime getTimeFunction) {
+  get_time_ptr = getTimeFunction;
+  next_sync_time = sys_time;
+  now();
+}
+
+void setSyncInterval(time_t interval) {
+  sync_interval = interval;
+  next_sync_time = sys_time + sync_interval;
+}
+
+void breakTime(time_t time, tmElements_t &tm) {
+  struct tm t;
+  gmtime_r(&time, &t);
+  tm.Second = t.tm_sec;
+  tm.Minute = t.tm_min;
+  tm.Hour = t.tm_hour;
+  tm.Wday = t.tm_wday + 1;
+  tm.Day = t.tm_mday;
+  tm.Month = t.tm_mon + 1;
+  tm.Year = t.tm_year - 70;
+}
+
+time_t makeTime(const tmElements_t &tm) {
+  struct tm t = {};
+  t.tm_sec = tm.Second;
+  t.tm_min = tm.Minute;
+  t.tm_hour = tm.Hour;
+  t.tm_mday = tm.Day;
+  t.tm_mon = tm.Month - 1;
+  t.tm_year = tm.Year + 70;
+  return timegm(&t);
+}
+
+static tmElements_t elements(time_t t) {
+  tmElements_t tm;
+  breakTime(t, tm);
+  return tm;
+}
+
+int hour(time_t t) { return elements(t).Hour; }
+int minute(time_t t) { return elements(t).Minute; }
+int second(time_t t) { return elements(t).Second; }
+int day(time_t t) { return elements(t).Day; }
+int weekday(time_t t) { return elements(t).Wday; }
+int month(time_t t) { return elements(t).Month; }
+int year(time_t t) { return tmYearToCalendar(elements(t).Year); }
+
+time_t Timezone::toLocal(time_t utc) {
+  if (year(utc) != year(dst_utc)) calcTimeChanges(year(utc));
+  return utcIsDST(utc) ? utc + dst.offset * SECS_PER_MIN : utc + std.offset * SECS_PER_MIN;
+}
+
+time_t Timezone::toLocal(time_t utc, TimeChangeRule **tcr) {
+  if (year(utc) != year(dst_utc)) calcTimeChanges(year(utc));
+
+  if (utcIsDST(utc)) {
+    *tcr = &dst;
+    return utc + dst.offset * SECS_PER_MIN;
+  }
+
+  *tcr = &std;
+  return utc + std.offset * SECS_PER_MIN;
+}
+
+bool Timezone::utcIsDST(time_t utc) {
+  if (year(utc) != year(dst_utc)) calcTimeChanges(year(utc));
+
+  if (std_utc == dst_utc) return false;
+  if (std_utc < dst_utc) return utc >= dst_utc || utc < std_utc;
+  return utc >= dst_utc && utc < std_utc;
+}
+
+void Timezone::calcTimeChanges(int yr) {
+  dst_loc = toTime_t(dst, yr);
+  std_loc = toTime_t(std, yr);
+  dst_utc = dst_loc - std.offset * SECS_PER_MIN;
+  std_utc = std_loc - dst.offset * SECS_PER_MIN;
+}
+
+time_t Timezone::toTime_t(TimeChangeRule r, int yr) {
+  uint8_t m = r.month;
+  uint8_t w = r.week;
+
+  // Last week of the month: work from the first week of the next month.
+  if (w == 0) {
+    if (++m > 12) {
+      m = 1;
+      ++yr;
+    }
+    w = 1;
+  }
+
+  tmElements_t tm;
+  tm.Hour = r.hour;
+  tm.Minute = 0;
+  tm.Second = 0;
+  tm.Day = 1;
+  tm.Month = m;
+  tm.Year = CalendarYrToTm(yr);
+
+  time_t t = makeTime(tm);
+  t += ((r.dow - weekday(t) + 7) % 7 + (w - 1) * 7) * SECS_PER_DAY;
+  if (r.week == 0) t -= 7 * SECS_PER_DAY;
+  return t;
+}
@@ -0,0 +1,55 @@
+/*
+ * Host simulation stand-in for the SAMD21 ADC registers (CMSIS sam.h).
+ *
+ * Only the fields the firmware programs directly are modelled. Conversions are not run by writes to
+ * these registers: the Adafruit_ZeroDMA stand-in reads the configuration when a transfer starts and
+ * fills the destination with the accumulated results the ADC would have produced.
+ */
+#ifndef SIM_SAM_H
+#define SIM_SAM_H
+
+#include <stdint.h>
+
+struct Adc {
+  union { struct { uint8_t SWRST:1, ENABLE:1, RUNSTDBY:1; } bit; uint8_t reg; } CTRLA;
+  union { uint8_t reg; } REFCTRL;
+  union { struct { uint8_t SAMPLENUM:4, ADJRES:3; } bit; uint8_t reg; } AVGCTRL;
+  union { struct { uint8_t SAMPLEN:6; } bit; uint8_t reg; } SAMPCTRL;
+  union { struct { uint16_t DIFFMODE:1, LEFTADJ:1, FREERUN:1, CORREN:1, RESSEL:2, :2, PRESCALER:3; } bit;
+          uint16_t reg; } CTRLB;
+  union { struct { uint8_t FLUSH:1, START:1; } bit; uint8_t reg; } SWTRIG;
+  union { struct { uint32_t MUXPOS:5, :3, MUXNEG:5, :3, INPUTSCAN:4, INPUTOFFSET:4, GAIN:4; } bit;
+          uint32_t reg; } INPUTCTRL;
+  union { struct { uint8_t RESRDY:1; } bit; uint8_t reg; } INTFLAG;
+  union { struct { uint8_t :7, SYNCBUSY:1; } bit; uint8_t reg; } STATUS;
+  union { uint16_t reg; } RESULT;
+};
+
+extern Adc sim_adc_regs;
+#define ADC (&sim_adc_regs)
+
+#define ADC_CTRLB_PRESCALER_DIV4 (0x0 << 8)
+#define ADC_CTRLB_PRESCALER_DIV8 (0x1 << 8)
+#define ADC_CTRLB_PRESCALER_DIV16 (0x2 << 8)
+#define ADC_CTRLB_PRESCALER_DIV32 (0x3 << 8)
+#define ADC_CTRLB_PRESCALER_DIV64 (0x4 << 8)
+#define ADC_CTRLB_PRESCALER_DIV512 (0x7 << 8)
+#define ADC_CTRLB_RESSEL_12BIT (0x0 << 4)
+#define ADC_CTRLB_RESSEL_16BIT (0x1 << 4)
+#define ADC_CTRLB_RESSEL_10BIT (0x2 << 4)
+#define ADC_CTRLB_FREERUN (0x1 << 2)
+
+#define ADC_AVGCTRL_SAMPLENUM(value) ((value) & 0xf)
+#define ADC_AVGCTRL_ADJRES(value) (((value) & 0x7) << 4)
+#define ADC_SAMPCTRL_SAMPLEN(value) ((value) & 0x3f)
+
+#define ADC_DMAC_ID_RESRDY 0x27
+
+// Pin to ADC channel mapping of the MKR WiFi 1010 variant.
+struct PinDescription {
+  uint8_t ulADCChannelNumber;
+};
+
+extern const PinDescription g_APinDescription[];
+
+#endif
@@ -0,0 +1,483 @@
+/*
+ * Tri-sensor host simulation: virtual clock, board model, run report and command line options.
+ */
+#include "Arduino.h"
+#include "sim.h"
+
+#include <set>
+
+namespace sim {
+
+void systick_advance(uint64_t us);
+
+Options opts;
+Stats stats;
+Broker broker;
+std::map<std::string, std::vector<uint8_t>> storage;
+
+static uint64_t clock_us = 0;
+static uint64_t cycle_start_us = 0;
+static double cycle_radio_s = 0;
+static double cycle_charge_mas = 0;
+static bool cycle_outage = false;
+static PowerMode mode = RUN;
+static bool radio = false;
+static uint8_t pins[64];
+static uint64_t pin_high_since[64];
+
+// The sensors are powered from these digital pins by the firmware (DHT22_PWR, PHOTORES_PWR).
+static const uint8_t sensor_pwr_pins[] = {0, 1};
+
+static double board_ma() {
+  double nina_ma = radio ? current::radio_ma : (pins[NINA_RESETN] == LOW ? current::nina_boot_ma : 0);
+  if (mode == STANDBY) return current::sleep_ma + nina_ma;
+
+  double ma = (mode == IDLE ? current::idle_ma : current::mcu_ma) + nina_ma;
+  for (uint8_t pin : sensor_pwr_pins) {
+    if (pins[pin] == HIGH) ma += current::sensors_ma / 2;
+  }
+  return ma;
+}
+
+uint64_t now_us() {
+  return clock_us;
+}
+
+static std::multimap<uint64_t, std::function<void()>> scheduled;
+
+void schedule_at(uint64_t at_us, std::function<void()> fn) {
+  scheduled.emplace(at_us, fn);
+}
+
+static void run_scheduled() {
+  while (!scheduled.empty() && scheduled.begin()->first <= clock_us) {
+    std::function<void()> fn = scheduled.begin()->second;
+    scheduled.erase(scheduled.begin());
+    fn();
+  }
+}
+
+void advance_us(uint64_t us) {
+  double dt = us / 1e6;
+  double mas = board_ma() * dt;
+
+  stats.charge_mas += mas;
+  cycle_charge_mas += mas;
+  if (radio) {
+    stats.radio_s += dt;
+    cycle_radio_s += dt;
+  }
+
+  if (mode == STANDBY) {
+    stats.sleep_s += dt;
+  }
+  else {
+    stats.awake_s += dt;
+    if (mode == RUN) stats.cpu_s += dt;
+    systick_advance(us);
+  }
+
+  clock_us += us;
+  run_scheduled();
+
+  if (hours_since_boot() > opts.max_hours) finish("simulated time limit reached");
+}
+
+time_t true_epoch() {
+  return opts.start_epoch + (time_t) (clock_us / 1000000);
+}
+
+double hours_since_boot() {
+  return clock_us / 3.6e9;
+}
+
+void set_radio(bool on) {
+  radio = on;
+}
+
+bool radio_on() {
+  return radio;
+}
+
+void set_pin(uint8_t pin, uint8_t val) {
+  if (pin >= sizeof(pins)) return;
+  if (val == HIGH && pins[pin] != HIGH) pin_high_since[pin] = clock_us;
+  pins[pin] = val;
+}
+
+uint64_t pin_high_for_us(uint8_t pin) {
+  if (pin >= sizeof(pins) || pins[pin] != HIGH) return 0;
+  return clock_us - pin_high_since[pin];
+}
+
+uint8_t pin_level(uint8_t pin) {
+  if (pin >= sizeof(pins)) return HIGH;
+  // RESET_PIN (14) is pulled up and never grounded in the simulation.
+  return pin == 14 ? HIGH : pins[pin];
+}
+
+/**
+ * Open circuit voltage of a 2000mAh LiPo from the charge drawn so far, minus the sag across its
+ * internal resistance when the radio is drawing current.
+ */
+double battery_mv(bool loaded) {
+  // Typical single cell LiPo at rest, every 10% from empty to full.
+  static const double ocv_mv[] = {3270, 3690, 3740, 3770, 3790, 3820, 3870, 3920, 3980, 4060, 4150};
+
+  const double capacity_mas = 2000.0 * 3600.0;
+  double soc = opts.battery_soc - stats.charge_mas / capacity_mas;
+  if (soc < 0) soc = 0;
+  if (soc > 1) soc = 1;
+
+  // Flat plateau in the middle, steep knees at both ends.
+  int i = soc >= 1 ? 9 : (int) (soc * 10);
+  double ocv = ocv_mv[i] + (ocv_mv[i + 1] - ocv_mv[i]) * (soc * 10 - i);
+  double sag = loaded ? board_ma() * 0.18 : 0.0; // ~180 mOhm cell + protection circuit
+  return ocv - sag;
+}
+
+static bool in_window(double from_h, double to_h) {
+  double h = hours_since_boot();
+  return from_h >= 0 && h >= from_h && h < to_h;
+}
+
+bool broker_up() {
+  return !in_window(opts.broker_down_from_h, opts.broker_down_to_h);
+}
+
+bool wifi_ap_up() {
+  return !in_window(opts.wifi_down_from_h, opts.wifi_down_to_h);
+}
+
+// Hours since boot the later of the outage windows ends, -1 without one.
+static double outage_end_h() {
+  double end_h = -1;
+  if (opts.broker_down_from_h >= 0) end_h = opts.broker_down_to_h;
+  if (opts.wifi_down_from_h >= 0 && opts.wifi_down_to_h > end_h) end_h = opts.wifi_down_to_h;
+  return end_h;
+}
+
+void note_mqtt_connect() {
+  double end_h = outage_end_h();
+  double h = hours_since_boot();
+  if (end_h >= 0 && h >= end_h && stats.reconnect_s < 0) stats.reconnect_s = (h - end_h) * 3600;
+}
+
+void low_power_ms(uint64_t ms, PowerMode m) {
+  uint64_t us = ms * 1000;
+
+  // An interrupt, i.e. a scheduled event such as a DMA transfer completing, ends IDLE early.
+  if (m == IDLE && !scheduled.empty() && scheduled.begin()->first < clock_us + us) {
+    us = scheduled.begin()->first > clock_us ? scheduled.begin()->first - clock_us : 0;
+  }
+
+  mode = m;
+  advance_us(us);
+  mode = RUN;
+}
+
+void deep_sleep(uint64_t ms) {
+  double awake_s = (clock_us - cycle_start_us) / 1e6;
+  stats.per_cycle.push_back({awake_s, cycle_radio_s, cycle_charge_mas, cycle_outage, cycle_start_us / 1e6});
+  stats.cycles++;
+
+  double clock_error_s = fabs((double) (system_time() - true_epoch()));
+  if (clock_error_s > stats.clock_error_max_s) stats.clock_error_max_s = clock_error_s;
+
+  if (stats.cycles >= opts.cycles) finish("cycle count reached");
+
+  low_power_ms(ms, STANDBY);
+
+  // Per-cycle figures cover the awake part only, the sleep shows up in the run totals.
+  cycle_start_us = clock_us;
+  cycle_radio_s = 0;
+  cycle_charge_mas = 0;
+  cycle_outage = !broker_up() || !wifi_ap_up();
+}
+
+static void print_hms(const char *label, double s) {
+  unsigned long t = (unsigned long) s;
+  printf("%-22s: %lu:%02lu:%02lu\n", label, t / 3600, (t / 60) % 60, t % 60);
+}
+
+static void write_hex(FILE *f, const uint8_t *data, size_t len) {
+  for (size_t i = 0; i < len; i++) fprintf(f, "%02x", data[i]);
+}
+
+static std::vector<uint8_t> parse_hex(const char *hex) {
+  std::vector<uint8_t> out;
+  unsigned int byte;
+  while (hex[0] && hex[1] && sscanf(hex, "%2x", &byte) == 1) {
+    out.push_back((uint8_t) byte);
+    hex += 2;
+  }
+  return out;
+}
+
+// One entry per line: 'S' for a WiFiStorage file or 'R' for a retained message, then the hex encoded
+// name and contents.
+void load_state() {
+  if (!opts.state_file) return;
+
+  FILE *f = fopen(opts.state_file, "r");
+  if (!f) return;
+
+  static char line[1 << 16];
+  char kind;
+  static char name[1024], data[1 << 16];
+
+  while (fgets(line, sizeof(line), f)) {
+    data[0] = 0;
+    if (sscanf(line, "%c %1023s %65535s", &kind, name, data) < 2) continue;
+
+    std::vector<uint8_t> key = parse_hex(name);
+    std::vector<uint8_t> value = parse_hex(data);
+    std::string key_str(key.begin(), key.end());
+
+    if (kind == 'S') storage[key_str] = value;
+    else if (kind == 'R') broker.retained[key_str] = std::string(value.begin(), value.end());
+  }
+
+  fclose(f);
+}
+
+void save_state() {
+  if (!opts.state_file) return;
+
+  FILE *f = fopen(opts.state_file, "w");
+  if (!f) {
+    perror(opts.state_file);
+    return;
+  }
+
+  for (auto &file : storage) {
+    fprintf(f, "S ");
+    write_hex(f, (const uint8_t *) file.first.data(), file.first.size());
+    fprintf(f, " ");
+    write_hex(f, file.second.data(), file.second.size());
+    fprintf(f, "\n");
+  }
+
+  for (auto &r : broker.retained) {
+    fprintf(f, "R ");
+    write_hex(f, (const uint8_t *) r.first.data(), r.first.size());
+    fprintf(f, " ");
+    write_hex(f, (const uint8_t *) r.second.data(), r.second.size());
+    fprintf(f, "\n");
+  }
+
+  fclose(f);
+}
+
+// The sample history the broker got: every sample time in the JSON state and backfill messages, once.
+// Reports how many there are and the longest stretch without one.
+static void print_history() {
+  std::set<time_t> times;
+
+  for (const Message &m : broker.log) {
+    bool state = m.topic.size() > 6 && m.topic.compare(m.topic.size() - 6, 6, "/state") == 0;
+    bool backfill = m.topic.size() > 9 && m.topic.compare(m.topic.size() - 9, 9, "/backfill") == 0;
+    if (!state && !backfill) continue;
+
+    for (size_t at = m.payload.find("\"time\":\""); at != std::string::npos;
+         at = m.payload.find("\"time\":\"", at + 1)) {
+      struct tm tm = {};
+      int offset_h = 0, offset_m = 0;
+      char sign = '+';
+      if (sscanf(m.payload.c_str() + at + 8, "%d-%d-%dT%d:%d:%d%c%d:%d", &tm.tm_year, &tm.tm_mon, &tm.tm_mday,
+                 &tm.tm_hour, &tm.tm_min, &tm.tm_sec, &sign, &offset_h, &offset_m) != 9) {
+        continue;
+      }
+
+      tm.tm_year -= 1900;
+      tm.tm_mon -= 1;
+      int offset_s = (offset_h * 60 + offset_m) * 60;
+      times.insert(timegm(&tm) - (sign == '-' ? -offset_s : offset_s));
+    }
+  }
+
+  if (times.empty()) return;
+
+  time_t gap = 0;
+  for (auto it = std::next(times.begin()); it != times.end(); ++it) gap = std::max(gap, *it - *std::prev(it));
+  printf("%-22s: %zu samples published, longest gap %.0f min\n", "history", times.size(), gap / 60.0);
+}
+
+void finish(const char *reason) {
+  fflush(stdout);
+  finish_network();
+  save_state();
+  if (opts.serial_out) fclose(opts.serial_out);
+
+  double awake_avg = 0, radio_avg = 0, charge_avg = 0, awake_max = 0;
+  double outage_radio_s = 0, outage_charge_mas = 0;
+  size_t outage_cycles = 0;
+  for (const CycleStats &c : stats.per_cycle) {
+    awake_avg += c.awake_s;
+    radio_avg += c.radio_s;
+    charge_avg += c.charge_mas;
+    if (c.awake_s > awake_max) awake_max = c.awake_s;
+    if (c.outage) {
+      outage_cycles++;
+      outage_radio_s += c.radio_s;
+      outage_charge_mas += c.charge_mas;
+    }
+  }
+
+  size_t n = stats.per_cycle.size();
+  if (n) {
+    awake_avg /= n;
+    radio_avg /= n;
+    charge_avg /= n;
+  }
+
+  double elapsed_s = clock_us / 1e6;
+  double mah = stats.charge_mas / 3600.0;
+
+  printf("\n== tri-sensor host simulation (%s) ==\n", reason);
+  printf("%-22s: %lu\n", "wake cycles", stats.cycles);
+  print_hms("simulated time", elapsed_s);
+  printf("%-22s: avg %.3f s, max %.3f s\n", "awake per cycle", awake_avg, awake_max);
+  printf("%-22s: avg %.3f s\n", "radio on per cycle", radio_avg);
+  printf("%-22s: avg %.1f ms\n", "cpu running per cycle", stats.cycles ? stats.cpu_s * 1000 / stats.cycles : 0.0);
+  printf("%-22s: avg %.3f mAs\n", "awake charge per cycle", charge_avg);
+  printf("%-22s: %.3f mAh total, %.2f mAh/day\n", "charge",
+         mah, elapsed_s > 0 ? mah * 86400.0 / elapsed_s : 0.0);
+  printf("%-22s: %.0f mV\n", "battery (rest)", battery_mv(false));
+  printf("%-22s: %lu begin, %lu assoc, %lu dhcp\n", "wifi",
+         stats.wifi_begins, stats.wifi_associations, stats.dhcp_leases);
+  printf("%-22s: %lu connects (%lu refused), %lu publishes, %lu bytes\n", "mqtt",
+         stats.mqtt_connects, stats.mqtt_refused, stats.mqtt_publishes, stats.mqtt_bytes);
+  if (n > 2) {
+    // The boot wake is off the slots, the period is measured from the wake after it.
+    double period_s = (stats.per_cycle[n - 1].start_s - stats.per_cycle[1].start_s) / (n - 2);
+    double phase_s = fmod(opts.start_epoch + stats.per_cycle[n - 1].start_s, 300.0);
+    printf("%-22s: period avg %.3f s, last wake %.0f s into its 5 min\n", "wake slots", period_s, phase_s);
+  }
+  if (outage_end_h() >= 0) {
+    printf("%-22s: %zu cycles, radio avg %.3f s, charge avg %.3f mAs per cycle\n", "outage", outage_cycles,
+           outage_cycles ? outage_radio_s / outage_cycles : 0.0, outage_cycles ? outage_charge_mas / outage_cycles : 0.0);
+    if (stats.reconnect_s >= 0) printf("%-22s: %.0f s after the outage\n", "reconnect", stats.reconnect_s);
+    else printf("%-22s: none after the outage\n", "reconnect");
+  }
+  printf("%-22s: %lu wills, offline %.0f s\n", "availability", stats.mqtt_wills, stats.offline_s);
+  printf("%-22s: %lu queries\n", "ntp", stats.ntp_queries);
+  printf("%-22s: max %.0f s\n", "clock error", stats.clock_error_max_s);
+  printf("%-22s: %lu opens, %lu reads (%lu B), %lu writes (%lu B), %lu erases\n", "wifistorage",
+         stats.storage_opens, stats.storage_reads, stats.storage_bytes_read,
+         stats.storage_writes, stats.storage_bytes_written, stats.storage_erases);
+  printf("%-22s: %lu block erases, max %lu per block\n", "flash wear",
+         stats.flash_block_erases, flash_block_wear_max());
+  print_history();
+  if (stats.portal_gets + stats.portal_posts + stats.portal_failed > 0) {
+    double gets = stats.portal_gets ? stats.portal_gets : 1;
+    printf("%-22s: %lu pages (%lu not modified), %.0f B per page\n", "portal",
+           stats.portal_gets, stats.portal_not_modified, stats.portal_bytes / gets);
+    printf("%-22s: first byte avg %.0f ms, max %.0f ms; loaded avg %.0f ms, max %.0f ms\n", "portal pages",
+           stats.portal_ttfb_s * 1000 / gets, stats.portal_ttfb_max_s * 1000,
+           stats.portal_load_s * 1000 / gets, stats.portal_load_max_s * 1000);
+    printf("%-22s: %lu posts, done avg %.0f ms, max %.0f ms, %lu requests failed\n", "portal form",
+           stats.portal_posts, stats.portal_posts ? stats.portal_post_s * 1000 / stats.portal_posts : 0.0,
+           stats.portal_post_max_s * 1000, stats.portal_failed);
+    if (stats.portal_empty_posts > 0) {
+      printf("%-22s: %lu empty posts, %lu accepted\n", "portal empty form", stats.portal_empty_posts,
+             stats.portal_empty_accepted);
+    }
+  }
+  if (stats.dns_queries > 0) {
+    printf("%-22s: %lu lookups, %lu answered (%lu negative), %lu wrong, %lu unanswered, %lu probes failed\n",
+           "portal dns", stats.dns_queries, stats.dns_answered, stats.dns_negative, stats.dns_wrong,
+           stats.dns_unanswered, stats.dns_probes_failed);
+    printf("%-22s: %lu retries, %lu dropped; answered avg %.0f ms, max %.0f ms\n", "portal dns sends",
+           stats.dns_retries, stats.dns_dropped,
+           stats.dns_answered ? stats.dns_latency_s * 1000 / stats.dns_answered : 0.0, stats.dns_latency_max_s * 1000);
+  }
+  if (stats.dns_load_s > 0) {
+    printf("%-22s: %.0f queries/s offered, %.0f answered\n", "portal dns load",
+           stats.dns_load_queries / stats.dns_load_s, stats.dns_load_answered / stats.dns_load_s);
+  }
+
+  exit(0);
+}
+
+void seed_legacy_credentials() {
+  // The two files the firmware before the settings record wrote after the AP portal form was submitted.
+  std::vector<uint8_t> wifi(32 + 1 + 32 + 1, 0);
+  memcpy(&wifi[0], "SimNet", 6);
+  wifi[32] = 1;
+  memcpy(&wifi[33], "sim-password", 12);
+  storage["/fs/wifi_creds"] = wifi;
+
+  std::vector<uint8_t> mqtt(128 + 1 + 8 + 1 + 32 + 1 + 32 + 1 + 32 + 1, 0);
+  size_t o = 0;
+  memcpy(&mqtt[o], "broker.sim", 10); o += 128; mqtt[o++] = 1;
+  memcpy(&mqtt[o], "1883", 4); o += 8; mqtt[o++] = 1;
+  memcpy(&mqtt[o], "sensor", 6); o += 32; mqtt[o++] = 1;
+  memcpy(&mqtt[o], "sensor-pass", 11); o += 32; mqtt[o++] = 1;
+  memcpy(&mqtt[o], "Office", 6);
+  storage["/fs/mqtt_creds"] = mqtt;
+}
+
+static void usage(const char *argv0) {
+  fprintf(stderr,
+    "usage: %s [options]\n"
+    "  --cycles N            wake cycles to run (default %lu)\n"
+    "  --seed N              random seed (default %lu)\n"
+    "  --quiet               suppress firmware Serial output\n"
+    "  --serial-out FILE     write firmware Serial output (incl. trace records) to FILE\n"
+    "  --max-hours H         abort after H simulated hours\n"
+    "  --rtc-drift PPM       RTC crystal frequency error\n"
+    "  --no-creds            boot with empty WiFiStorage\n"
+    "  --legacy-creds        boot with the credential files of the firmware before the settings record\n"
+    "  --broker-down A B     broker unreachable between hours A and B\n"
+    "  --wifi-down A B       access point unreachable between hours A and B\n"
+    "  --stable-room         no daily temperature, humidity and light cycle\n"
+    "  --climate-period H    period of the temperature and humidity cycle (default 24)\n"
+    "  --battery-soc P       battery charge at boot in percent (default 100)\n"
+    "  --portal-phones N     phones that join the AP portal, the first submits the form\n"
+    "  --dns-qps N           DNS queries per second sent to the AP portal on top of the phones'\n"
+    "  --state FILE          load WiFiStorage and retained messages from FILE, save them at exit\n",
+    argv0, opts.cycles, opts.seed);
+  exit(2);
+}
+
+void parse_options(int argc, char **argv) {
+  for (int i = 1; i < argc; i++) {
+    const char *a = argv[i];
+    bool has1 = i + 1 < argc, has2 = i + 2 < argc;
+
+    if (!strcmp(a, "--cycles") && has1) opts.cycles = strtoul(argv[++i], NULL, 10);
+    else if (!strcmp(a, "--seed") && has1) opts.seed = strtoul(argv[++i], NULL, 10);
+    else if (!strcmp(a, "--quiet")) opts.quiet = true;
+    else if (!strcmp(a, "--serial-out") && has1) {
+      opts.serial_out = fopen(argv[++i], "wb");
+      if (!opts.serial_out) {
+        perror(argv[i]);
+        exit(1);
+      }
+    }
+    else if (!strcmp(a, "--max-hours") && has1) opts.max_hours = atof(argv[++i]);
+    else if (!strcmp(a, "--rtc-drift") && has1) opts.rtc_drift_ppm = atof(argv[++i]);
+    else if (!strcmp(a, "--no-creds")) opts.no_creds = true;
+    else if (!strcmp(a, "--legacy-creds")) opts.legacy_creds = true;
+    else if (!strcmp(a, "--broker-down") && has2) {
+      opts.broker_down_from_h = atof(argv[++i]);
+      opts.broker_down_to_h = atof(argv[++i]);
+    }
+    else if (!strcmp(a, "--wifi-down") && has2) {
+      opts.wifi_down_from_h = atof(argv[++i]);
+      opts.wifi_down_to_h = atof(argv[++i]);
+    }
+    else if (!strcmp(a, "--stable-room")) opts.stable_room = true;
+    else if (!strcmp(a, "--climate-period") && has1) opts.climate_period_h = atof(argv[++i]);
+    else if (!strcmp(a, "--portal-phones") && has1) opts.portal_phones = strtoul(argv[++i], NULL, 10);
+    else if (!strcmp(a, "--dns-qps") && has1) opts.dns_qps = strtoul(argv[++i], NULL, 10);
+    else if (!strcmp(a, "--battery-soc") && has1) opts.battery_soc = atof(argv[++i]) / 100.0;
+    else if (!strcmp(a, "--state") && has1) opts.state_file = argv[++i];
+    else usage(argv[0]);
+  }
+
+  cycle_outage = !broker_up() || !wifi_ap_up();
+}
+
+}
@@ -0,0 +1,224 @@
+/*
+ * Tri-sensor host simulation: virtual clock, board model and run statistics.
+ *
+ * All HAL stand-ins charge their cost against one virtual clock. The clock integrates the current
+ * drawn by the board so that a run can report awake time, radio-on time and charge per wake cycle.
+ */
+#ifndef SIM_SIM_H
+#define SIM_SIM_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace sim {
+
+struct Options {
+  unsigned long cycles = 12;            // Number of deep sleep cycles to run before reporting
+  unsigned long seed = 1;               // Seed for the sensor noise and the firmware's random()
+  double max_hours = 24 * 30;           // Give up (e.g. stuck in the AP portal) after this much simulated time
+  bool quiet = false;                   // Suppress the firmware's Serial output
+  FILE *serial_out = nullptr;           // Capture the firmware's Serial output here instead of stdout
+  time_t start_epoch = 1792256400;      // 2026-10-17T17:00:00Z
+  double rtc_drift_ppm = 0.0;           // Frequency error of the 32.768kHz RTC crystal
+  bool no_creds = false;                // Boot with empty WiFiStorage (opens the AP portal)
+  bool legacy_creds = false;            // Boot with /fs/wifi_creds and /fs/mqtt_creds, to be migrated
+  double broker_down_from_h = -1;       // Broker outage window, in simulated hours since boot
+  double broker_down_to_h = -1;
+  double wifi_down_from_h = -1;         // Access point outage window, in simulated hours since boot
+  double wifi_down_to_h = -1;
+  const char *state_file = nullptr;     // Keeps WiFiStorage and the broker's retained messages across runs
+  bool stable_room = false;             // No daily temperature, humidity and light cycle, just sensor noise
+  double climate_period_h = 24;         // Period of the temperature and humidity cycle
+  double battery_soc = 1.0;             // Battery state of charge at boot
+  unsigned portal_phones = 0;           // Phones that join the AP portal; the first submits the form
+  unsigned dns_qps = 0;                 // Steady DNS query load on the AP portal, on top of the phones'
+};
+
+extern Options opts;
+
+// Costs of the simulated peripherals. Rough figures for the MKR WiFi 1010 (SAMD21 + NINA-W102).
+namespace cost {
+  const uint32_t wifi_scan_ms = 1400;       // Active scan of all channels before association
+  const uint32_t wifi_assoc_ms = 350;       // 802.11 auth + association + WPA2 handshake
+  const uint32_t wifi_dhcp_ms = 900;        // DHCP discover/offer/request/ack
+  const uint32_t wifi_fail_ms = 8000;       // WiFi.begin() timeout when the network is unreachable
+  const uint32_t wifi_end_ms = 40;          // NINA deinit
+  const uint32_t net_rtt_ms = 25;           // LAN round trip to broker / NTP relay
+  const uint32_t tcp_fail_ms = 1000;        // Connect timeout when the broker is down
+  const uint32_t spi_cmd_us = 400;          // One SPI command to the NINA
+  const uint32_t spi_byte_us = 2;           // Socket, UDP and MQTT data over SPI, per byte
+  const uint32_t storage_op_ms = 4;         // WiFiStorage open/exists/seek round trip
+  const uint32_t storage_byte_us = 12;      // WiFiStorage read/write per byte
+  const uint32_t storage_erase_ms = 45;     // WiFiStorage file erase (flash sector erase)
+  const uint32_t dht_read_ms = 5;           // DHT22 single-wire transfer
+  const uint32_t adc_sample_us = 425;       // analogRead() with the core's default ADC configuration
+}
+
+// Current draw model (mA).
+namespace current {
+  const double sleep_ma = 0.8;              // Board floor in standby with the NINA held in reset
+  const double mcu_ma = 12.0;               // SAMD21 awake at 48MHz
+  const double idle_ma = 4.5;               // SAMD21 in IDLE (CPU halted, clocks and SysTick running)
+  const double radio_ma = 85.0;             // NINA-W102 powered with WiFi up (average incl. TX bursts)
+  const double nina_boot_ma = 25.0;         // NINA-W102 out of reset with WiFi not yet up (ESP32 booting)
+  const double sensors_ma = 1.5;            // DHT22 + photoresistor divider when powered
+}
+
+struct CycleStats {
+  double awake_s;
+  double radio_s;
+  double charge_mas;
+  bool outage;                            // Woke with the broker or the access point down
+  double start_s;                         // Since boot
+};
+
+struct Stats {
+  unsigned long cycles = 0;
+  double awake_s = 0;
+  double radio_s = 0;
+  double sleep_s = 0;
+  double cpu_s = 0;                       // Awake with the CPU running, not in IDLE
+  double charge_mas = 0;                  // Charge drawn, in milliamp-seconds
+  std::vector<CycleStats> per_cycle;
+
+  unsigned long wifi_begins = 0;
+  unsigned long wifi_associations = 0;
+  unsigned long dhcp_leases = 0;
+  unsigned long mqtt_connects = 0;
+  unsigned long mqtt_refused = 0;         // Connects that failed with the network or the broker down
+  double reconnect_s = -1;                // End of the outage windows to the first connect after it
+  unsigned long mqtt_publishes = 0;
+  unsigned long mqtt_bytes = 0;
+  unsigned long mqtt_wills = 0;           // Wills the broker published for dropped sessions
+  double offline_s = 0;                   // Time the availability topic said offline
+  unsigned long ntp_queries = 0;
+  double clock_error_max_s = 0;           // Largest system clock error seen when going to sleep
+  unsigned long storage_opens = 0;         // exists()/open() queries
+  unsigned long storage_reads = 0;
+  unsigned long storage_writes = 0;
+  unsigned long storage_erases = 0;
+  unsigned long storage_bytes_read = 0;
+  unsigned long storage_bytes_written = 0;
+  unsigned long flash_block_erases = 0;    // Flash blocks erased by removes and by rewrites of programmed bytes
+  unsigned long portal_gets = 0;          // Portal page requests answered with 200 or 304
+  double portal_ttfb_s = 0;                // Summed: first request byte in to first reply byte out
+  double portal_ttfb_max_s = 0;
+  unsigned long portal_posts = 0;          // Form submissions answered with 200
+  double portal_post_s = 0;                // Summed: first request byte in to the connection closed
+  double portal_post_max_s = 0;
+  unsigned long portal_failed = 0;         // Requests closed without a 200 or 304
+  unsigned long portal_empty_posts = 0;    // Form submissions with an empty body, not counted above
+  unsigned long portal_empty_accepted = 0; // Of them, answered with 200
+  unsigned long portal_not_modified = 0;   // Pages answered with 304, counted in portal_gets too
+  double portal_load_s = 0;                // Summed: first request byte in to the page's connection closed
+  double portal_load_max_s = 0;
+  unsigned long portal_bytes = 0;          // Reply bytes of the pages
+  unsigned long dns_queries = 0;           // Lookups sent to the AP portal, each counted once however often sent
+  unsigned long dns_retries = 0;           // Sends again after no answer
+  unsigned long dns_dropped = 0;           // Datagrams dropped by the NINA with its receive queue full
+  unsigned long dns_answered = 0;          // Lookups answered with a reply a resolver takes
+  unsigned long dns_negative = 0;          // Of them, answered without records (AAAA, HTTPS)
+  unsigned long dns_wrong = 0;             // Lookups answered with a reply a resolver throws away
+  unsigned long dns_unanswered = 0;        // Lookups given up on
+  unsigned long dns_probes_failed = 0;     // Captive portal probes not made, the probe host didn't resolve
+  double dns_latency_s = 0;                // Summed: first send to the answer
+  double dns_latency_max_s = 0;
+  unsigned long dns_load_queries = 0;      // Of dns_queries, from the --dns-qps load
+  unsigned long dns_load_answered = 0;
+  double dns_load_s = 0;                   // Time the load ran
+};
+
+extern Stats stats;
+
+// Virtual clock. now_us() is true elapsed time since boot, including deep sleep.
+uint64_t now_us();
+void advance_us(uint64_t us);
+inline void advance_ms(uint64_t ms) { advance_us(ms * 1000); }
+time_t true_epoch();
+time_t system_time();                     // The firmware's TimeLib clock, without triggering a sync
+double hours_since_boot();
+
+// Board state that changes the current draw.
+enum PowerMode { RUN, IDLE, STANDBY };
+
+void set_radio(bool on);
+bool radio_on();
+void set_pin(uint8_t pin, uint8_t val);
+uint8_t pin_level(uint8_t pin);
+uint64_t pin_high_for_us(uint8_t pin);
+double battery_mv(bool loaded);
+
+// Analog inputs: noise-free level in 10-bit counts, and the gain applied to the ADC's few LSB of noise.
+double adc_level(uint8_t pin);
+double adc_noise_gain(uint8_t pin);
+
+// Runs fn once the virtual clock reaches at_us, e.g. to complete a DMA transfer in the background.
+void schedule_at(uint64_t at_us, std::function<void()> fn);
+
+// Spends ms in a low power mode without ending the wake cycle.
+void low_power_ms(uint64_t ms, PowerMode mode);
+
+// Called by LowPower.deepSleep(): closes the current wake cycle and sleeps.
+void deep_sleep(uint64_t ms);
+
+// Parses the command line into opts. Exits with usage on unknown options.
+void parse_options(int argc, char **argv);
+
+// Writes the credential files the AP portal of the firmware before the settings record stored.
+void seed_legacy_credentials();
+
+// Loads/saves WiFiStorage and the retained messages from/to opts.state_file, so that consecutive runs
+// behave like a board reset: flash and broker survive, RAM does not.
+void load_state();
+void save_state();
+
+// Lets the broker time out a dropped session before the report.
+void finish_network();
+
+// Prints the run report and exits.
+[[noreturn]] void finish(const char *reason);
+
+bool broker_up();
+bool wifi_ap_up();
+
+// Called by MQTTClient::connect() on success, for the reconnect time after the outage windows.
+void note_mqtt_connect();
+
+// Simulated MQTT broker.
+struct Message {
+  std::string topic;
+  std::string payload;
+  bool retained;
+  int qos;
+  time_t epoch;
+};
+
+struct Broker {
+  std::map<std::string, std::string> retained;
+  std::vector<Message> log;
+};
+
+extern Broker broker;
+
+// Simulated NINA file system backing WiFiStorage.
+extern std::map<std::string, std::vector<uint8_t>> storage;
+
+// Flash wear of the NINA file system, in blocks of flash_block bytes per file. A block is erased when a
+// write programs a byte already programmed since the block was last erased, and when its file is removed.
+const uint32_t flash_block = 4096;
+unsigned long flash_block_wear_max(const std::string &prefix = "");  // Most erases of a block of the files
+
+// Lets a tool inject resets into WiFiStorage. Called before each write with its length and before each
+// remove with 0. Returning false fails the operation as a reset in the middle of it would: only the
+// first len bytes of a write reach the flash, a remove doesn't happen.
+extern std::function<bool(const char *filename, uint32_t &len)> storage_fault_hook;
+
+}
+
+#endif
@@ -0,0 +1,19 @@
+/*
+ * Host simulation stand-in for the SAMD core's wiring_private.h.
+ */
+#ifndef SIM_WIRING_PRIVATE_H
+#define SIM_WIRING_PRIVATE_H
+
+#include "Arduino.h"
+
+enum EPioType {
+  PIO_ANALOG = 1,
+};
+
+inline int pinPeripheral(uint32_t pin, EPioType type) {
+  (void) pin;
+  (void) type;
+  return 0;
+}
+
+#endif
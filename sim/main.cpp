@@ -0,0 +1,42 @@
+/*
+ * Entry point of the host simulation: runs the sketch's setup() once and loop() until the scenario
+ * ends (see sim::finish()).
+ */
+#include <Arduino.h>
+#include "hal/sim.h"
+#include "../src/settings/settings.h"
+
+void setup();
+void loop();
+
+// Stores the settings record the AP portal would have written.
+static void seed_settings() {
+  SettingsRecord record;
+  memset(&record, 0, sizeof(record));
+  record.header = {SETTINGS_MAGIC, SETTINGS_VERSION, sizeof(Settings)};
+  strcpy(record.settings.wifi.ssid, "SimNet");
+  strcpy(record.settings.wifi.password, "sim-password");
+  strcpy(record.settings.mqtt.host, "broker.sim");
+  strcpy(record.settings.mqtt.port, "1883");
+  strcpy(record.settings.mqtt.username, "sensor");
+  strcpy(record.settings.mqtt.password, "sensor-pass");
+  strcpy(record.settings.name, "Office");
+  record.crc = crc32(0, &record, offsetof(SettingsRecord, crc));
+
+  const uint8_t *p = (const uint8_t *) &record;
+  sim::storage[SETTINGS_FILE] = std::vector<uint8_t>(p, p + sizeof(record));
+}
+
+int main(int argc, char **argv) {
+  sim::parse_options(argc, argv);
+  randomSeed(sim::opts.seed);
+
+  if (sim::opts.legacy_creds) sim::seed_legacy_credentials();
+  else if (!sim::opts.no_creds) seed_settings();
+  sim::load_state();
+
+  setup();
+  for (;;) {
+    loop();
+  }
+}
@@ -0,0 +1,44 @@
+/*
+ * Builds the unmodified sketch for the host simulation.
+ *
+ * The Arduino builder concatenates the .ino files (main sketch first) and generates prototypes for
+ * every function they define. This translation unit does the same by hand, so a function added to
+ * a .ino file also needs a prototype here.
+ */
+#include <Arduino.h>
+#include <TimeLib.h>
+
+struct DiscoveryState;
+struct Sample;
+enum WiFiState : uint8_t;
+
+time_t syncClock();
+void mac2Char(byte mac[], char str[]);
+void ntpClockUpdate();
+void syncClockToRtc();
+bool mqttConnect();
+void mqttPublishDiscovery();
+bool discoveryRetained();
+void countRetainedDiscovery(String &, String &payload);
+void printDiscoveryCounters(const DiscoveryState &state);
+void buildTopicNames();
+void ninaRelease();
+void ninaWaitBoot();
+void ninaHold();
+bool wifiConnect();
+void wifiStateChanged(WiFiState state);
+void takeSample(Sample &sample);
+void batteryUnderLoad();
+void bufferSample(const Sample &sample);
+const char *state_payload_topic();
+bool publishSamples(const char *topic, const Sample *batch, int count, unsigned long interval_s,
+                    unsigned long *ack_us);
+void spillSamples();
+void spillWithoutRadio();
+void backfillSamples();
+void printBackoff();
+
+time_t localTime(time_t utc, int *offset_minutes);
+
+#include "../tri_sensor.ino"
+#include "../helpers.ino"
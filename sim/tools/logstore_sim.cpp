@@ -0,0 +1,225 @@
+/*
+ * Host simulation of years of wake cycles against the log store.
+ *
+ * Every wake updates a set of state records of the kind the firmware keeps across resets: counters
+ * each wake, a larger cache every other wake, a daily record and a key that is deleted and written
+ * again. The same updates are applied twice on the simulated NINA file system: through LogStore, and
+ * by rewriting one file per key the way the state was kept before (erase, then write the file).
+ * Both are reported by flash bytes written, flash blocks erased, the wear of the most erased block and
+ * the WiFiStorage time per update.
+ *
+ * While the log store runs, writes are torn at random, as a reset in the middle of one would tear
+ * them. A fresh LogStore is begun after each tear, as after a reset, and every key is checked to hold
+ * the value last written, or the one being written when the tear came.
+ *
+ *   logstore_sim [years] [wake minutes] [tears per million writes] [seed]
+ */
+#include <Arduino.h>
+#include <WiFiNINA.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <map>
+#include <random>
+#include <vector>
+
+#include "sim.h"
+#include "../../src/logstore/logstore.h"
+
+#define REWRITE_FILE_PREFIX "/fs/state"
+#define FLASH_ENDURANCE 100000   // Erase cycles of the NINA's SPI NOR flash
+
+struct Update {
+  uint8_t key;
+  uint8_t length;
+  uint32_t every;      // Wakes
+  bool toggles;        // Deleted every other time instead of written
+};
+
+static const Update updates[] = {
+  {1, 12, 1, false},     // Counters, like the discovery state
+  {2, 8, 1, false},      // Failure counters
+  {3, 48, 2, false},     // A cache
+  {4, 32, 288, false},   // Once a day at 5 min wakes
+  {5, 20, 1000, true},
+};
+
+typedef std::vector<uint8_t> Value;   // Empty for no value
+
+struct Result {
+  unsigned long updates = 0;
+  unsigned long value_bytes = 0;
+  unsigned long flash_bytes = 0;
+  unsigned long block_erases = 0;
+  unsigned long wear_max = 0;
+  double storage_s = 0;
+};
+
+static std::mt19937 rng;
+
+static Value make_value(const Update &update, uint32_t wake) {
+  Value value(update.length);
+  for (size_t i = 0; i < value.size(); i++) value[i] = (uint8_t) (wake >> (8 * (i % 4))) ^ (uint8_t) (i * 37);
+  return value;
+}
+
+static void rewrite(const Update &update, const Value &value) {
+  char name[32];
+  snprintf(name, sizeof(name), REWRITE_FILE_PREFIX "%u", update.key);
+
+  WiFiStorageFile file = WiFiStorage.open(name);
+  if (file) file.erase();
+  if (!value.empty()) file.write(value.data(), value.size());
+  file.close();
+}
+
+static Value read_back(LogStore &log, uint8_t key) {
+  uint8_t buf[LOG_MAX_VALUE];
+  int len = log.get(key, buf, sizeof(buf));
+  return len < 0 ? Value() : Value(buf, buf + len);
+}
+
+int main(int argc, char **argv) {
+  double years = argc > 1 ? atof(argv[1]) : 5;
+  uint32_t wake_minutes = argc > 2 ? atoi(argv[2]) : 5;
+  uint32_t tears_per_million = argc > 3 ? atoi(argv[3]) : 100;
+  rng.seed(argc > 4 ? atoi(argv[4]) : 1);
+
+  uint32_t wakes = years * 365 * 24 * 60 / wake_minutes;
+  std::uniform_int_distribution<uint32_t> tear_chance(0, 999999);
+
+  // Whole-file rewrites first.
+  Result rewrites;
+  sim::Stats before = sim::stats;
+  uint64_t start_us = sim::now_us();
+
+  for (uint32_t wake = 0; wake < wakes; wake++) {
+    for (const Update &update : updates) {
+      if (wake % update.every != 0) continue;
+
+      bool remove = update.toggles && (wake / update.every) % 2 == 1;
+      Value value = remove ? Value() : make_value(update, wake);
+      rewrite(update, value);
+      rewrites.updates++;
+      rewrites.value_bytes += value.size();
+    }
+  }
+
+  rewrites.flash_bytes = sim::stats.storage_bytes_written - before.storage_bytes_written;
+  rewrites.block_erases = sim::stats.flash_block_erases - before.flash_block_erases;
+  rewrites.wear_max = sim::flash_block_wear_max(REWRITE_FILE_PREFIX);
+  rewrites.storage_s = (sim::now_us() - start_us) / 1e6;
+
+  // The log store, with torn writes and a reset after each one.
+  Result logged;
+  before = sim::stats;
+  start_us = sim::now_us();
+
+  std::map<uint8_t, Value> expected;
+  const Update *in_flight = nullptr;
+  Value in_flight_value;
+  bool torn = false;
+  unsigned long tears = 0;
+  unsigned long mismatches = 0;
+  uint32_t append_us_max = 0;
+  uint64_t append_us_total = 0;
+  unsigned long appends = 0;
+  uint32_t scan_bytes_max = 0;
+
+  sim::storage_fault_hook = [&](const char *filename, uint32_t &len) {
+    (void) filename;
+    if (torn || len == 0 || tear_chance(rng) >= tears_per_million) return true;
+
+    len = std::uniform_int_distribution<uint32_t>(0, len - 1)(rng);
+    torn = true;
+    return false;
+  };
+
+  LogStore *log = new LogStore();
+  log->begin();
+
+  for (uint32_t wake = 0; wake < wakes; wake++) {
+    for (const Update &update : updates) {
+      if (wake % update.every != 0) continue;
+
+      bool remove = update.toggles && (wake / update.every) % 2 == 1;
+      Value value = remove ? Value() : make_value(update, wake);
+      in_flight = &update;
+      in_flight_value = value;
+
+      bool ok = remove ? log->remove(update.key) : log->put(update.key, value.data(), value.size());
+      logged.updates++;
+      logged.value_bytes += value.size();
+
+      if (ok) {
+        expected[update.key] = value;
+        continue;
+      }
+
+      if (!torn) {
+        printf("update of key %u failed without a tear at wake %u\n", update.key, wake);
+        return 1;
+      }
+
+      // Reset: the RAM index is gone, begin a new store on what the flash holds.
+      tears++;
+      append_us_max = std::max(append_us_max, log->stats().append_us_max);
+      append_us_total += log->stats().append_us_total;
+      appends += log->stats().appends;
+      delete log;
+
+      torn = false;
+      log = new LogStore();
+      if (!log->begin()) {
+        printf("begin failed after a tear at wake %u\n", wake);
+        return 1;
+      }
+      scan_bytes_max = std::max(scan_bytes_max, log->stats().scan_bytes);
+
+      for (const Update &check : updates) {
+        Value got = read_back(*log, check.key);
+        bool may_be_new = &check == in_flight && got == in_flight_value;
+        if (got != expected[check.key] && !may_be_new) mismatches++;
+        expected[check.key] = got;
+      }
+    }
+  }
+
+  for (const Update &check : updates) {
+    if (read_back(*log, check.key) != expected[check.key]) mismatches++;
+  }
+
+  sim::storage_fault_hook = nullptr;
+
+  append_us_max = std::max(append_us_max, log->stats().append_us_max);
+  append_us_total += log->stats().append_us_total;
+  appends += log->stats().appends;
+
+  logged.flash_bytes = sim::stats.storage_bytes_written - before.storage_bytes_written;
+  logged.block_erases = sim::stats.flash_block_erases - before.flash_block_erases;
+  logged.wear_max = sim::flash_block_wear_max(LOG_FILE_PREFIX);
+  logged.storage_s = (sim::now_us() - start_us) / 1e6;
+
+  printf("%u wakes every %u min (%.1f years), %lu updates, %lu value bytes\n",
+         wakes, wake_minutes, years, logged.updates, logged.value_bytes);
+  printf("%-14s %12s %8s %12s %10s %10s %14s\n",
+         "", "flash bytes", "w.amp", "blk erases", "max wear", "ms/update", "endurance (y)");
+
+  const char *names[] = {"file rewrite", "log store"};
+  const Result *results[] = {&rewrites, &logged};
+  for (int i = 0; i < 2; i++) {
+    const Result &r = *results[i];
+    double endurance = r.wear_max ? years * FLASH_ENDURANCE / r.wear_max : 0;
+    printf("%-14s %12lu %8.2f %12lu %10lu %10.2f %14.0f\n", names[i], r.flash_bytes,
+           (double) r.flash_bytes / r.value_bytes, r.block_erases, r.wear_max,
+           r.storage_s * 1000 / r.updates, endurance);
+  }
+
+  printf("log store appends: avg %.2f ms, max %.2f ms; begin scan max %u B\n",
+         appends ? append_us_total / 1000.0 / appends : 0.0, append_us_max / 1000.0, scan_bytes_max);
+  printf("torn writes: %lu, values lost or corrupted: %lu\n", tears, mismatches);
+
+  delete log;
+  return mismatches ? 1 : 0;
+}
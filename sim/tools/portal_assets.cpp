@@ -0,0 +1,167 @@
+/*
+ * Build step for the AP portal pages.
+ *
+ * Minifies each page in src/wifi/portal/, compresses it with gzip and writes both forms, their
+ * lengths, content type and ETag into one header of flash arrays, so the firmware serves the pages
+ * without touching them at run time. The ETag is the CRC-32 of the minified page. The output only
+ * depends on the pages (gzip header time 0, fixed compression settings), so regenerating an
+ * unchanged set gives the same file.
+ *
+ *   portal_assets OUTPUT.h PAGE.html...
+ *
+ * `make -C sim` runs it when a page changes. The generated header is committed, so the Arduino
+ * build doesn't need it.
+ */
+#include <Arduino.h>
+
+#include <ctype.h>
+#include <stdio.h>
+#include <zlib.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../../src/crc/crc.h"
+
+// Collapses the whitespace of the source's indentation and line breaks. Whitespace between tags and
+// around CSS punctuation goes, other runs of whitespace become one space. The pages have no <pre>,
+// scripts or attribute values where whitespace matters.
+static std::string minify(const std::string &page) {
+  std::string out;
+  bool in_style = false;
+  size_t i = 0;
+
+  while (i < page.size()) {
+    if (!isspace((unsigned char) page[i])) {
+      if (page.compare(i, 6, "<style") == 0) in_style = true;
+      if (page.compare(i, 8, "</style>") == 0) in_style = false;
+
+      // "a; }" and "a;}" both end a CSS block, the last semicolon isn't needed.
+      if (in_style && page[i] == '}' && !out.empty() && out.back() == ';') out.pop_back();
+
+      out += page[i++];
+      continue;
+    }
+
+    while (i < page.size() && isspace((unsigned char) page[i])) i++;
+    if (out.empty() || i == page.size()) continue;
+
+    char before = out.back();
+    char after = page[i];
+    const char *tight = in_style ? "<>{};:," : "<>";
+
+    if (strchr(tight, before) || strchr(tight, after)) {
+      // Between tags, or around CSS punctuation. Text next to a tag keeps its space.
+      if ((before == '>' && after != '<') || (before != '>' && after == '<')) {
+        if (!in_style) out += ' ';
+      }
+      continue;
+    }
+
+    out += ' ';
+  }
+
+  return out;
+}
+
+static std::vector<uint8_t> gzip(const std::string &data) {
+  z_stream z = {};
+  // 15 bits of window plus 16 for a gzip header, which deflateInit2 writes with time 0.
+  if (deflateInit2(&z, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 9, Z_DEFAULT_STRATEGY) != Z_OK) return {};
+
+  std::vector<uint8_t> out(deflateBound(&z, data.size()) + 32);
+  z.next_in = (Bytef *) data.data();
+  z.avail_in = data.size();
+  z.next_out = out.data();
+  z.avail_out = out.size();
+
+  int result = deflate(&z, Z_FINISH);
+  out.resize(z.total_out);
+  deflateEnd(&z);
+
+  return result == Z_STREAM_END ? out : std::vector<uint8_t>();
+}
+
+static std::string base_name(const std::string &path) {
+  size_t slash = path.find_last_of('/');
+  std::string name = path.substr(slash == std::string::npos ? 0 : slash + 1);
+  return name.substr(0, name.find('.'));
+}
+
+static const char *content_type(const std::string &path) {
+  if (path.size() > 4 && path.compare(path.size() - 4, 4, ".css") == 0) return "text/css";
+  if (path.size() > 3 && path.compare(path.size() - 3, 3, ".js") == 0) return "text/javascript";
+  return "text/html; charset=utf-8";
+}
+
+static void write_bytes(std::ostream &out, const uint8_t *data, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    char hex[8];
+    snprintf(hex, sizeof(hex), "0x%02x,", data[i]);
+    out << (i % 16 == 0 ? "\n  " : " ") << hex;
+  }
+  out << "\n";
+}
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    fprintf(stderr, "usage: %s OUTPUT.h PAGE.html...\n", argv[0]);
+    return 2;
+  }
+
+  std::ostringstream out;
+  out << "/*\n"
+         " * AP portal pages, generated by sim/tools/portal_assets from src/wifi/portal/. Do not edit, run\n"
+         " * `make -C sim` after changing a page.\n"
+         " */\n"
+         "#ifndef PORTAL_PAGES_H\n"
+         "#define PORTAL_PAGES_H\n";
+
+  for (int i = 2; i < argc; i++) {
+    std::ifstream in(argv[i], std::ios::binary);
+    if (!in) {
+      fprintf(stderr, "%s: can't read %s\n", argv[0], argv[i]);
+      return 1;
+    }
+
+    std::stringstream source;
+    source << in.rdbuf();
+
+    std::string page = minify(source.str());
+    std::vector<uint8_t> compressed = gzip(page);
+    if (compressed.empty() || page.size() > 0xffff) {
+      fprintf(stderr, "%s: can't compress %s\n", argv[0], argv[i]);
+      return 1;
+    }
+
+    std::string name = base_name(argv[i]);
+    std::string upper;
+    for (char c : name) upper += isalnum((unsigned char) c) ? toupper(c) : '_';
+
+    char etag[16];
+    snprintf(etag, sizeof(etag), "0x%08lx", (unsigned long) crc32(0, page.data(), page.size()));
+
+    out << "\n// " << name << ".html: " << source.str().size() << " B, " << page.size() << " B minified, "
+        << compressed.size() << " B gzip\n";
+    out << "const uint8_t " << upper << "_PAGE_GZIP[] PROGMEM = {";
+    write_bytes(out, compressed.data(), compressed.size());
+    out << "};\n\n";
+    out << "const uint8_t " << upper << "_PAGE_IDENTITY[] PROGMEM = {";
+    write_bytes(out, (const uint8_t *) page.data(), page.size());
+    out << "};\n\n";
+    out << "const PortalAsset " << upper << "_PAGE = {\n"
+        << "  \"" << content_type(argv[i]) << "\",\n"
+        << "  " << upper << "_PAGE_GZIP, " << compressed.size() << ",\n"
+        << "  " << upper << "_PAGE_IDENTITY, " << page.size() << ",\n"
+        << "  " << etag << "\n"
+        << "};\n";
+  }
+
+  out << "\n#endif\n";
+
+  std::ofstream file(argv[1], std::ios::binary);
+  file << out.str();
+  return file ? 0 : 1;
+}
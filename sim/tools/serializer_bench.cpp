@@ -0,0 +1,257 @@
+/*
+ * Host benchmark of the state payload serializer.
+ *
+ * Serializes the same random samples through the allocation-free TelemetryWriter path and through
+ * the previous ArduinoJson + String path (kept below as the reference), checks that both produce the
+ * same bytes and reports time and heap allocations per payload. The packed state is timed as well,
+ * and checked to give the same JSON after a round trip through unpack_state(), as the state bridge
+ * does it.
+ *
+ * The reference runs on the simulation's ArduinoJson and String stand-ins, so its absolute timing
+ * is not that of the target. The allocation counts of the String helpers carry over; on the SAMD21
+ * every one of them is a malloc, where the host's short string optimization hides some.
+ *
+ *   serializer_bench [payloads]
+ */
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <TimeLib.h>
+#include <Timezone_Generic.h>
+
+#include <chrono>
+#include <new>
+
+#include "../../src/telemetry/telemetry.h"
+
+#define BATCH_MAX_SAMPLES 12
+
+static unsigned long allocations = 0;
+
+void *operator new(size_t size) {
+  allocations++;
+  void *p = malloc(size ? size : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+static TimeChangeRule usCDT = {"CDT", Second, Sun, Mar, 2, -300};
+static TimeChangeRule usCST = {"CST", First, Sun, Nov, 2, -360};
+static Timezone usCentral(usCDT, usCST);
+
+static time_t localTime(time_t utc, int *offset_minutes) {
+  TimeChangeRule *tcr;
+  time_t t_loc = usCentral.toLocal(utc, &tcr);
+
+  *offset_minutes = tcr->offset;
+  return t_loc;
+}
+
+// Reference: the state payload built with ArduinoJson and String, as it was before TelemetryWriter
+// (with illuminance as a float in percent, as it is now published).
+namespace reference {
+
+struct Sample {
+  time_t time;
+  float temperature;
+  float humidity;
+  float illuminance;
+  uint8_t battery;
+  float battery_voltage;
+  float battery_loaded_voltage;
+};
+
+static String format_digits(int digits) {
+  return (digits < 10) ? "0" + String(digits) : String(digits);
+}
+
+static String format_offset(int offset) {
+  if (offset == 0) {
+    return "Z";
+  }
+
+  String offset_suffix;
+  offset_suffix = (offset > 0) ? "+" : "-";
+
+  int offset_hours = abs(offset) / 60;
+  offset_suffix += format_digits(offset_hours);
+
+  offset_suffix += ":";
+
+  int offset_minutes = abs(offset) % 60;
+  offset_suffix += format_digits(offset_minutes);
+
+  return offset_suffix;
+}
+
+static String iso8601_date(time_t t) {
+  String t_str = "";
+
+  TimeChangeRule *tcr;
+  time_t t_loc = usCentral.toLocal(t, &tcr);
+
+  t_str += String(year(t_loc));
+  t_str += "-";
+  t_str += format_digits(month(t_loc));
+  t_str += "-";
+  t_str += format_digits(day(t_loc));
+  t_str += "T";
+  t_str += format_digits(hour(t_loc));
+  t_str += ":";
+  t_str += format_digits(minute(t_loc));
+  t_str += ":";
+  t_str += format_digits(second(t_loc));
+  t_str += format_offset(tcr->offset);
+
+  return t_str;
+}
+
+static void serialize(const Sample *samples, int sample_count, unsigned long interval_s, String &msg) {
+  StaticJsonDocument<JSON_OBJECT_SIZE(8) + JSON_ARRAY_SIZE(BATCH_MAX_SAMPLES) +
+                     BATCH_MAX_SAMPLES * JSON_OBJECT_SIZE(4) + (BATCH_MAX_SAMPLES + 1) * 32> doc;
+
+  const Sample &latest = samples[sample_count - 1];
+
+  doc["time"] = iso8601_date(latest.time);
+  doc["temperature"] = latest.temperature;
+  doc["humidity"] = latest.humidity;
+  doc["illuminance"] = latest.illuminance;
+  doc["battery"] = latest.battery;
+  doc["battery_voltage"] = latest.battery_voltage;
+  doc["battery_loaded_voltage"] = latest.battery_loaded_voltage;
+  doc["interval"] = interval_s;
+
+  if (sample_count > 1) {
+    JsonArray batch = doc.createNestedArray("samples");
+
+    for (int i = 0; i < sample_count; i++) {
+      JsonObject entry = batch.createNestedObject();
+
+      entry["time"] = iso8601_date(samples[i].time);
+      entry["temperature"] = samples[i].temperature;
+      entry["humidity"] = samples[i].humidity;
+      entry["illuminance"] = samples[i].illuminance;
+    }
+  }
+
+  serializeJson(doc, msg);
+}
+
+}
+
+// A reading in tenths as a float, the way the DHT library converts it.
+static float tenths_float(int16_t tenths) {
+  if (tenths == TELEMETRY_NAN) return NAN;
+  float f = tenths;
+  f *= 0.1;
+  return f;
+}
+
+static void random_samples(Sample *fixed, reference::Sample *ref, int count, time_t t) {
+  for (int i = 0; i < count; i++) {
+    fixed[i].time = t + i * 300;
+    fixed[i].temperature = random(100) == 0 ? TELEMETRY_NAN : random(-400, 800);
+    fixed[i].humidity = random(100) == 0 ? TELEMETRY_NAN : random(0, 1001);
+    fixed[i].illuminance = random(0, 1001);
+    fixed[i].battery = random(0, 101);
+    fixed[i].battery_mv = random(3000, 4300);
+    fixed[i].battery_loaded_mv = random(10) == 0 ? 0 : fixed[i].battery_mv - random(0, 100);
+
+    ref[i].time = fixed[i].time;
+    ref[i].temperature = tenths_float(fixed[i].temperature);
+    ref[i].humidity = tenths_float(fixed[i].humidity);
+    ref[i].illuminance = tenths_float(fixed[i].illuminance);
+    ref[i].battery = fixed[i].battery;
+    ref[i].battery_voltage = fixed[i].battery_mv / 1000.0f;
+    ref[i].battery_loaded_voltage = fixed[i].battery_loaded_mv ? fixed[i].battery_loaded_mv / 1000.0f : NAN;
+  }
+}
+
+int main(int argc, char **argv) {
+  int payloads = argc > 1 ? atoi(argv[1]) : 20000;
+  const int batch_sizes[] = {1, 6, BATCH_MAX_SAMPLES};
+  int mismatches = 0;
+
+  static char buf[128 + BATCH_MAX_SAMPLES * 112];
+  static char bridged[sizeof(buf)];
+  uint8_t packed[TELEMETRY_PACKED_SIZE(BATCH_MAX_SAMPLES)];
+  Sample unpacked[BATCH_MAX_SAMPLES];
+  Sample fixed[BATCH_MAX_SAMPLES];
+  reference::Sample ref[BATCH_MAX_SAMPLES];
+
+  printf("%-8s %-16s %12s %14s %10s\n", "samples", "path", "ns/payload", "allocs/payload", "bytes");
+
+  for (int batch : batch_sizes) {
+    randomSeed(batch);
+
+    double writer_ns = 0, ref_ns = 0, packed_ns = 0;
+    unsigned long writer_allocs = 0, ref_allocs = 0, packed_allocs = 0;
+    size_t bytes = 0, packed_bytes = 0;
+
+    for (int n = 0; n < payloads; n++) {
+      // Spread over a couple of years to cross DST changes.
+      random_samples(fixed, ref, batch, 1767225600 + (time_t) random(0, 2 * 365) * 86400 + random(0, 86400));
+
+      unsigned long a0 = allocations;
+      auto t0 = std::chrono::steady_clock::now();
+      unsigned long interval_s = random(60, 3601);
+
+      size_t len = serialize_state(buf, sizeof(buf), fixed, batch, interval_s, localTime);
+      auto t1 = std::chrono::steady_clock::now();
+      writer_allocs += allocations - a0;
+      writer_ns += std::chrono::duration<double, std::nano>(t1 - t0).count();
+
+      String msg;
+      a0 = allocations;
+      t0 = std::chrono::steady_clock::now();
+      reference::serialize(ref, batch, interval_s, msg);
+      t1 = std::chrono::steady_clock::now();
+      ref_allocs += allocations - a0;
+      ref_ns += std::chrono::duration<double, std::nano>(t1 - t0).count();
+
+      a0 = allocations;
+      t0 = std::chrono::steady_clock::now();
+      size_t packed_len = pack_state(packed, sizeof(packed), fixed, batch, interval_s);
+      t1 = std::chrono::steady_clock::now();
+      packed_allocs += allocations - a0;
+      packed_ns += std::chrono::duration<double, std::nano>(t1 - t0).count();
+
+      bytes += len;
+      packed_bytes += packed_len;
+
+      unsigned long unpacked_interval_s;
+      int count = unpack_state(packed, packed_len, unpacked, BATCH_MAX_SAMPLES, &unpacked_interval_s);
+      size_t bridged_len = count < 0 ? 0 : serialize_state(bridged, sizeof(bridged), unpacked, count,
+                                                           unpacked_interval_s, localTime);
+
+      if (bridged_len != len || memcmp(buf, bridged, len) != 0) {
+        if (mismatches++ < 5) {
+          fprintf(stderr, "round trip mismatch:\n  writer:  %s\n  bridged: %s\n", buf, bridged);
+        }
+      }
+
+      if (len != msg.length() || memcmp(buf, msg.c_str(), len) != 0) {
+        if (mismatches++ < 5) {
+          fprintf(stderr, "mismatch:\n  writer:    %s\n  reference: %s\n", buf, msg.c_str());
+        }
+      }
+    }
+
+    printf("%-8d %-16s %12.0f %14.1f %10zu\n", batch, "TelemetryWriter",
+           writer_ns / payloads, (double) writer_allocs / payloads, bytes / payloads);
+    printf("%-8d %-16s %12.0f %14.1f %10zu\n", batch, "ArduinoJson", ref_ns / payloads,
+           (double) ref_allocs / payloads, bytes / payloads);
+    printf("%-8d %-16s %12.0f %14.1f %10zu\n", batch, "pack_state", packed_ns / payloads,
+           (double) packed_allocs / payloads, packed_bytes / payloads);
+  }
+
+  if (mismatches) {
+    printf("%d payloads differ\n", mismatches);
+    return 1;
+  }
+
+  printf("all payloads byte-identical, packed payloads round trip\n");
+  return 0;
+}
@@ -0,0 +1,90 @@
+/*
+ * Reference bridge from the packed state payload to the JSON state payload.
+ *
+ * Reads "<topic> <hex payload>" lines, the format of `mosquitto_sub -F '%t %x'`, and writes
+ * "<state topic> <json>" lines for every packed state message. The JSON is produced by the
+ * firmware's own serialize_state(), with the local time of the TZ environment variable. Lines that
+ * are not a valid packed record are reported on stderr and skipped.
+ *
+ *   mosquitto_sub -h BROKER -t 'homeassistant/sensor/+/packed' -F '%t %x' |
+ *     TZ=America/Chicago state_bridge |
+ *     while read -r topic payload; do mosquitto_pub -h BROKER -t "$topic" -m "$payload"; done
+ */
+#include <Arduino.h>
+
+#include <string.h>
+#include <time.h>
+
+#include <iostream>
+#include <string>
+
+#include "../../src/telemetry/telemetry.h"
+
+#define BRIDGE_MAX_SAMPLES 255
+#define PACKED_SUFFIX "/packed"
+#define STATE_SUFFIX "/state"
+
+static time_t local_time(time_t utc, int *offset_minutes) {
+  struct tm tm;
+  localtime_r(&utc, &tm);
+
+  *offset_minutes = tm.tm_gmtoff / 60;
+  return utc + tm.tm_gmtoff;
+}
+
+static int hex_digit(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+/**
+ * Converts hex to bytes.
+ * @return The number of bytes, -1 if hex is not an even number of hex digits or too long.
+ */
+static int from_hex(const std::string &hex, uint8_t *out, size_t size) {
+  if (hex.size() % 2 || hex.size() / 2 > size) return -1;
+
+  for (size_t i = 0; i < hex.size(); i += 2) {
+    int hi = hex_digit(hex[i]), lo = hex_digit(hex[i + 1]);
+    if (hi < 0 || lo < 0) return -1;
+    out[i / 2] = hi << 4 | lo;
+  }
+
+  return hex.size() / 2;
+}
+
+int main() {
+  static uint8_t packed[TELEMETRY_PACKED_SIZE(BRIDGE_MAX_SAMPLES)];
+  static char json[128 + BRIDGE_MAX_SAMPLES * 112];
+  static Sample samples[BRIDGE_MAX_SAMPLES];
+
+  std::string line;
+  while (std::getline(std::cin, line)) {
+    size_t space = line.find(' ');
+    std::string topic = line.substr(0, space);
+    std::string hex = space == std::string::npos ? "" : line.substr(space + 1);
+
+    size_t suffix = sizeof(PACKED_SUFFIX) - 1;
+    if (topic.size() < suffix || topic.compare(topic.size() - suffix, suffix, PACKED_SUFFIX) != 0) continue;
+
+    unsigned long interval_s;
+    int len = from_hex(hex, packed, sizeof(packed));
+    int count = len < 0 ? -1 : unpack_state(packed, len, samples, BRIDGE_MAX_SAMPLES, &interval_s);
+
+    if (count < 0) {
+      fprintf(stderr, "%s: not a version %d packed state\n", topic.c_str(), TELEMETRY_PACKED_VERSION);
+      continue;
+    }
+
+    size_t json_len = serialize_state(json, sizeof(json), samples, count, interval_s, local_time);
+    if (json_len == 0) continue;
+
+    topic.replace(topic.size() - suffix, suffix, STATE_SUFFIX);
+    printf("%s %s\n", topic.c_str(), json);
+    fflush(stdout);
+  }
+
+  return 0;
+}
@@ -0,0 +1,122 @@
+/*
+ * Offline analyzer for wake cycle trace records (see src/trace/trace_format.h).
+ *
+ * Scans a captured serial stream for trace records, skipping any interleaved text, and prints
+ * per-phase duration percentiles over all cycles. Cycles that dropped phases are counted, since
+ * their phase totals are short.
+ *
+ *   usage: trace_analyze [capture.bin]     (reads stdin without an argument)
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "../../src/trace/trace_format.h"
+
+#define TRACE_PHASE_NAME(id, name) name,
+static const char *phase_names[] = {TRACE_PHASES(TRACE_PHASE_NAME)};
+#undef TRACE_PHASE_NAME
+
+static uint32_t get_u32(const uint8_t *p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static double percentile(std::vector<uint32_t> &v, double p) {
+  if (v.empty()) return 0;
+  size_t rank = (size_t) (p / 100.0 * (v.size() - 1) + 0.5);
+  return v[rank] / 1000.0;
+}
+
+static void print_row(const char *name, std::vector<uint32_t> &v, double total_ms) {
+  std::sort(v.begin(), v.end());
+
+  double sum = 0;
+  for (uint32_t d : v) sum += d / 1000.0;
+
+  printf("%-16s %6zu %10.1f %10.1f %10.1f %10.1f %10.1f %6.1f%%\n",
+         name, v.size(), sum / v.size(),
+         percentile(v, 50), percentile(v, 90), percentile(v, 99),
+         v.empty() ? 0.0 : v.back() / 1000.0,
+         total_ms > 0 ? 100.0 * sum / total_ms : 0.0);
+}
+
+int main(int argc, char **argv) {
+  FILE *in = stdin;
+  if (argc > 1) {
+    in = fopen(argv[1], "rb");
+    if (!in) {
+      perror(argv[1]);
+      return 1;
+    }
+  }
+
+  std::vector<uint8_t> data;
+  uint8_t chunk[4096];
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof(chunk), in)) > 0) data.insert(data.end(), chunk, chunk + n);
+
+  std::vector<uint32_t> phases[TRACE_PHASE_COUNT];
+  std::vector<uint32_t> cycles;
+  size_t bad = 0;
+  size_t overflowed = 0;
+
+  size_t i = 0;
+  while (i + TRACE_HEADER_SIZE + 1 <= data.size()) {
+    if (data[i] != TRACE_MAGIC_0 || data[i + 1] != TRACE_MAGIC_1 || data[i + 2] != TRACE_VERSION) {
+      i++;
+      continue;
+    }
+
+    size_t count = data[i + 3];
+    size_t len = TRACE_HEADER_SIZE + count * TRACE_EVENT_SIZE + 1;
+    if (i + len > data.size()) break;
+
+    uint8_t sum = 0;
+    for (size_t j = i + 2; j < i + len - 1; j++) sum += data[j];
+    if (sum != data[i + len - 1]) {
+      bad++;
+      i++;
+      continue;
+    }
+
+    // A phase entered more than once in a cycle counts once, with its total time.
+    uint32_t per_cycle[TRACE_PHASE_COUNT] = {};
+    bool seen[TRACE_PHASE_COUNT] = {};
+    for (size_t e = 0; e < count; e++) {
+      const uint8_t *ev = &data[i + TRACE_HEADER_SIZE + e * TRACE_EVENT_SIZE];
+      if (ev[0] >= TRACE_PHASE_COUNT) continue;
+      per_cycle[ev[0]] += get_u32(&ev[5]);
+      seen[ev[0]] = true;
+    }
+
+    for (int p = 0; p < TRACE_PHASE_COUNT; p++) {
+      if (seen[p]) phases[p].push_back(per_cycle[p]);
+    }
+    if (data[i + 4] > 0) overflowed++;
+    cycles.push_back(get_u32(&data[i + 9]));
+
+    i += len;
+  }
+
+  if (cycles.empty()) {
+    fprintf(stderr, "no trace records found%s\n", bad ? " (all failed checksum)" : "");
+    return 1;
+  }
+
+  double total_ms = 0;
+  for (uint32_t c : cycles) total_ms += c / 1000.0;
+
+  printf("%zu cycles, %zu corrupt records skipped, %zu with phases dropped\n\n", cycles.size(), bad, overflowed);
+  printf("%-16s %6s %10s %10s %10s %10s %10s %7s\n",
+         "phase", "n", "mean ms", "p50 ms", "p90 ms", "p99 ms", "max ms", "share");
+
+  for (int p = 0; p < TRACE_PHASE_COUNT; p++) {
+    if (!phases[p].empty()) print_row(phase_names[p], phases[p], total_ms);
+  }
+  print_row("cycle", cycles, total_ms);
+
+  return 0;
+}
@@ -0,0 +1,95 @@
+/*
+ * ADC burst acquisition
+ */
+#include "adc.h"
+#include <ArduinoLowPower.h>
+#include "wiring_private.h"
+
+volatile bool AdcBurst::done = false;
+
+void AdcBurst::transfer_done(Adafruit_ZeroDMA *dma) {
+  (void) dma;
+  done = true;
+}
+
+static void adc_sync() {
+  while (ADC->STATUS.bit.SYNCBUSY);
+}
+
+/**
+ * Allocates the DMA channel that moves the ADC results. Without it, read() falls back to analogRead().
+ * @return Whether a channel was available.
+ */
+bool AdcBurst::begin() {
+  if (ready) return true;
+  if (dma.allocate() != DMA_STATUS_OK) return false;
+
+  dma.setTrigger(ADC_DMAC_ID_RESRDY);
+  dma.setAction(DMA_TRIGGER_ACTON_BEAT);
+  dma.addDescriptor((void *) &ADC->RESULT.reg, (void *) results, ADC_BURST_RESULTS + 1,
+                    DMA_BEAT_SIZE_HWORD, false, true);
+  dma.setCallback(transfer_done);
+
+  ready = true;
+  return true;
+}
+
+/**
+ * Runs the ADC free with hardware accumulation until the DMA has collected every result, idling
+ * meanwhile. The core's ADC configuration is restored afterwards.
+ * @return Whether the results are complete.
+ */
+bool AdcBurst::acquire(uint8_t pin) {
+  uint16_t ctrlb = ADC->CTRLB.reg;
+  uint8_t avgctrl = ADC->AVGCTRL.reg;
+  uint8_t sampctrl = ADC->SAMPCTRL.reg;
+
+  pinPeripheral(pin, PIO_ANALOG);
+
+  ADC->INPUTCTRL.bit.MUXPOS = g_APinDescription[pin].ulADCChannelNumber;
+  adc_sync();
+  ADC->AVGCTRL.reg = ADC_AVGCTRL_SAMPLENUM(ADC_BURST_ACCUMULATE_LOG2) | ADC_AVGCTRL_ADJRES(0);
+  ADC->SAMPCTRL.reg = ADC_SAMPCTRL_SAMPLEN(ADC_BURST_SAMPLEN);
+  ADC->CTRLB.reg = ADC_CTRLB_PRESCALER_DIV32 | ADC_CTRLB_RESSEL_16BIT | ADC_CTRLB_FREERUN;
+  adc_sync();
+
+  done = false;
+  bool started = dma.startJob() == DMA_STATUS_OK;
+
+  if (started) {
+    ADC->CTRLA.bit.ENABLE = 1;
+    adc_sync();
+    ADC->SWTRIG.bit.START = 1;
+    adc_sync();
+
+    unsigned long start_ms = millis();
+    while (!done && millis() - start_ms < ADC_BURST_TIMEOUT_MS) LowPower.idle();
+    if (!done) dma.abort();
+  }
+
+  ADC->CTRLA.bit.ENABLE = 0;
+  adc_sync();
+  ADC->SWTRIG.bit.FLUSH = 1;
+  adc_sync();
+  ADC->CTRLB.reg = ctrlb;
+  ADC->AVGCTRL.reg = avgctrl;
+  ADC->SAMPCTRL.reg = sampctrl;
+  adc_sync();
+
+  return started && done;
+}
+
+/**
+ * Reads an analog input as the mean of ADC_BURST_RESULTS hardware-accumulated results.
+ * @return The reading scaled to 0..ADC_BURST_FULL_SCALE.
+ */
+uint16_t AdcBurst::read(uint8_t pin) {
+  if (!ready || !acquire(pin)) {
+    // 10-bit analogRead(), scaled to the same full scale.
+    return (uint32_t) analogRead(pin) * ADC_BURST_FULL_SCALE / 1023;
+  }
+
+  uint32_t sum = 0;
+  for (uint8_t i = 1; i <= ADC_BURST_RESULTS; i++) sum += results[i];
+  return (sum + ADC_BURST_RESULTS / 2) / ADC_BURST_RESULTS;
+}
@@ -0,0 +1,41 @@
+/*
+ * ADC burst acquisition
+ *
+ * Reads an analog input as the mean of many conversions without keeping the CPU busy. The SAMD21 ADC
+ * accumulates ADC_BURST_ACCUMULATE conversions per result in hardware and runs free, a DMA channel
+ * moves every result to RAM, and the CPU idles until the transfer is done. One read takes about a
+ * millisecond of mostly IDLE time where ADC_BURST_RESULTS analogRead() calls would keep the CPU
+ * running for ADC_BURST_RESULTS x 425us at the core's default ADC settings.
+ *
+ * The core's ADC settings are restored after every read, so analogRead() keeps working alongside.
+ */
+#ifndef ADC_H
+#define ADC_H
+
+#include "Arduino.h"
+#include <Adafruit_ZeroDMA.h>
+
+#define ADC_BURST_RESULTS 8            // Results averaged per read
+#define ADC_BURST_ACCUMULATE_LOG2 4    // 16 conversions accumulated per result, the most without shifting
+#define ADC_BURST_SAMPLEN 7            // Sampling time of (7 + 1) / 2 ADC clocks, for the photoresistor's divider
+#define ADC_BURST_TIMEOUT_MS 10        // Give up on the DMA and fall back to analogRead() after this long
+#define ADC_BURST_FULL_SCALE (4095u << ADC_BURST_ACCUMULATE_LOG2)  // 65520
+
+class AdcBurst {
+  public:
+    bool begin();
+    uint16_t read(uint8_t pin);
+
+  private:
+    Adafruit_ZeroDMA dma;
+    bool ready = false;
+    // The first result after enabling the ADC is discarded, hence one more.
+    volatile uint16_t results[ADC_BURST_RESULTS + 1];
+
+    static volatile bool done;
+    static void transfer_done(Adafruit_ZeroDMA *dma);
+
+    bool acquire(uint8_t pin);
+};
+
+#endif
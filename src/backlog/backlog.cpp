@@ -0,0 +1,166 @@
+/*
+ * Sample backlog
+ */
+#include "backlog.h"
+
+SampleBacklog::SampleBacklog(LogStore &log) : log(log) {}
+
+/**
+ * Begins the log store and finds the chunks already in it. Chunks that don't unpack are removed.
+ * @return false if the log store couldn't be begun.
+ */
+bool SampleBacklog::begin() {
+  if (ready) return true;
+  if (!log.begin()) return false;
+
+  uint8_t buf[LOG_MAX_VALUE];
+  Sample samples[BACKLOG_CHUNK_SAMPLES];
+  unsigned long interval_s;
+
+  for (uint8_t c = 0; c < BACKLOG_CHUNKS; c++) {
+    int len = log.get(BACKLOG_FIRST_KEY + c, buf, sizeof(buf));
+    if (len < 0) continue;
+
+    int count = unpack_state(buf, len, samples, BACKLOG_CHUNK_SAMPLES, &interval_s);
+    if (count < 1) {
+      log.remove(BACKLOG_FIRST_KEY + c);
+      continue;
+    }
+
+    chunk_time[c] = max(samples[0].time, (time_t) 1);
+    chunk_count[c] = count;
+  }
+
+  ready = true;
+  return true;
+}
+
+/**
+ * @return The chunk whose first sample is the oldest after the given time, -1 if there is none.
+ */
+int8_t SampleBacklog::next_chunk(time_t after) {
+  int8_t next = -1;
+
+  for (uint8_t c = 0; c < BACKLOG_CHUNKS; c++) {
+    if (chunk_time[c] == 0 || chunk_time[c] <= after) continue;
+    if (next < 0 || chunk_time[c] < chunk_time[next]) next = c;
+  }
+
+  return next;
+}
+
+/**
+ * Writes up to BACKLOG_CHUNK_SAMPLES samples, oldest first, to flash as one chunk. With every chunk in
+ * use the oldest one is replaced.
+ * @return false if the chunk couldn't be written, the samples are still the caller's then.
+ */
+bool SampleBacklog::spill(const Sample *samples, uint8_t count, unsigned long interval_s) {
+  if (count < 1 || count > BACKLOG_CHUNK_SAMPLES || !begin()) return false;
+
+  int8_t slot = -1;
+  for (uint8_t c = 0; c < BACKLOG_CHUNKS && slot < 0; c++) {
+    if (chunk_time[c] == 0) slot = c;
+  }
+
+  bool full = slot < 0;
+  if (full) slot = next_chunk(0);
+
+  uint8_t buf[LOG_MAX_VALUE];
+  size_t len = pack_state(buf, sizeof(buf), samples, count, interval_s);
+  if (len == 0 || !log.put(BACKLOG_FIRST_KEY + slot, buf, len)) return false;
+
+  if (full) metrics.dropped += chunk_count[slot];
+  chunk_time[slot] = max(samples[0].time, (time_t) 1);
+  chunk_count[slot] = count;
+  metrics.spilled += count;
+  return true;
+}
+
+/**
+ * Reads the oldest chunks, as many whole ones as fit max_count samples, oldest sample first. A chunk
+ * that can't be read is dropped.
+ * @param chunks Set to the number of chunks read, for release().
+ * @param interval_s Set to the sample interval stored with the newest chunk read.
+ * @return The number of samples read.
+ */
+int SampleBacklog::oldest(Sample *samples, int max_count, uint8_t *chunks, unsigned long *interval_s) {
+  *chunks = 0;
+  if (!begin()) return 0;
+
+  uint8_t buf[LOG_MAX_VALUE];
+  int count = 0;
+  time_t after = 0;
+
+  for (int8_t c = next_chunk(after); c >= 0; c = next_chunk(after)) {
+    if (count + chunk_count[c] > max_count) break;
+
+    int len = log.get(BACKLOG_FIRST_KEY + c, buf, sizeof(buf));
+    int n = len < 0 ? -1 : unpack_state(buf, len, &samples[count], max_count - count, interval_s);
+
+    if (n != chunk_count[c]) {
+      if (count > 0) break; // Dropped once the chunks before it are released
+      log.remove(BACKLOG_FIRST_KEY + c);
+      metrics.dropped += chunk_count[c];
+      chunk_time[c] = 0;
+      chunk_count[c] = 0;
+      continue;
+    }
+
+    after = chunk_time[c];
+    count += n;
+    (*chunks)++;
+  }
+
+  return count;
+}
+
+/**
+ * Removes the oldest chunks once oldest() read them and they were published.
+ * @param publish_us Time the publish took, for the backfill rate.
+ * @return false if a chunk couldn't be removed, it is published again then.
+ */
+bool SampleBacklog::release(uint8_t chunks, uint32_t publish_us) {
+  metrics.backfill_publishes++;
+  metrics.backfill_us += publish_us;
+
+  for (uint8_t i = 0; i < chunks; i++) {
+    int8_t c = next_chunk(0);
+    if (c < 0) break;
+    if (!log.remove(BACKLOG_FIRST_KEY + c)) return false;
+
+    metrics.backfilled += chunk_count[c];
+    chunk_time[c] = 0;
+    chunk_count[c] = 0;
+  }
+
+  return true;
+}
+
+/**
+ * @return The number of samples waiting in flash.
+ */
+uint16_t SampleBacklog::depth() {
+  uint16_t samples = 0;
+  for (uint8_t c = 0; c < BACKLOG_CHUNKS; c++) samples += chunk_count[c];
+  return samples;
+}
+
+/**
+ * Writes the backlog metrics as JSON: the samples waiting in flash, the counters since the last reset
+ * and the backfill rate in samples per second of publishing.
+ * @return The payload length, 0 if it didn't fit the buffer.
+ */
+size_t SampleBacklog::serialize_metrics(char *buf, size_t size) {
+  TelemetryWriter json(buf, size);
+
+  json.begin_object();
+  json.add_int("depth", depth());
+  json.add_int("spilled", metrics.spilled);
+  json.add_int("dropped", metrics.dropped);
+  json.add_int("backfilled", metrics.backfilled);
+  json.add_int("backfill_publishes", metrics.backfill_publishes);
+  json.add_fixed("backfill_rate", (int32_t) (backfill_rate() * 10 + 0.5f), 1);
+  json.end_object();
+
+  return json.overflowed() ? 0 : json.length();
+}
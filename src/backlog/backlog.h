@@ -0,0 +1,58 @@
+/*
+ * Sample backlog
+ *
+ * Samples that couldn't be published wait in the RAM batch buffer, which survives deep sleep but not a
+ * reset and only holds BATCH_MAX_SAMPLES. When a transmission fails with the buffer filling up, the
+ * oldest samples are spilled to flash in chunks and published later, oldest first, once the broker can
+ * be reached again.
+ *
+ * A chunk is a packed state record (see TELEMETRY_PACKED_VERSION) of up to BACKLOG_CHUNK_SAMPLES
+ * samples, each with its original epoch time, kept in the log store under one of BACKLOG_CHUNKS keys.
+ * The chunks are a bounded ring: with every key in use, the oldest chunk is dropped for the new one.
+ * begin() finds the chunks again after a reset and orders them by their first sample's time.
+ */
+#ifndef BACKLOG_H
+#define BACKLOG_H
+
+#include "Arduino.h"
+#include "../telemetry/telemetry.h"
+#include "../logstore/logstore.h"
+
+#define BACKLOG_FIRST_KEY 4         // Log store keys BACKLOG_FIRST_KEY .. + BACKLOG_CHUNKS - 1
+#define BACKLOG_CHUNKS 12
+#define BACKLOG_CHUNK_SAMPLES 5     // TELEMETRY_PACKED_SIZE(5) = 59 B fits LOG_MAX_VALUE
+
+struct BacklogStats {
+  uint32_t spilled;             // Samples written to flash
+  uint32_t dropped;             // Samples lost to the oldest chunk being dropped with the ring full
+  uint32_t backfilled;          // Samples published from flash
+  uint32_t backfill_publishes;
+  uint32_t backfill_us;         // Time spent publishing them, for the backfill rate
+};
+
+class SampleBacklog {
+  public:
+    explicit SampleBacklog(LogStore &log);
+
+    bool begin();
+    bool spill(const Sample *samples, uint8_t count, unsigned long interval_s);
+    int oldest(Sample *samples, int max_count, uint8_t *chunks, unsigned long *interval_s);
+    bool release(uint8_t chunks, uint32_t publish_us);
+
+    uint16_t depth();
+    const BacklogStats &stats() { return metrics; }
+    // Samples backfilled per second of publishing, 0 before the first backfill.
+    float backfill_rate() { return metrics.backfill_us ? metrics.backfilled * 1e6f / metrics.backfill_us : 0; }
+    size_t serialize_metrics(char *buf, size_t size);
+
+  private:
+    LogStore &log;
+    time_t chunk_time[BACKLOG_CHUNKS] = {};    // First sample's time, 0 for a free key
+    uint8_t chunk_count[BACKLOG_CHUNKS] = {};
+    bool ready = false;
+    BacklogStats metrics = {};
+
+    int8_t next_chunk(time_t after);
+};
+
+#endif
@@ -0,0 +1,61 @@
+/*
+ * Battery monitor
+ */
+#include "battery.h"
+
+void BatteryMonitor::begin() {
+  adc.begin();
+}
+
+uint16_t BatteryMonitor::measure() {
+  return ((uint32_t) adc.read(pin) * mv_per_count_q16 + 32768) >> 16;
+}
+
+/**
+ * Measures the battery with only the MCU drawing current. Call it with the NINA held in reset.
+ * @return The voltage in mV.
+ */
+uint16_t BatteryMonitor::measure_rest() {
+  rest = measure();
+  return rest;
+}
+
+/**
+ * Measures the battery with WiFi up and updates the internal resistance from the drop since the
+ * last rest measurement.
+ * @return The voltage in mV.
+ */
+uint16_t BatteryMonitor::measure_loaded() {
+  loaded = measure();
+
+  if (rest > 0 && rest >= loaded + BATTERY_MIN_DROP_MV) {
+    uint32_t estimate = (uint32_t) (rest - loaded) * 1000 / (BATTERY_LOAD_MA - BATTERY_REST_MA);
+    if (estimate > UINT16_MAX) estimate = UINT16_MAX;
+
+    if (resistance == 0) resistance = estimate;
+    else resistance += ((int32_t) estimate - resistance) / BATTERY_RESISTANCE_WEIGHT;
+  }
+
+  return loaded;
+}
+
+/**
+ * The state of charge from the open circuit voltage, the rest voltage plus the drop the rest current
+ * causes across the internal resistance.
+ * @return The level in percent, 0 before the first rest measurement.
+ */
+uint8_t BatteryMonitor::level() {
+  if (rest == 0) return 0;
+
+  uint32_t ocv = rest + (uint32_t) BATTERY_REST_MA * resistance / 1000;
+
+  if (ocv <= ocv_mv[0]) return 0;
+  if (ocv >= ocv_mv[ocv_count - 1]) return (ocv_count - 1) * BATTERY_LEVEL_STEP;
+
+  uint8_t i = 1;
+  while (ocv > ocv_mv[i]) i++;
+
+  // Linear between the two table entries around ocv.
+  uint32_t span_mv = ocv_mv[i] - ocv_mv[i - 1];
+  return (i - 1) * BATTERY_LEVEL_STEP + ((ocv - ocv_mv[i - 1]) * BATTERY_LEVEL_STEP + span_mv / 2) / span_mv;
+}
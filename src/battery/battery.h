@@ -0,0 +1,52 @@
+/*
+ * Battery monitor
+ *
+ * Measures the LiPo at two known loads: at rest, before the NINA is released from reset, and under
+ * the radio's load once WiFi is up. The drop between the two gives the cell's internal resistance,
+ * which corrects the rest voltage to the open circuit voltage that the state of charge follows. The
+ * level is interpolated from a table of open circuit voltages instead of computed from a curve.
+ */
+#ifndef BATTERY_H
+#define BATTERY_H
+
+#include "Arduino.h"
+#include "../adc/adc.h"
+
+#define BATTERY_LEVEL_STEP 10          // Percent between entries of the open circuit voltage table
+#define BATTERY_REST_MA 12             // Board current at rest, the SAMD21 running with the NINA in reset
+#define BATTERY_LOAD_MA 100            // Board current with WiFi up, NINA average incl. TX bursts
+#define BATTERY_RESISTANCE_WEIGHT 4    // New resistance estimates count 1 / BATTERY_RESISTANCE_WEIGHT
+#define BATTERY_MIN_DROP_MV 3          // Smaller drops are ADC noise, not a resistance estimate
+
+class BatteryMonitor {
+  public:
+    // ocv_mv: open circuit voltage at 0%, BATTERY_LEVEL_STEP%, ... 100%, ascending.
+    template <size_t N> BatteryMonitor(AdcBurst &adc, uint8_t pin, uint16_t ref_mv, float divider_ratio,
+                                       const uint16_t (&ocv_mv)[N]) :
+        adc(adc), pin(pin), ocv_mv(ocv_mv), ocv_count(N),
+        mv_per_count_q16((uint32_t) (ref_mv * divider_ratio * 65536 / ADC_BURST_FULL_SCALE + 0.5)) {}
+
+    void begin();
+    uint16_t measure_rest();
+    uint16_t measure_loaded();
+
+    uint16_t rest_mv() { return rest; }
+    uint16_t loaded_mv() { return loaded; }
+    uint16_t resistance_mohm() { return resistance; }
+    uint8_t level();
+
+  private:
+    AdcBurst &adc;
+    uint8_t pin;
+    const uint16_t *ocv_mv;
+    uint8_t ocv_count;
+    uint32_t mv_per_count_q16;   // Battery mV per ADC burst count, through the divider
+
+    uint16_t rest = 0;           // 0 until measured
+    uint16_t loaded = 0;
+    uint16_t resistance = 0;     // Internal resistance in mOhm, 0 until estimated
+
+    uint16_t measure();
+};
+
+#endif
@@ -0,0 +1,88 @@
+/*
+ * Connect policy
+ */
+#include "connect.h"
+
+ConnectPolicy::ConnectPolicy(LogStore &log, unsigned long base_s, unsigned long max_s, unsigned long budget_mas,
+                             unsigned int radio_ma)
+    : log(log), base_s(base_s), max_s(max_s), budget_ms(budget_mas * 1000 / radio_ma) {}
+
+/**
+ * Begins the log store and reads the persisted state. Until then the policy starts from no failures.
+ * @return false if the log store couldn't be begun.
+ */
+bool ConnectPolicy::begin() {
+  if (ready) return true;
+  if (!log.begin()) return false;
+
+  if (log.get(CONNECT_LOG_KEY, &connect_state, sizeof(connect_state)) != sizeof(connect_state)) {
+    memset(&connect_state, 0, sizeof(connect_state));
+  }
+
+  ready = true;
+  return true;
+}
+
+/**
+ * @return true if this wake may connect: no failed wake is waiting out its backoff. A retry time
+ * further out than the max wait was set before the clock was, and is ignored.
+ */
+bool ConnectPolicy::due(time_t t) {
+  if (connect_state.retry_at == 0) return true;
+
+  int32_t left_s = (int32_t) (connect_state.retry_at - (uint32_t) t);
+  return left_s <= 0 || left_s > (int32_t) max_s;
+}
+
+/**
+ * Counts a wake that couldn't connect and sets the time of the next attempt: the base wait doubled
+ * for every failed wake before it, capped at the max wait, less a random part of up to half of it.
+ */
+void ConnectPolicy::failed(ConnectStep step, time_t t) {
+  begin();
+
+  if (connect_state.failures < UINT16_MAX) connect_state.failures++;
+  if (step == CONNECT_WIFI && connect_state.wifi_failures < UINT16_MAX) connect_state.wifi_failures++;
+  connect_state.total_failures++;
+
+  uint8_t doublings = min(connect_state.failures - 1, CONNECT_MAX_DOUBLINGS);
+  unsigned long wait = min(base_s << doublings, max_s);
+
+  last_wait_s = wait - random(wait / 2 + 1);
+  connect_state.retry_at = (uint32_t) t + last_wait_s;
+  save();
+}
+
+/**
+ * Ends the backoff after a wake that connected. Only writes to flash if there was one.
+ */
+void ConnectPolicy::connected() {
+  last_wait_s = 0;
+  begin();
+
+  if (connect_state.failures == 0 && connect_state.retry_at == 0) return;
+
+  connect_state.failures = 0;
+  connect_state.wifi_failures = 0;
+  connect_state.retry_at = 0;
+  save();
+}
+
+/**
+ * Starts the connect budget of a wake, before bringing up the radio.
+ */
+void ConnectPolicy::begin_wake() {
+  wake_started_ms = millis();
+}
+
+/**
+ * @return The radio time left in this wake's connect budget.
+ */
+unsigned long ConnectPolicy::budget_left_ms() {
+  unsigned long elapsed_ms = millis() - wake_started_ms;
+  return elapsed_ms < budget_ms ? budget_ms - elapsed_ms : 0;
+}
+
+bool ConnectPolicy::save() {
+  return ready && log.put(CONNECT_LOG_KEY, &connect_state, sizeof(connect_state));
+}
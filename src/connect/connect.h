@@ -0,0 +1,65 @@
+/*
+ * Connect policy
+ *
+ * A wake that can't join the network or reach the broker leaves the radio off on the wakes after it
+ * for a wait that doubles with every failed wake, from the base wait up to the max. Each wait is drawn
+ * at random from the upper half of that, so devices that lost the broker together don't all come back
+ * on the same wake. Samples are still taken and buffered in the meantime.
+ *
+ * The failure counts and the end of the wait are kept in the log store, so a reset doesn't start the
+ * backoff over. Independently of the backoff, a wake's connect attempts are capped by a charge budget,
+ * turned into radio time at the NINA's current with WiFi up.
+ */
+#ifndef CONNECT_H
+#define CONNECT_H
+
+#include "Arduino.h"
+#include "../logstore/logstore.h"
+
+#define CONNECT_LOG_KEY 2
+#define CONNECT_MAX_DOUBLINGS 16    // Bounds the shift, the max wait bounds the wait long before
+
+enum ConnectStep : uint8_t {
+  CONNECT_WIFI,   // The network couldn't be joined
+  CONNECT_MQTT    // The network was joined, the broker couldn't be reached
+};
+
+// Persisted across resets, rewritten on failed wakes and on the first connect after them.
+struct ConnectState {
+  uint16_t failures;        // Failed wakes since the last connect
+  uint16_t wifi_failures;   // Of them, failed joining the network
+  uint32_t total_failures;  // Failed wakes since the state was first written
+  uint32_t retry_at;        // Epoch time before which wakes don't connect, 0 for none
+};
+
+class ConnectPolicy {
+  public:
+    ConnectPolicy(LogStore &log, unsigned long base_s, unsigned long max_s, unsigned long budget_mas,
+                  unsigned int radio_ma);
+
+    bool begin();
+    bool due(time_t t);
+    void failed(ConnectStep step, time_t t);
+    void connected();
+
+    void begin_wake();
+    unsigned long budget_left_ms();
+
+    const ConnectState &state() { return connect_state; }
+    // The wait before the last failed wake's retry, 0 if the last wake connected.
+    unsigned long wait_s() { return last_wait_s; }
+
+  private:
+    LogStore &log;
+    unsigned long base_s;
+    unsigned long max_s;
+    unsigned long budget_ms;
+    unsigned long wake_started_ms = 0;
+    unsigned long last_wait_s = 0;
+    ConnectState connect_state = {};
+    bool ready = false;
+
+    bool save();
+};
+
+#endif
@@ -0,0 +1,19 @@
+/*
+ * CRC-32
+ */
+#include "crc.h"
+
+/**
+ * Adds data to a CRC-32. Start with 0, continue with the previous result.
+ */
+uint32_t crc32(uint32_t crc, const void *data, size_t len) {
+  const uint8_t *p = (const uint8_t *) data;
+  crc = ~crc;
+
+  for (size_t i = 0; i < len; i++) {
+    crc ^= p[i];
+    for (uint8_t bit = 0; bit < 8; bit++) crc = (crc >> 1) ^ (0xEDB88320UL & -(crc & 1));
+  }
+
+  return ~crc;
+}
@@ -0,0 +1,14 @@
+/*
+ * CRC-32
+ *
+ * IEEE 802.3 CRC-32 (reflected, polynomial 0xEDB88320), bit by bit. Small and slow, which suits the
+ * few hundred bytes of flash records it checks.
+ */
+#ifndef CRC_H
+#define CRC_H
+
+#include "Arduino.h"
+
+uint32_t crc32(uint32_t crc, const void *data, size_t len);
+
+#endif
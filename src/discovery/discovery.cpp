@@ -0,0 +1,71 @@
+/*
+ * Home Assistant MQTT discovery
+ */
+#include "discovery.h"
+
+/**
+ * Writes the config topic of a sensor, e.g. homeassistant/sensor/logger_<client_id>_t/config.
+ * @return The topic length, 0 if it didn't fit the buffer.
+ */
+size_t config_topic(char *buf, size_t size, const char *client_id, const SensorDescriptor &sensor) {
+  int n = snprintf(buf, size, DISCOVERY_PREFIX "%s_%s/config", client_id, sensor.suffix);
+  return (n > 0 && (size_t) n < size) ? n : 0;
+}
+
+/**
+ * Writes the discovery payload of a sensor. Topics are abbreviated with the "~" base topic and the
+ * keys use Home Assistant's short names.
+ * @return The payload length, 0 if it didn't fit the buffer.
+ */
+size_t serialize_discovery(char *buf, size_t size, const SensorDescriptor &sensor, const DeviceInfo &device) {
+  char text[64];
+  TelemetryWriter json(buf, size);
+
+  json.begin_object();
+
+  snprintf(text, sizeof(text), DISCOVERY_PREFIX "%s", device.client_id);
+  json.add_string("~", text);
+  json.add_string("dev_cla", sensor.device_class); //device_class
+
+  snprintf(text, sizeof(text), "%s%s", device.name, sensor.name);
+  json.add_string("name", text);
+  json.add_string("stat_t", "~/state"); //state_topic
+  json.add_string("unit_of_meas", sensor.unit); //unit_of_measurement
+
+  snprintf(text, sizeof(text), "{{value_json.%s}}", sensor.value_key);
+  json.add_string("val_tpl", text); //value_template
+  json.add_string("avty_t", "~/availability"); //availability_topic
+
+  snprintf(text, sizeof(text), "%s_%s", device.client_id, sensor.suffix);
+  json.add_string("uniq_id", text); //unique_id
+
+  json.begin_object("dev"); //device
+  snprintf(text, sizeof(text), "%s %s", device.name, device.model);
+  json.add_string("name", text);
+  json.add_string("mf", device.manufacturer); //manufacturer
+  json.add_string("mdl", device.model); //model
+  json.add_string("sw", device.sw_version); //sw_version
+  json.begin_array("ids"); //identifiers
+  json.add_string(NULL, device.client_id);
+  json.end_array();
+  json.end_object();
+
+  json.end_object();
+
+  return json.overflowed() ? 0 : json.length();
+}
+
+/**
+ * Reads the discovery state from the log store.
+ * @return false if there is none, state is zeroed then.
+ */
+bool read_discovery_state(LogStore &log, DiscoveryState &state) {
+  if (log.get(DISCOVERY_LOG_KEY, &state, sizeof(state)) == sizeof(state)) return true;
+
+  memset(&state, 0, sizeof(state));
+  return false;
+}
+
+bool write_discovery_state(LogStore &log, const DiscoveryState &state) {
+  return log.put(DISCOVERY_LOG_KEY, &state, sizeof(state));
+}
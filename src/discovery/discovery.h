@@ -0,0 +1,48 @@
+/*
+ * Home Assistant MQTT discovery
+ *
+ * Each entity the device exposes is one SensorDescriptor in a sensor driver's const table. Config topics, unique IDs
+ * and discovery payloads are generated from the table when they are published, into the caller's
+ * publish buffer, so an entity costs no RAM.
+ */
+#ifndef DISCOVERY_H
+#define DISCOVERY_H
+
+#include "Arduino.h"
+#include "../telemetry/telemetry.h"
+#include "../logstore/logstore.h"
+
+#define DISCOVERY_PREFIX "homeassistant/sensor/logger_"
+#define DISCOVERY_LOG_KEY 1
+#define DISCOVERY_SUFFIX_MAX 8              // Longest SensorDescriptor suffix config topic buffers fit
+
+struct SensorDescriptor {
+  const char *suffix;        // Appended to the client ID for the unique ID and config topic
+  const char *device_class;
+  const char *name;          // Appended to the device name
+  const char *unit;
+  const char *value_key;     // Key of the value in the state payload
+};
+
+struct DeviceInfo {
+  const char *client_id;
+  const char *name;          // Name the user gave the device in the AP portal
+  const char *model;
+  const char *manufacturer;
+  const char *sw_version;
+};
+
+// Persisted across resets so an unchanged discovery set isn't republished on every boot.
+struct DiscoveryState {
+  uint32_t hash;       // FNV-1a of every config topic and payload last published
+  uint32_t sent;       // Boots that published discovery
+  uint32_t skipped;    // Boots that found it unchanged and retained on the broker
+};
+
+size_t config_topic(char *buf, size_t size, const char *client_id, const SensorDescriptor &sensor);
+size_t serialize_discovery(char *buf, size_t size, const SensorDescriptor &sensor, const DeviceInfo &device);
+
+bool read_discovery_state(LogStore &log, DiscoveryState &state);
+bool write_discovery_state(LogStore &log, const DiscoveryState &state);
+
+#endif
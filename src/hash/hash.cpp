@@ -0,0 +1,19 @@
+/*
+ * FNV-1a
+ */
+#include "hash.h"
+
+/**
+ * Adds data to an FNV-1a hash. Start with a seed, FNV1A_SEED for the standard hash, continue with
+ * the previous result.
+ */
+uint32_t fnv1a(uint32_t hash, const void *data, size_t len) {
+  const uint8_t *p = (const uint8_t *) data;
+
+  for (size_t i = 0; i < len; i++) {
+    hash ^= p[i];
+    hash *= 16777619UL;
+  }
+
+  return hash;
+}
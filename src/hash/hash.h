@@ -0,0 +1,16 @@
+/*
+ * FNV-1a
+ *
+ * 32-bit FNV-1a hash, for identifiers and change detection, not for integrity. Different seeds give
+ * unrelated hashes of the same data.
+ */
+#ifndef HASH_H
+#define HASH_H
+
+#include "Arduino.h"
+
+#define FNV1A_SEED 2166136261UL   // FNV-1a offset basis
+
+uint32_t fnv1a(uint32_t hash, const void *data, size_t len);
+
+#endif
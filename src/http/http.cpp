@@ -0,0 +1,217 @@
+/*
+ * HTTP request parser
+ */
+#include "http.h"
+
+void HttpRequest::reset() {
+  parse_state = HTTP_REQUEST_LINE;
+  error_status = 0;
+  line_len = 0;
+  line_cut = false;
+  header_bytes = 0;
+  has_length = false;
+  chunked = false;
+  gzip = false;
+  etag[0] = '\0';
+  method_buf[0] = '\0';
+  path_buf[0] = '\0';
+  body_length = 0;
+  body_read = 0;
+  body_buf = NULL;
+  body_size = 0;
+}
+
+/**
+ * Parses the next bytes of the request. Stops early at the end of the request line, so the caller
+ * can look at the method and lend a body buffer before any body is read, and once the request is
+ * complete or refused. Bytes after the end of the request are not consumed.
+ * @return The number of bytes consumed.
+ */
+size_t HttpRequest::parse(const char *data, size_t len) {
+  size_t i = 0;
+
+  while (i < len && !done()) {
+    if (parse_state == HTTP_BODY) {
+      size_t n = min((uint32_t) (len - i), body_length - body_read);
+      if (body_buf) memcpy(&body_buf[body_read], &data[i], n);
+      body_read += n;
+      i += n;
+
+      if (body_read == body_length) {
+        if (body_buf) body_buf[body_read] = '\0';
+        parse_state = HTTP_COMPLETE;
+      }
+      continue;
+    }
+
+    char c = data[i++];
+
+    if (parse_state == HTTP_HEADERS && ++header_bytes > HTTP_HEADERS_MAX) {
+      fail(431);
+      break;
+    }
+
+    if (c == '\n') {
+      bool was_request_line = parse_state == HTTP_REQUEST_LINE;
+      end_line();
+      if (was_request_line && parse_state == HTTP_HEADERS) break;
+    }
+    else if (c == '\r') {
+      continue;
+    }
+    else if (line_len < HTTP_LINE_MAX - 1) {
+      line[line_len++] = c;
+    }
+    else if (parse_state == HTTP_REQUEST_LINE) {
+      fail(414);
+    }
+    else {
+      line_cut = true;
+    }
+  }
+
+  return i;
+}
+
+/**
+ * Lends the buffer the body is read into. Only takes effect before the headers are complete; a body
+ * that doesn't fit with its terminator is refused with 413. Without a buffer the body is discarded.
+ */
+void HttpRequest::set_body_buffer(char *buf, size_t size) {
+  body_buf = buf;
+  body_size = size;
+}
+
+void HttpRequest::fail(uint16_t status) {
+  error_status = status;
+  parse_state = HTTP_ERROR;
+}
+
+void HttpRequest::end_line() {
+  line[line_len] = '\0';
+
+  if (parse_state == HTTP_REQUEST_LINE) {
+    // Empty lines before the request line are allowed.
+    if (line_len > 0) request_line();
+  }
+  else if (line_len == 0) {
+    headers_done();
+  }
+  else if (!line_cut) {
+    char *colon = strchr(line, ':');
+
+    if (colon) {
+      *colon = '\0';
+      char *value = colon + 1;
+      while (*value == ' ' || *value == '\t') value++;
+
+      char *end = value + strlen(value);
+      while (end > value && (end[-1] == ' ' || end[-1] == '\t')) *--end = '\0';
+
+      header(line, value);
+    }
+  }
+
+  line_len = 0;
+  line_cut = false;
+}
+
+void HttpRequest::request_line() {
+  char *target = strchr(line, ' ');
+  char *version = target ? strchr(target + 1, ' ') : NULL;
+
+  if (!version || strncmp(version + 1, "HTTP/1.", 7) != 0) {
+    fail(400);
+    return;
+  }
+
+  size_t method_len = target - line;
+  target++;
+  size_t path_len = strcspn(target, "? ");
+
+  if (method_len == 0 || method_len >= HTTP_METHOD_MAX) {
+    fail(501);
+    return;
+  }
+  if (path_len >= HTTP_PATH_MAX) {
+    fail(414);
+    return;
+  }
+
+  memcpy(method_buf, line, method_len);
+  method_buf[method_len] = '\0';
+  memcpy(path_buf, target, path_len);
+  path_buf[path_len] = '\0';
+
+  parse_state = HTTP_HEADERS;
+}
+
+void HttpRequest::header(const char *name, const char *value) {
+  if (strcasecmp(name, "Content-Length") == 0) {
+    // A second length could be read differently by something in between, refuse rather than pick one.
+    if (has_length || *value == '\0') {
+      fail(400);
+      return;
+    }
+
+    uint32_t length = 0;
+    for (const char *p = value; *p; p++) {
+      if (*p < '0' || *p > '9' || length > 9999999) {
+        fail(400);
+        return;
+      }
+      length = length * 10 + (*p - '0');
+    }
+
+    body_length = length;
+    has_length = true;
+  }
+  else if (strcasecmp(name, "Transfer-Encoding") == 0) {
+    chunked = true;
+  }
+  else if (strcasecmp(name, "Accept-Encoding") == 0) {
+    // A token list, "gzip, deflate, br". A q=0 refusal isn't looked for, no client sends one for gzip.
+    for (const char *p = value; (p = strstr(p, "gzip")) != NULL; p += 4) {
+      bool starts = p == value || p[-1] == ' ' || p[-1] == ',';
+      bool ends = p[4] == '\0' || p[4] == ',' || p[4] == ';' || p[4] == ' ';
+      if (starts && ends) gzip = true;
+    }
+  }
+  else if (strcasecmp(name, "If-None-Match") == 0) {
+    if (strlen(value) < sizeof(etag)) strcpy(etag, value);
+  }
+}
+
+void HttpRequest::headers_done() {
+  if (chunked) {
+    fail(501); // Forms are sent with a Content-Length
+  }
+  else if (body_length == 0) {
+    parse_state = HTTP_COMPLETE;
+  }
+  else if (body_buf && body_length >= body_size) {
+    fail(413);
+  }
+  else {
+    parse_state = HTTP_BODY;
+  }
+}
+
+/**
+ * @return The reason phrase of the statuses the portal replies with.
+ */
+const char *http_reason(uint16_t status) {
+  switch (status) {
+    case 200: return "OK";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 408: return "Request Timeout";
+    case 413: return "Content Too Large";
+    case 414: return "URI Too Long";
+    case 431: return "Request Header Fields Too Large";
+    case 501: return "Not Implemented";
+    case 503: return "Service Unavailable";
+    default: return "Error";
+  }
+}
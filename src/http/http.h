@@ -0,0 +1,80 @@
+/*
+ * HTTP request parser
+ *
+ * An incremental HTTP/1.1 request parser for the AP portal. Bytes are fed as they arrive, in pieces
+ * of any size, and the parse state is kept between calls, so a request split over several TCP
+ * segments and several polls parses the same as one read at once.
+ *
+ * Every buffer is bounded. The request line and each header line go through a fixed line buffer.
+ * A request line that doesn't fit is refused, a header line that doesn't fit is cut, as the portal
+ * only looks at short headers. The headers as a whole are bounded too. A body is read up to its
+ * Content-Length into a buffer the caller lends after the request line, so that connections that
+ * have no body don't each hold one. Of the other headers, only what the portal's caching and
+ * compression need is kept: whether gzip is accepted, and the ETag of If-None-Match.
+ */
+#ifndef HTTP_H
+#define HTTP_H
+
+#include "Arduino.h"
+
+#define HTTP_LINE_MAX 128       // Request line and header lines, terminator included
+#define HTTP_METHOD_MAX 8
+#define HTTP_PATH_MAX 64        // Without the query, which is dropped
+#define HTTP_HEADERS_MAX 2048   // Header bytes before the request is refused
+#define HTTP_ETAG_MAX 24        // Longest If-None-Match kept, longer ones never match
+
+enum HttpParseState : uint8_t {
+  HTTP_REQUEST_LINE,
+  HTTP_HEADERS,
+  HTTP_BODY,          // Reading Content-Length bytes of body
+  HTTP_COMPLETE,
+  HTTP_ERROR          // Refused, error() is the status to reply with
+};
+
+class HttpRequest {
+  public:
+    void reset();
+    size_t parse(const char *data, size_t len);
+    void set_body_buffer(char *buf, size_t size);
+
+    HttpParseState state() { return parse_state; }
+    bool done() { return parse_state >= HTTP_COMPLETE; }
+    uint16_t error() { return error_status; }
+    const char *method() { return method_buf; }
+    const char *path() { return path_buf; }
+    uint32_t content_length() { return body_length; }
+    bool accepts_gzip() { return gzip; }
+    const char *if_none_match() { return etag; }
+    // The body, null terminated, once complete. NULL if it had none or no buffer was lent, since the
+    // lent buffer still holds whatever was read into it before.
+    char *body() { return parse_state == HTTP_COMPLETE && body_length > 0 ? body_buf : NULL; }
+
+  private:
+    HttpParseState parse_state = HTTP_REQUEST_LINE;
+    uint16_t error_status = 0;
+    char line[HTTP_LINE_MAX];
+    uint8_t line_len = 0;
+    bool line_cut = false;            // The header line in progress overflowed line
+    uint16_t header_bytes = 0;
+    bool has_length = false;
+    bool chunked = false;
+    bool gzip = false;                // Accept-Encoding lists gzip
+    char etag[HTTP_ETAG_MAX];         // If-None-Match, empty if none
+
+    char method_buf[HTTP_METHOD_MAX];
+    char path_buf[HTTP_PATH_MAX];
+    uint32_t body_length = 0;
+    uint32_t body_read = 0;
+    char *body_buf = NULL;
+    size_t body_size = 0;
+
+    void fail(uint16_t status);
+    void end_line();
+    void request_line();
+    void header(const char *name, const char *value);
+    void headers_done();
+};
+
+const char *http_reason(uint16_t status);
+
+#endif
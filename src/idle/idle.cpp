@@ -0,0 +1,15 @@
+/*
+ * Idle waits
+ */
+#include "idle.h"
+#include <ArduinoLowPower.h>
+
+/**
+ * Waits with the CPU halted between SysTick interrupts instead of spinning like delay() does.
+ */
+void idle_delay(unsigned long ms) {
+  unsigned long start_ms = millis();
+  while (millis() - start_ms < ms) {
+    LowPower.idle();
+  }
+}
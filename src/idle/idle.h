@@ -0,0 +1,14 @@
+/*
+ * Idle waits
+ *
+ * Waits that halt the CPU between SysTick interrupts instead of spinning like delay() does. The
+ * SysTick wakes the CPU every millisecond, so they are as precise as delay().
+ */
+#ifndef IDLE_H
+#define IDLE_H
+
+#include "Arduino.h"
+
+void idle_delay(unsigned long ms);
+
+#endif
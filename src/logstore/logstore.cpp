@@ -0,0 +1,244 @@
+/*
+ * Log store
+ */
+#include "logstore.h"
+
+void LogStore::segment_name(uint8_t segment, char *name) {
+  sprintf(name, LOG_FILE_PREFIX "%u", segment);
+}
+
+/**
+ * Scans the log and rebuilds the index, finishing a compaction a reset interrupted. Only needed once
+ * after a reset, since the index lives in RAM.
+ * @return false if an interrupted compaction couldn't be finished.
+ */
+bool LogStore::begin() {
+  if (ready) return true;
+
+  memset(index, 0, sizeof(index));
+  next_seq = 1;
+
+  for (uint8_t s = 0; s < LOG_SEGMENTS; s++) {
+    scan(s);
+  }
+
+  // The head is the segment started last.
+  head = 0;
+  for (uint8_t s = 1; s < LOG_SEGMENTS; s++) {
+    if (segment_seq[s] > segment_seq[head]) head = s;
+  }
+
+  // The segment after the head should be empty. If it isn't, a reset came after the head moved on and
+  // before the oldest segment was compacted and erased.
+  uint8_t next = (head + 1) % LOG_SEGMENTS;
+  if (segment_seq[next] != 0 && !compact(next)) return false;
+
+  ready = true;
+  return true;
+}
+
+/**
+ * Reads a segment's records into the index. Bytes that don't start a valid record newer than the one
+ * before it, what is left of a torn append, are skipped a byte at a time until one does. The next
+ * append into the segment goes at the end of the file.
+ */
+void LogStore::scan(uint8_t segment) {
+  char name[16];
+  segment_name(segment, name);
+
+  segment_seq[segment] = 0;
+  segment_end[segment] = 0;
+
+  uint32_t size = 0;
+  if (!WiFiStorage.exists(name, &size) || size == 0) return;
+  if (size > LOG_SEGMENT_SIZE) size = LOG_SEGMENT_SIZE;
+
+  uint8_t buf[LOG_SCAN_CHUNK];
+  uint32_t buf_start = 0;
+  uint32_t buf_len = 0;
+  uint32_t offset = 0;
+  uint32_t last_seq = 0;
+
+  for (; offset + LOG_RECORD_SIZE(0) <= size; offset++) {
+    // Refill so the largest record starting at offset is in the buffer, or the rest of the segment.
+    if (offset + LOG_RECORD_SIZE(LOG_MAX_VALUE) > buf_start + buf_len && buf_start + buf_len < size) {
+      buf_start = offset;
+      buf_len = min((uint32_t) sizeof(buf), size - offset);
+      if (!WiFiStorage.read(name, buf_start, buf, buf_len)) break;
+      metrics.scan_bytes += buf_len;
+    }
+
+    const uint8_t *p = &buf[offset - buf_start];
+    LogRecordHeader header;
+    memcpy(&header, p, sizeof(header));
+
+    if (header.magic != LOG_RECORD_MAGIC || header.key >= LOG_MAX_KEYS || header.length > LOG_MAX_VALUE ||
+        header.seq <= last_seq || offset + LOG_RECORD_SIZE(header.length) > buf_start + buf_len) {
+      continue;
+    }
+
+    uint32_t crc;
+    memcpy(&crc, p + sizeof(header) + header.length, sizeof(crc));
+    if (crc != crc32(0, p, sizeof(header) + header.length)) continue;
+
+    if (segment_seq[segment] == 0) segment_seq[segment] = header.seq;
+    if (header.seq > index[header.key].seq) {
+      index[header.key] = {header.seq, (uint16_t) offset, segment, header.length};
+    }
+
+    last_seq = header.seq;
+    if (header.seq >= next_seq) next_seq = header.seq + 1;
+    offset += LOG_RECORD_SIZE(header.length) - 1;
+  }
+
+  segment_end[segment] = size;
+}
+
+/**
+ * Stores a value under key, replacing the one before.
+ * @return false if the store isn't begun, the key or length are out of range, or the write failed.
+ */
+bool LogStore::put(uint8_t key, const void *value, uint8_t length) {
+  if (length == 0 || length > LOG_MAX_VALUE) return false;
+  return append(key, value, length);
+}
+
+/**
+ * Reads the value stored under key, up to size bytes of it.
+ * @return The value's length, -1 if there is none.
+ */
+int LogStore::get(uint8_t key, void *value, uint8_t size) {
+  if (!ready || key >= LOG_MAX_KEYS) return -1;
+
+  const Entry &entry = index[key];
+  if (entry.seq == 0 || entry.length == 0) return -1;
+
+  char name[16];
+  segment_name(entry.segment, name);
+  if (!WiFiStorage.read(name, entry.offset + sizeof(LogRecordHeader), (uint8_t *) value, min(size, entry.length))) {
+    return -1;
+  }
+
+  return entry.length;
+}
+
+/**
+ * Deletes the value stored under key.
+ * @return false if the deletion couldn't be written.
+ */
+bool LogStore::remove(uint8_t key) {
+  if (key < LOG_MAX_KEYS && (index[key].seq == 0 || index[key].length == 0)) return true;
+  return append(key, NULL, 0);
+}
+
+/**
+ * Appends a record, moving the head on first if it is full, and times the whole of it.
+ */
+bool LogStore::append(uint8_t key, const void *value, uint8_t length) {
+  if (!ready || key >= LOG_MAX_KEYS) return false;
+
+  unsigned long start_us = micros();
+
+  // Finishes a compaction that failed before, so the segment after the head is empty again.
+  uint8_t next = (head + 1) % LOG_SEGMENTS;
+
+  bool ok = (segment_seq[next] == 0 || compact(next)) &&
+            (segment_end[head] + LOG_RECORD_SIZE(length) <= LOG_SEGMENT_SIZE || advance_head()) &&
+            write_record(key, value, length);
+
+  uint32_t elapsed_us = micros() - start_us;
+  metrics.appends++;
+  metrics.value_bytes += length;
+  metrics.append_us_last = elapsed_us;
+  metrics.append_us_total += elapsed_us;
+  if (elapsed_us > metrics.append_us_max) metrics.append_us_max = elapsed_us;
+
+  return ok;
+}
+
+/**
+ * Writes one record at the end of the head segment, in a single transfer, and points the key at it.
+ * After a failed write the end is read back from the file, which keeps whatever part of the record
+ * made it.
+ */
+bool LogStore::write_record(uint8_t key, const void *value, uint8_t length) {
+  uint8_t record[LOG_RECORD_SIZE(LOG_MAX_VALUE)];
+  LogRecordHeader header = {LOG_RECORD_MAGIC, key, length, next_seq};
+
+  memcpy(record, &header, sizeof(header));
+  if (length > 0) memcpy(&record[sizeof(header)], value, length);
+  uint32_t crc = crc32(0, record, sizeof(header) + length);
+  memcpy(&record[sizeof(header) + length], &crc, sizeof(crc));
+
+  char name[16];
+  segment_name(head, name);
+  uint16_t offset = segment_end[head];
+  if (!WiFiStorage.write(name, offset, record, LOG_RECORD_SIZE(length))) {
+    uint32_t size = LOG_SEGMENT_SIZE;
+    WiFiStorage.exists(name, &size);
+    segment_end[head] = min(size, (uint32_t) LOG_SEGMENT_SIZE);
+    return false;
+  }
+
+  metrics.flash_bytes += LOG_RECORD_SIZE(length);
+
+  if (segment_seq[head] == 0) segment_seq[head] = next_seq;
+  segment_end[head] = offset + LOG_RECORD_SIZE(length);
+  index[key] = {next_seq, offset, head, length};
+  next_seq++;
+
+  return true;
+}
+
+/**
+ * Makes the empty segment the head, then compacts the oldest segment into it so that one is empty
+ * again.
+ */
+bool LogStore::advance_head() {
+  head = (head + 1) % LOG_SEGMENTS;
+
+  uint8_t oldest = (head + 1) % LOG_SEGMENTS;
+  return segment_seq[oldest] == 0 || compact(oldest);
+}
+
+/**
+ * Copies the records of a segment that are still current to the head and erases the segment. Deletes
+ * are dropped: whatever they deleted was in this segment or older ones, which are gone by now.
+ * @return false if a copy or the erase failed, the segment is kept then.
+ */
+bool LogStore::compact(uint8_t segment) {
+  char name[16];
+  segment_name(segment, name);
+
+  for (uint8_t key = 0; key < LOG_MAX_KEYS; key++) {
+    Entry &entry = index[key];
+    if (entry.seq == 0 || entry.segment != segment) continue;
+
+    if (entry.length == 0) {
+      entry = {};
+      continue;
+    }
+
+    uint8_t value[LOG_MAX_VALUE];
+    if (!WiFiStorage.read(name, entry.offset + sizeof(LogRecordHeader), value, entry.length) ||
+        segment_end[head] + LOG_RECORD_SIZE(entry.length) > LOG_SEGMENT_SIZE ||
+        !write_record(key, value, entry.length)) {
+      return false;
+    }
+  }
+
+  if (!erase(segment)) return false;
+  metrics.compactions++;
+  return true;
+}
+
+bool LogStore::erase(uint8_t segment) {
+  char name[16];
+  segment_name(segment, name);
+
+  if (!WiFiStorage.remove(name)) return false;
+  segment_seq[segment] = 0;
+  segment_end[segment] = 0;
+  metrics.erases++;
+  return true;
+}
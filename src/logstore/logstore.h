@@ -0,0 +1,92 @@
+/*
+ * Log store
+ *
+ * A small key/record store for state that changes often, kept as an append-only log on the NINA's
+ * WiFiStorage. Every put() appends one record to the head segment instead of rewriting a file, so
+ * the flash is programmed in sequence and the same block isn't erased on every wake.
+ *
+ * The log is a ring of LOG_SEGMENTS files of up to LOG_SEGMENT_SIZE bytes. One segment is always
+ * empty. When the head is full the empty segment becomes the head, the records still current in the
+ * oldest segment are copied to it and the oldest is erased, becoming the next empty one.
+ *
+ * A record is a header with the key, value length and a sequence number, the value, and a CRC-32 of
+ * both. The newest record of a key wins; a zero length record deletes it. begin() rebuilds the index
+ * by scanning every segment. The NINA firmware opens files for append whatever the offset given, so
+ * records only ever go at the end of a segment file and are never rewritten. An append torn by a
+ * reset stays in the file: the scan skips bytes that don't start a valid record newer than the one
+ * before it, and finds the records appended after them. A reset during compaction leaves the copies
+ * and the originals both readable, and begin() finishes it.
+ */
+#ifndef LOGSTORE_H
+#define LOGSTORE_H
+
+#include "Arduino.h"
+#include <WiFiNINA.h>
+#include "../crc/crc.h"
+
+#define LOG_FILE_PREFIX "/fs/log"
+#define LOG_SEGMENTS 4
+#define LOG_SEGMENT_SIZE 4096
+#define LOG_MAX_KEYS 16            // Keys are 0 .. LOG_MAX_KEYS - 1
+#define LOG_MAX_VALUE 64           // Bytes, so every key's current record fits a segment with room to spare
+#define LOG_RECORD_MAGIC 0x4c52    // "RL"
+#define LOG_SCAN_CHUNK 256         // Bytes read per WiFiStorage transfer while scanning
+
+struct LogRecordHeader {
+  uint16_t magic;
+  uint8_t key;
+  uint8_t length;       // Value bytes, 0 for a delete
+  uint32_t seq;         // Increases with every record written, compaction copies included
+};
+
+#define LOG_RECORD_SIZE(len) (sizeof(LogRecordHeader) + (len) + sizeof(uint32_t))
+
+struct LogStoreStats {
+  uint32_t appends;         // put() and remove() calls
+  uint32_t value_bytes;     // Value bytes the caller asked to store
+  uint32_t flash_bytes;     // Bytes written to flash: headers, CRCs and compaction copies included
+  uint32_t compactions;
+  uint32_t erases;          // Segments erased
+  uint32_t scan_bytes;      // Bytes read by begin()
+  uint32_t append_us_last;
+  uint32_t append_us_max;   // Slowest append, the one that compacted most likely
+  uint64_t append_us_total;
+};
+
+class LogStore {
+  public:
+    bool begin();
+    bool put(uint8_t key, const void *value, uint8_t length);
+    int get(uint8_t key, void *value, uint8_t size);
+    bool remove(uint8_t key);
+
+    const LogStoreStats &stats() { return metrics; }
+    // Flash bytes written per value byte stored, 1.0 would be no overhead at all.
+    float write_amplification() { return metrics.value_bytes ? (float) metrics.flash_bytes / metrics.value_bytes : 0; }
+
+  private:
+    struct Entry {
+      uint32_t seq;         // 0 if the key was never written
+      uint16_t offset;
+      uint8_t segment;
+      uint8_t length;
+    };
+
+    Entry index[LOG_MAX_KEYS] = {};
+    uint32_t segment_seq[LOG_SEGMENTS] = {};   // Sequence number of a segment's first record, 0 if empty
+    uint16_t segment_end[LOG_SEGMENTS] = {};   // Size of a segment's file, torn records included
+    uint32_t next_seq = 1;
+    uint8_t head = 0;
+    bool ready = false;
+    LogStoreStats metrics = {};
+
+    static void segment_name(uint8_t segment, char *name);
+    void scan(uint8_t segment);
+    bool append(uint8_t key, const void *value, uint8_t length);
+    bool write_record(uint8_t key, const void *value, uint8_t length);
+    bool advance_head();
+    bool compact(uint8_t segment);
+    bool erase(uint8_t segment);
+};
+
+#endif
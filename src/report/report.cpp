@@ -0,0 +1,47 @@
+/*
+ * Report policy
+ */
+#include "report.h"
+
+ReportPolicy::ReportPolicy(unsigned long heartbeat_s) : heartbeat_s(heartbeat_s) {}
+
+static bool moved(int16_t value, int16_t reference, int16_t deadband) {
+  if ((value == TELEMETRY_NAN) != (reference == TELEMETRY_NAN)) return true;
+  if (value == TELEMETRY_NAN) return false;
+
+  return abs(value - reference) >= deadband;
+}
+
+/**
+ * @return true if a value of the sample moved by at least its deadband since the last reported
+ * sample, or nothing has been reported yet.
+ */
+bool ReportPolicy::changed(const Sample &sample) {
+  if (!has_reference) return true;
+
+  return moved(sample.temperature, reference.temperature, REPORT_DEADBAND_TEMPERATURE) ||
+         moved(sample.humidity, reference.humidity, REPORT_DEADBAND_HUMIDITY) ||
+         moved(sample.illuminance, reference.illuminance, REPORT_DEADBAND_ILLUMINANCE) ||
+         moved(sample.battery, reference.battery, REPORT_DEADBAND_BATTERY);
+}
+
+/**
+ * @return true if nothing has been published for the heartbeat interval, give or take the slack of
+ * the wake slots, so a heartbeat on the slot of a whole number of intervals isn't put off by one.
+ */
+bool ReportPolicy::heartbeat_due(time_t t) {
+  return !has_published || t - last_publish + REPORT_HEARTBEAT_SLACK_S >= (time_t) heartbeat_s;
+}
+
+/**
+ * Makes the sample the reference the next samples' deadbands are measured from.
+ */
+void ReportPolicy::reported(const Sample &sample) {
+  reference = sample;
+  has_reference = true;
+}
+
+void ReportPolicy::published(time_t t) {
+  last_publish = t;
+  has_published = true;
+}
@@ -0,0 +1,37 @@
+/*
+ * Report policy
+ *
+ * The sensors are sampled on every wake, but a sample is only worth the radio when one of its values
+ * moved by at least its deadband since the last reported sample, or nothing has been published for
+ * the heartbeat interval. A deadband of 0 reports every sample.
+ */
+#ifndef REPORT_H
+#define REPORT_H
+
+#include "Arduino.h"
+#include "../telemetry/telemetry.h"
+
+#define REPORT_DEADBAND_TEMPERATURE 5   // Tenths of a degree C
+#define REPORT_DEADBAND_HUMIDITY 30     // Tenths of a percent
+#define REPORT_DEADBAND_ILLUMINANCE 100 // Tenths of a percent
+#define REPORT_DEADBAND_BATTERY 2       // Percent, a single percent is within the ADC noise
+#define REPORT_HEARTBEAT_SLACK_S 10     // Wakes land a few seconds either side of their slots
+
+class ReportPolicy {
+  public:
+    explicit ReportPolicy(unsigned long heartbeat_s);
+
+    bool changed(const Sample &sample);
+    bool heartbeat_due(time_t t);
+    void reported(const Sample &sample);
+    void published(time_t t);
+
+  private:
+    unsigned long heartbeat_s;
+    Sample reference;             // Last sample queued for reporting
+    bool has_reference = false;
+    time_t last_publish = 0;
+    bool has_published = false;
+};
+
+#endif
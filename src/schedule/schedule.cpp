@@ -0,0 +1,73 @@
+/*
+ * Sample scheduler
+ */
+#include "schedule.h"
+
+SampleScheduler::SampleScheduler(unsigned long nominal_ms, unsigned long floor_ms, unsigned long ceiling_ms) :
+  nominal_ms(nominal_ms), floor_ms(floor_ms), ceiling_ms(ceiling_ms), interval(nominal_ms) {}
+
+// Change of a value between two samples, in deadbands.
+static float deadbands(int16_t value, int16_t previous, int16_t deadband) {
+  if (value == TELEMETRY_NAN || previous == TELEMETRY_NAN || deadband <= 0) return 0;
+  return (float) abs(value - previous) / deadband;
+}
+
+/**
+ * Updates the rate of change with a new sample and picks the interval until the next one.
+ * @return The new interval in ms, between the floor and the ceiling.
+ */
+unsigned long SampleScheduler::update(const Sample &sample) {
+  if (has_previous && sample.time > previous.time) {
+    float change = max(deadbands(sample.temperature, previous.temperature, REPORT_DEADBAND_TEMPERATURE),
+                   max(deadbands(sample.humidity, previous.humidity, REPORT_DEADBAND_HUMIDITY),
+                       deadbands(sample.illuminance, previous.illuminance, REPORT_DEADBAND_ILLUMINANCE)));
+
+    float rate = change * (nominal_ms / 1000.0) / (sample.time - previous.time);
+    change_rate += SCHEDULE_SMOOTHING * (rate - change_rate);
+  }
+
+  previous = sample;
+  has_previous = true;
+
+  // Aim for about one deadband per sample while values are moving.
+  unsigned long target = battery_interval(sample.battery);
+  if (change_rate > 1) {
+    target = target / change_rate;
+  }
+
+  interval = constrain(target, floor_ms, ceiling_ms);
+  return interval;
+}
+
+/**
+ * Sets the offset of the wake slots within the nominal interval, e.g. derived from the client ID.
+ */
+void SampleScheduler::set_phase(unsigned long phase_ms) {
+  this->phase_ms = phase_ms % nominal_ms;
+}
+
+/**
+ * @return The time from t to the next wake slot of the current interval that is at least half an
+ * interval away, so a wake that ran late or a first wake at any time doesn't sample twice in a row.
+ */
+unsigned long SampleScheduler::sleep_ms(time_t t) {
+  uint32_t interval_s = max(interval / 1000, 1UL);
+  uint32_t offset_s = (uint64_t) phase_ms * interval / nominal_ms / 1000 % interval_s;
+
+  uint32_t left_s = interval_s - ((uint32_t) t - offset_s) % interval_s;
+  if (left_s < interval_s / 2) left_s += interval_s;
+
+  return left_s * 1000UL;
+}
+
+/**
+ * @return The nominal interval, stretched linearly to the ceiling between SCHEDULE_BATTERY_FULL and
+ * SCHEDULE_BATTERY_EMPTY.
+ */
+unsigned long SampleScheduler::battery_interval(uint8_t level) {
+  if (level >= SCHEDULE_BATTERY_FULL || ceiling_ms <= nominal_ms) return nominal_ms;
+  if (level <= SCHEDULE_BATTERY_EMPTY) return ceiling_ms;
+
+  return nominal_ms + (ceiling_ms - nominal_ms) * (SCHEDULE_BATTERY_FULL - level) /
+         (SCHEDULE_BATTERY_FULL - SCHEDULE_BATTERY_EMPTY);
+}
@@ -0,0 +1,46 @@
+/*
+ * Sample scheduler
+ *
+ * Picks the time until the next sample. The nominal interval is stretched towards the ceiling as the
+ * battery runs down, and shortened towards the floor while the samples change fast, measured in
+ * report deadbands per nominal interval.
+ *
+ * Wakes fall on slots of absolute time, every interval at the device's phase within it, so the
+ * period doesn't drift by the length of each wake and devices powered up together don't all wake
+ * together. A phase in the nominal interval keeps its share of a stretched or shortened one.
+ */
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#include "Arduino.h"
+#include "../telemetry/telemetry.h"
+#include "../report/report.h"
+
+#define SCHEDULE_BATTERY_FULL 50     // Battery level down to which the nominal interval is used
+#define SCHEDULE_BATTERY_EMPTY 10    // Battery level at and below which the ceiling is used
+#define SCHEDULE_SMOOTHING 0.5       // Weight of the latest sample in the rate of change average
+
+class SampleScheduler {
+  public:
+    SampleScheduler(unsigned long nominal_ms, unsigned long floor_ms, unsigned long ceiling_ms);
+
+    unsigned long update(const Sample &sample);
+    unsigned long interval_ms() { return interval; }
+    void set_phase(unsigned long phase_ms);
+    unsigned long sleep_ms(time_t t);
+
+  private:
+    unsigned long nominal_ms;
+    unsigned long floor_ms;
+    unsigned long ceiling_ms;
+    unsigned long interval;
+    unsigned long phase_ms = 0;   // Offset of the slots within the nominal interval
+
+    Sample previous;
+    bool has_previous = false;
+    float change_rate = 0;   // Deadbands crossed per nominal interval, smoothed
+
+    unsigned long battery_interval(uint8_t level);
+};
+
+#endif
@@ -0,0 +1,211 @@
+/*
+ * Sensor drivers
+ */
+#include "sensors.h"
+
+/**
+ * The DHT22 reports in tenths, so its readings are kept as fixed-point tenths.
+ * @return The value in tenths, TELEMETRY_NAN for a failed read.
+ */
+static int16_t to_tenths(float value) {
+  return isnan(value) ? TELEMETRY_NAN : (int16_t) lroundf(value * 10);
+}
+
+void DhtSensor::begin() {
+  dht.begin();
+}
+
+void DhtSensor::sample(Sample &sample) {
+  sample.temperature = to_tenths(dht.readTemperature());
+  sample.humidity = to_tenths(dht.readHumidity());
+}
+
+void PhotoresistorSensor::begin() {
+  adc.begin();
+}
+
+#ifdef ILLUMINANCE_LOG_RESPONSE
+/**
+ * Fixed-point log2, for the photoresistor's log response.
+ * @return log2(x) in Q8, 0 for x = 0.
+ */
+static int32_t log2_q8(uint32_t x) {
+  if (x == 0) return 0;
+
+  // Integer part from the top bit, then the fraction bit by bit by squaring the mantissa in Q15.
+  int32_t result = 0;
+  while (x >= 2u << 15) {
+    x >>= 1;
+    result += 256;
+  }
+  while (x < 1u << 15) {
+    x <<= 1;
+    result -= 256;
+  }
+  result += 15 * 256;
+
+  for (int32_t bit = 128; bit > 0; bit >>= 1) {
+    x = (x * x) >> 15;
+    if (x >= 2u << 15) {
+      x >>= 1;
+      result += bit;
+    }
+  }
+  return result;
+}
+#endif
+
+/**
+ * The reading on the scale the calibration is linear in: the counts themselves, or with
+ * ILLUMINANCE_LOG_RESPONSE the log of the photoresistor's conductance relative to the fixed resistor,
+ * log2(counts / (full scale - counts)).
+ */
+int32_t PhotoresistorSensor::response(uint16_t counts) {
+#ifdef ILLUMINANCE_LOG_RESPONSE
+  if (counts < 1) counts = 1;
+  if (counts > ADC_BURST_FULL_SCALE - 1) counts = ADC_BURST_FULL_SCALE - 1;
+  return log2_q8(counts) - log2_q8(ADC_BURST_FULL_SCALE - counts);
+#else
+  return counts;
+#endif
+}
+
+void PhotoresistorSensor::sample(Sample &sample) {
+  int32_t dark = response(dark_counts);
+  int32_t bright = response(bright_counts);
+  int32_t value = response(adc.read(input));
+
+  if (bright <= dark) {
+    sample.illuminance = TELEMETRY_NAN;
+    return;
+  }
+
+  int32_t tenths = ((value - dark) * 1000 + (bright - dark) / 2) / (bright - dark);
+  sample.illuminance = constrain(tenths, 0, 1000);
+}
+
+void BatterySensor::sample(Sample &sample) {
+  sample.battery = monitor.level();
+  sample.battery_mv = monitor.rest_mv();
+  sample.battery_loaded_mv = monitor.loaded_mv();
+}
+
+/**
+ * Configures the power pins and leaves every sensor off.
+ */
+void SensorRegistry::setup() {
+  for (uint8_t i = 0; i < count; i++) {
+    if (drivers[i]->power_pin == SENSOR_NO_POWER_PIN) continue;
+    pinMode(drivers[i]->power_pin, OUTPUT);
+  }
+
+  power_down();
+}
+
+/**
+ * Powers every sensor at once, for when the settle time can overlap with other work.
+ */
+void SensorRegistry::power_up() {
+  for (uint8_t i = 0; i < count; i++) {
+    power(drivers[i]);
+  }
+}
+
+/**
+ * Returns once every sensor is settled. Sensors that aren't powered yet are powered just in time,
+ * slowest first, so the wait is that of the slowest sensor and the fast ones don't draw current while
+ * it settles.
+ */
+void SensorRegistry::settle() {
+  unsigned long now_ms = millis();
+  unsigned long wait_ms = 0;
+
+  for (uint8_t i = 0; i < count; i++) {
+    SensorDriver *driver = drivers[i];
+    unsigned long remaining_ms = driver->settle_ms;
+
+    if (driver->powered) {
+      unsigned long elapsed_ms = now_ms - driver->powered_at_ms;
+      remaining_ms = elapsed_ms < driver->settle_ms ? driver->settle_ms - elapsed_ms : 0;
+    }
+
+    if (remaining_ms > wait_ms) wait_ms = remaining_ms;
+  }
+
+  unsigned long ready_ms = now_ms + wait_ms;
+
+  // Power the remaining sensors slowest first, each settle_ms before ready_ms.
+  while (true) {
+    SensorDriver *next = NULL;
+
+    for (uint8_t i = 0; i < count; i++) {
+      if (!drivers[i]->powered && (!next || drivers[i]->settle_ms > next->settle_ms)) next = drivers[i];
+    }
+
+    if (!next) break;
+
+    unsigned long power_at_ms = ready_ms - next->settle_ms;
+    long until_ms = (long) (power_at_ms - millis());
+    if (until_ms > 0) idle_delay(until_ms);
+    power(next);
+  }
+
+  long until_ms = (long) (ready_ms - millis());
+  if (until_ms > 0) idle_delay(until_ms);
+}
+
+/**
+ * Reads every sensor into the sample, settling them first if needed.
+ */
+void SensorRegistry::sample(Sample &sample) {
+  settle();
+
+  for (uint8_t i = 0; i < count; i++) {
+    drivers[i]->sample(sample);
+  }
+}
+
+void SensorRegistry::power_down() {
+  for (uint8_t i = 0; i < count; i++) {
+    drivers[i]->powered = false;
+    if (drivers[i]->power_pin == SENSOR_NO_POWER_PIN) continue;
+    digitalWrite(drivers[i]->power_pin, LOW);
+  }
+}
+
+/**
+ * @return The number of Home Assistant entities of all drivers.
+ */
+uint8_t SensorRegistry::entity_count() {
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < count; i++) n += drivers[i]->entity_count;
+  return n;
+}
+
+/**
+ * @return The i-th entity, counting through the drivers in table order.
+ */
+const SensorDescriptor &SensorRegistry::entity(uint8_t i) {
+  uint8_t d = 0;
+  while (i >= drivers[d]->entity_count) i -= drivers[d++]->entity_count;
+  return drivers[d]->entities[i];
+}
+
+/**
+ * Powers a driver, along with any other driver on the same pin, and begins it.
+ */
+void SensorRegistry::power(SensorDriver *driver) {
+  if (driver->powered) return;
+
+  if (driver->power_pin != SENSOR_NO_POWER_PIN) digitalWrite(driver->power_pin, HIGH);
+  unsigned long now_ms = millis();
+
+  for (uint8_t i = 0; i < count; i++) {
+    SensorDriver *other = drivers[i];
+    if (other->powered || (other != driver && (other->power_pin != driver->power_pin ||
+                                               driver->power_pin == SENSOR_NO_POWER_PIN))) continue;
+    other->powered = true;
+    other->powered_at_ms = now_ms;
+    other->begin();
+  }
+}
@@ -0,0 +1,111 @@
+/*
+ * Sensor drivers
+ *
+ * Every sensor is a SensorDriver: the pin that powers it, how long it needs after power-up before it
+ * reads correctly, the fields of a Sample it fills and the Home Assistant entities it exposes. The
+ * sketch lists its drivers in a static table that a SensorRegistry powers, settles and samples as a
+ * whole, so a new sensor is one driver and one table entry.
+ */
+#ifndef SENSORS_H
+#define SENSORS_H
+
+#include "Arduino.h"
+#include <DHT.h>
+#include "../telemetry/telemetry.h"
+#include "../discovery/discovery.h"
+#include "../adc/adc.h"
+#include "../battery/battery.h"
+#include "../idle/idle.h"
+
+#define SENSOR_NO_POWER_PIN -1    // Always powered, e.g. the battery divider
+
+class SensorDriver {
+  public:
+    template <size_t N> SensorDriver(int8_t power_pin, uint16_t settle_ms, const SensorDescriptor (&entities)[N]) :
+        power_pin(power_pin), settle_ms(settle_ms), entities(entities), entity_count(N) {}
+
+    // Called once the driver is powered, on every wake.
+    virtual void begin() {}
+    // Reads the sensor into its fields of the sample.
+    virtual void sample(Sample &sample) = 0;
+
+    const int8_t power_pin;
+    const uint16_t settle_ms;     // Time from power-up to the first valid reading
+    const SensorDescriptor *const entities;
+    const uint8_t entity_count;
+
+  private:
+    friend class SensorRegistry;
+    bool powered = false;
+    unsigned long powered_at_ms = 0;
+};
+
+class DhtSensor : public SensorDriver {
+  public:
+    template <size_t N> DhtSensor(DHT &dht, int8_t power_pin, const SensorDescriptor (&entities)[N]) :
+        SensorDriver(power_pin, 1000, entities), dht(dht) {}
+
+    void begin() override;
+    void sample(Sample &sample) override;
+
+  private:
+    DHT &dht;
+};
+
+// Reads the photoresistor divider through an AdcBurst and calibrates it to tenths of a percent
+// between dark_counts and bright_counts, readings of the divider in the dark and in full light on the
+// burst's 0..ADC_BURST_FULL_SCALE scale. With ILLUMINANCE_LOG_RESPONSE defined the mapping follows the
+// photoresistor's log response instead, so equal steps are equal ratios of light.
+class PhotoresistorSensor : public SensorDriver {
+  public:
+    template <size_t N> PhotoresistorSensor(AdcBurst &adc, uint8_t input, int8_t power_pin, uint16_t dark_counts,
+                                            uint16_t bright_counts, const SensorDescriptor (&entities)[N]) :
+        SensorDriver(power_pin, 5, entities), adc(adc), input(input), dark_counts(dark_counts),
+        bright_counts(bright_counts) {}
+
+    void begin() override;
+    void sample(Sample &sample) override;
+
+  private:
+    AdcBurst &adc;
+    uint8_t input;
+    uint16_t dark_counts;
+    uint16_t bright_counts;
+
+    int32_t response(uint16_t counts);
+};
+
+// Reports what the BatteryMonitor last measured. The sketch measures at the loads the monitor needs,
+// so sampling doesn't touch the ADC.
+class BatterySensor : public SensorDriver {
+  public:
+    template <size_t N> BatterySensor(BatteryMonitor &monitor, const SensorDescriptor (&entities)[N]) :
+        SensorDriver(SENSOR_NO_POWER_PIN, 0, entities), monitor(monitor) {}
+
+    void sample(Sample &sample) override;
+
+  private:
+    BatteryMonitor &monitor;
+};
+
+class SensorRegistry {
+  public:
+    template <size_t N> explicit SensorRegistry(SensorDriver *const (&drivers)[N]) : drivers(drivers), count(N) {}
+
+    void setup();
+    void power_up();
+    void settle();
+    void sample(Sample &sample);
+    void power_down();
+
+    uint8_t entity_count();
+    const SensorDescriptor &entity(uint8_t i);
+
+  private:
+    SensorDriver *const *drivers;
+    uint8_t count;
+
+    void power(SensorDriver *driver);
+};
+
+#endif
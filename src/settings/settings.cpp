@@ -0,0 +1,113 @@
+/*
+ * Device settings
+ */
+#include "settings.h"
+
+/**
+ * Reads the settings record from flash in one transfer.
+ * @return false if there is none, or it is of another version or damaged. settings is zeroed then.
+ */
+bool read_settings(Settings &settings) {
+  SettingsRecord record;
+  WiFiStorageFile file = WiFiStorage.open(SETTINGS_FILE);
+  bool ok = file.size() == sizeof(record) && file.read(&record, sizeof(record)) == sizeof(record);
+  file.close();
+
+  ok = ok && record.header.magic == SETTINGS_MAGIC && record.header.version == SETTINGS_VERSION &&
+       record.header.length == sizeof(Settings) &&
+       record.crc == crc32(0, &record, offsetof(SettingsRecord, crc));
+
+  if (ok) settings = record.settings;
+  else memset(&settings, 0, sizeof(settings));
+  return ok;
+}
+
+bool write_settings(const Settings &settings) {
+  SettingsRecord record;
+  memset(&record, 0, sizeof(record));
+  record.header = {SETTINGS_MAGIC, SETTINGS_VERSION, sizeof(Settings)};
+  record.settings = settings;
+  record.crc = crc32(0, &record, offsetof(SettingsRecord, crc));
+
+  WiFiStorageFile file = WiFiStorage.open(SETTINGS_FILE);
+
+  if (file) {
+    file.erase();
+  }
+
+  bool ok = file.write(&record, sizeof(record)) == sizeof(record);
+  file.close();
+  return ok;
+}
+
+/**
+ * Removes the settings record, and the legacy files should there still be any.
+ * @return false if there was no record.
+ */
+bool erase_settings() {
+  WiFiStorage.remove(SETTINGS_LEGACY_WIFI_FILE);
+  WiFiStorage.remove(SETTINGS_LEGACY_MQTT_FILE);
+
+  if (!WiFiStorage.exists(SETTINGS_FILE)) return false;
+  return WiFiStorage.remove(SETTINGS_FILE);
+}
+
+/**
+ * Copies one field of a legacy file. The files hold every field at its full struct size followed by a
+ * one byte separator, so fields are at fixed offsets.
+ * @return The offset of the next field.
+ */
+static uint32_t legacy_field(const uint8_t *buf, uint32_t len, uint32_t offset, char *dst, uint32_t size) {
+  memset(dst, 0, size);
+  if (offset < len) memcpy(dst, &buf[offset], min(size - 1, len - offset));
+  return offset + size + 1;
+}
+
+/**
+ * Reads the settings from the two files of the firmware before the settings record.
+ * @return false if either file is missing.
+ */
+static bool read_legacy_settings(Settings &settings) {
+  // Largest is the MQTT file: host, port, username, password and name, each with its separator.
+  uint8_t buf[sizeof(MqttCreds) + sizeof(settings.name) + 5];
+  uint32_t len;
+
+  memset(&settings, 0, sizeof(settings));
+
+  if (!WiFiStorage.exists(SETTINGS_LEGACY_WIFI_FILE, &len) || len == 0) return false;
+  len = min(len, (uint32_t) sizeof(buf));
+  WiFiStorage.read(SETTINGS_LEGACY_WIFI_FILE, 0, buf, len);
+
+  uint32_t o = legacy_field(buf, len, 0, settings.wifi.ssid, sizeof(settings.wifi.ssid));
+  legacy_field(buf, len, o, settings.wifi.password, sizeof(settings.wifi.password));
+
+  if (!WiFiStorage.exists(SETTINGS_LEGACY_MQTT_FILE, &len) || len == 0) return false;
+  len = min(len, (uint32_t) sizeof(buf));
+  WiFiStorage.read(SETTINGS_LEGACY_MQTT_FILE, 0, buf, len);
+
+  o = legacy_field(buf, len, 0, settings.mqtt.host, sizeof(settings.mqtt.host));
+  o = legacy_field(buf, len, o, settings.mqtt.port, sizeof(settings.mqtt.port));
+  o = legacy_field(buf, len, o, settings.mqtt.username, sizeof(settings.mqtt.username));
+  o = legacy_field(buf, len, o, settings.mqtt.password, sizeof(settings.mqtt.password));
+  legacy_field(buf, len, o, settings.name, sizeof(settings.name));
+
+  return true;
+}
+
+/**
+ * Loads the settings record, migrating the legacy files to it if there is no record yet.
+ * @return false if there are no settings at all.
+ */
+bool load_settings(Settings &settings) {
+  if (read_settings(settings)) return true;
+  if (!read_legacy_settings(settings)) return false;
+
+  // Only drop the legacy files once the record is known to read back.
+  Settings check;
+  if (write_settings(settings) && read_settings(check) && memcmp(&check, &settings, sizeof(check)) == 0) {
+    WiFiStorage.remove(SETTINGS_LEGACY_WIFI_FILE);
+    WiFiStorage.remove(SETTINGS_LEGACY_MQTT_FILE);
+  }
+
+  return true;
+}
@@ -0,0 +1,63 @@
+/*
+ * Device settings
+ *
+ * Everything the AP portal collects, WiFi and MQTT credentials and the device name, kept on the NINA
+ * as one binary record: a header with a magic number, version and length, the Settings struct as is,
+ * and a CRC-32 over both. It is read in one transfer and checked before use, so a torn write or a
+ * record of another layout reads as no settings rather than as garbage.
+ *
+ * Firmware before the record kept the same fields in two separator-delimited files. When there is
+ * no record, load_settings() reads those once, writes the record and removes them.
+ */
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include "Arduino.h"
+#include <WiFiNINA.h>
+#include "../crc/crc.h"
+
+#define SETTINGS_FILE "/fs/settings"
+#define SETTINGS_MAGIC 0x54534346UL   // "TSCF"
+#define SETTINGS_VERSION 1
+
+// Files of the firmware before the settings record, read once to migrate.
+#define SETTINGS_LEGACY_WIFI_FILE "/fs/wifi_creds"
+#define SETTINGS_LEGACY_MQTT_FILE "/fs/mqtt_creds"
+
+struct WiFiCreds {
+  char ssid[32];
+  char password[32];
+};
+
+struct MqttCreds {
+  char host[128];
+  char port[8];
+  char username[32];
+  char password[32];
+};
+
+struct Settings {
+  WiFiCreds wifi;
+  MqttCreds mqtt;
+  char name[32];       // Name the user gave the device in the AP portal
+};
+
+struct SettingsHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t length;     // sizeof(Settings) when written
+};
+
+// The record as it is stored: header, settings, CRC-32 of both.
+struct SettingsRecord {
+  SettingsHeader header;
+  Settings settings;
+  uint32_t crc;
+};
+
+bool read_settings(Settings &settings);
+bool write_settings(const Settings &settings);
+bool erase_settings();
+bool load_settings(Settings &settings);
+
+#endif
@@ -0,0 +1,301 @@
+/*
+ * Telemetry
+ */
+#include "telemetry.h"
+
+TelemetryWriter::TelemetryWriter(char *buf, size_t size) : buf(buf), size(size) {
+  if (size > 0) buf[0] = 0;
+  else overflow = true;
+}
+
+/**
+ * Opens an object, as a member of the enclosing object when key is given or as an array element.
+ */
+void TelemetryWriter::begin_object(const char *key) {
+  put_key(key);
+  put('{');
+
+  if (depth + 1 < TELEMETRY_MAX_DEPTH) depth++;
+  else overflow = true;
+  has_members &= ~(1 << depth);
+}
+
+void TelemetryWriter::end_object() {
+  put('}');
+  if (depth > 0) depth--;
+}
+
+void TelemetryWriter::begin_array(const char *key) {
+  put_key(key);
+  put('[');
+
+  if (depth + 1 < TELEMETRY_MAX_DEPTH) depth++;
+  else overflow = true;
+  has_members &= ~(1 << depth);
+}
+
+void TelemetryWriter::end_array() {
+  put(']');
+  if (depth > 0) depth--;
+}
+
+void TelemetryWriter::add_int(const char *key, int32_t value) {
+  put_key(key);
+
+  if (value < 0) {
+    put('-');
+    put_uint(-(uint32_t) value, 1);
+  }
+  else {
+    put_uint(value, 1);
+  }
+}
+
+/**
+ * Adds a fixed-point number, e.g. 215 with 1 decimal as 21.5. Trailing zero decimals are dropped,
+ * the way ArduinoJson prints the equivalent float. TELEMETRY_NAN is written as null.
+ */
+void TelemetryWriter::add_fixed(const char *key, int32_t value, uint8_t decimals) {
+  put_key(key);
+
+  if (value == TELEMETRY_NAN) {
+    put("null");
+    return;
+  }
+
+  uint32_t scale = 1;
+  for (uint8_t i = 0; i < decimals; i++) scale *= 10;
+
+  uint32_t abs_value = value < 0 ? -(uint32_t) value : value;
+  uint32_t frac = abs_value % scale;
+
+  if (value < 0) put('-');
+  put_uint(abs_value / scale, 1);
+
+  if (frac == 0) return;
+
+  while (frac % 10 == 0) {
+    frac /= 10;
+    decimals--;
+  }
+
+  put('.');
+  put_uint(frac, decimals);
+}
+
+void TelemetryWriter::add_string(const char *key, const char *value) {
+  put_key(key);
+  put_quoted(value);
+}
+
+/**
+ * Adds an ISO 8601 timestamp, e.g. "2026-10-17T12:00:00-05:00".
+ * @param local Local time.
+ * @param offset_minutes Offset of local time from UTC.
+ */
+void TelemetryWriter::add_time(const char *key, time_t local, int offset_minutes) {
+  tmElements_t tm;
+  breakTime(local, tm);
+
+  put_key(key);
+  put('"');
+  put_uint(tmYearToCalendar(tm.Year), 1);
+  put('-');
+  put_uint(tm.Month, 2);
+  put('-');
+  put_uint(tm.Day, 2);
+  put('T');
+  put_uint(tm.Hour, 2);
+  put(':');
+  put_uint(tm.Minute, 2);
+  put(':');
+  put_uint(tm.Second, 2);
+
+  if (offset_minutes == 0) {
+    put('Z');
+  }
+  else {
+    put(offset_minutes > 0 ? '+' : '-');
+    put_uint(abs(offset_minutes) / 60, 2);
+    put(':');
+    put_uint(abs(offset_minutes) % 60, 2);
+  }
+
+  put('"');
+}
+
+void TelemetryWriter::put(char c) {
+  if (len + 1 >= size) {
+    overflow = true;
+    return;
+  }
+
+  buf[len++] = c;
+  buf[len] = 0;
+}
+
+void TelemetryWriter::put(const char *s) {
+  while (*s) put(*s++);
+}
+
+void TelemetryWriter::put_uint(uint32_t value, uint8_t min_digits) {
+  char digits[10];
+  uint8_t n = 0;
+
+  do {
+    digits[n++] = '0' + value % 10;
+    value /= 10;
+  } while (value > 0);
+
+  while (n < min_digits && n < sizeof(digits)) digits[n++] = '0';
+  while (n > 0) put(digits[--n]);
+}
+
+/**
+ * Writes the separator before a new member or element, and the key if there is one.
+ */
+void TelemetryWriter::put_key(const char *key) {
+  if (has_members & (1 << depth)) put(',');
+  has_members |= 1 << depth;
+
+  if (key) {
+    put_quoted(key);
+    put(':');
+  }
+}
+
+void TelemetryWriter::put_quoted(const char *s) {
+  put('"');
+
+  for (; *s; s++) {
+    switch (*s) {
+      case '"': put("\\\""); break;
+      case '\\': put("\\\\"); break;
+      case '\n': put("\\n"); break;
+      case '\r': put("\\r"); break;
+      case '\t': put("\\t"); break;
+      default: put(*s);
+    }
+  }
+
+  put('"');
+}
+
+static void write_sample(TelemetryWriter &json, const Sample &sample, LocalTimeFn local_time) {
+  int offset;
+  time_t local = local_time(sample.time, &offset);
+
+  json.add_time("time", local, offset);
+  json.add_fixed("temperature", sample.temperature, 1);
+  json.add_fixed("humidity", sample.humidity, 1);
+  json.add_fixed("illuminance", sample.illuminance, 1);
+}
+
+// Battery voltages are 0 until measured, published as null.
+static int32_t millivolts(uint16_t mv) {
+  return mv ? mv : TELEMETRY_NAN;
+}
+
+/**
+ * Writes the state payload for the buffered samples. The newest sample's values are at the top
+ * level, so the discovery value templates keep working, followed by the current sample interval. A
+ * batch adds a "samples" array holding every buffered reading.
+ * @param interval_s Time until the next sample, so consumers can tell expected gaps from lost samples.
+ * @return The payload length, 0 if it didn't fit the buffer.
+ */
+size_t serialize_state(char *buf, size_t size, const Sample *samples, int count, unsigned long interval_s,
+                       LocalTimeFn local_time) {
+  TelemetryWriter json(buf, size);
+
+  const Sample &latest = samples[count - 1];
+
+  json.begin_object();
+  write_sample(json, latest, local_time);
+  json.add_int("battery", latest.battery);
+  json.add_fixed("battery_voltage", millivolts(latest.battery_mv), 3);
+  json.add_fixed("battery_loaded_voltage", millivolts(latest.battery_loaded_mv), 3);
+  json.add_int("interval", interval_s);
+
+  if (count > 1) {
+    json.begin_array("samples");
+
+    for (int i = 0; i < count; i++) {
+      json.begin_object();
+      write_sample(json, samples[i], local_time);
+      json.end_object();
+    }
+
+    json.end_array();
+  }
+
+  json.end_object();
+
+  return json.overflowed() ? 0 : json.length();
+}
+
+static void put_le(uint8_t *p, uint32_t value, uint8_t bytes) {
+  for (uint8_t i = 0; i < bytes; i++) {
+    p[i] = value & 0xff;
+    value >>= 8;
+  }
+}
+
+static uint32_t get_le(const uint8_t *p, uint8_t bytes) {
+  uint32_t value = 0;
+  for (uint8_t i = bytes; i > 0; i--) value = (value << 8) | p[i - 1];
+  return value;
+}
+
+/**
+ * Writes the buffered samples as a packed state record, see TELEMETRY_PACKED_VERSION. Intervals
+ * beyond 65535s are capped.
+ * @return The record length, 0 if it didn't fit the buffer.
+ */
+size_t pack_state(uint8_t *buf, size_t size, const Sample *samples, int count, unsigned long interval_s) {
+  size_t len = TELEMETRY_PACKED_SIZE(count);
+  if (count < 1 || count > 255 || len > size) return 0;
+
+  buf[0] = TELEMETRY_PACKED_VERSION;
+  buf[1] = count;
+  put_le(&buf[2], interval_s < 0xffff ? interval_s : 0xffff, 2);
+  buf[4] = samples[count - 1].battery;
+  put_le(&buf[5], samples[count - 1].battery_mv, 2);
+  put_le(&buf[7], samples[count - 1].battery_loaded_mv, 2);
+
+  uint8_t *p = &buf[TELEMETRY_PACKED_HEADER];
+  for (int i = 0; i < count; i++, p += TELEMETRY_PACKED_SAMPLE) {
+    put_le(&p[0], samples[i].time, 4);
+    put_le(&p[4], (uint16_t) samples[i].temperature, 2);
+    put_le(&p[6], (uint16_t) samples[i].humidity, 2);
+    put_le(&p[8], (uint16_t) samples[i].illuminance, 2);
+  }
+
+  return len;
+}
+
+/**
+ * Reads a packed state record. Every sample gets the record's battery readings.
+ * @return The number of samples, -1 if the record is malformed, of an unknown version or has more
+ * than max_count samples.
+ */
+int unpack_state(const uint8_t *buf, size_t len, Sample *samples, int max_count, unsigned long *interval_s) {
+  if (len < TELEMETRY_PACKED_HEADER || buf[0] != TELEMETRY_PACKED_VERSION) return -1;
+
+  int count = buf[1];
+  if (count < 1 || count > max_count || len != (size_t) TELEMETRY_PACKED_SIZE(count)) return -1;
+
+  *interval_s = get_le(&buf[2], 2);
+
+  const uint8_t *p = &buf[TELEMETRY_PACKED_HEADER];
+  for (int i = 0; i < count; i++, p += TELEMETRY_PACKED_SAMPLE) {
+    samples[i].time = get_le(&p[0], 4);
+    samples[i].temperature = (int16_t) get_le(&p[4], 2);
+    samples[i].humidity = (int16_t) get_le(&p[6], 2);
+    samples[i].illuminance = (int16_t) get_le(&p[8], 2);
+    samples[i].battery = buf[4];
+    samples[i].battery_mv = get_le(&buf[5], 2);
+    samples[i].battery_loaded_mv = get_le(&buf[7], 2);
+  }
+
+  return count;
+}
@@ -0,0 +1,82 @@
+/*
+ * Telemetry
+ *
+ * Samples and the state payload they are published as. The payload is written by TelemetryWriter, a
+ * JSON writer on a caller supplied buffer that never touches the heap. Sensor values are kept as
+ * integer fixed-point and formatted without floating point.
+ *
+ * The packed state is the compact alternative to the JSON payload: a versioned little-endian record
+ * with epoch seconds and the fixed-point values as is. unpack_state() reverses it, so a bridge can
+ * republish the JSON payload.
+ */
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "Arduino.h"
+#include <TimeLib.h>
+
+#define TELEMETRY_NAN INT16_MIN   // Fixed-point value of a failed sensor read, published as null
+#define TELEMETRY_MAX_DEPTH 8     // Max nesting of objects and arrays
+
+// Packed state layout, version 1, little-endian:
+//   u8 version, u8 sample count, u16 interval in s, u8 battery percent, u16 battery mV at rest,
+//   u16 battery mV under load,
+//   then per sample, oldest first: u32 UTC epoch, i16 temperature, i16 humidity, i16 illuminance.
+#define TELEMETRY_PACKED_VERSION 1
+#define TELEMETRY_PACKED_HEADER 9
+#define TELEMETRY_PACKED_SAMPLE 10
+#define TELEMETRY_PACKED_SIZE(n) (TELEMETRY_PACKED_HEADER + (n) * TELEMETRY_PACKED_SAMPLE)
+
+struct Sample {
+  time_t time;
+  int16_t temperature;  // Tenths of a degree C
+  int16_t humidity;     // Tenths of a percent
+  int16_t illuminance;  // Tenths of a percent, calibrated
+  uint8_t battery;      // Percent
+  uint16_t battery_mv;        // At rest, 0 if not measured
+  uint16_t battery_loaded_mv; // Under the radio's load, 0 if not measured
+};
+
+// Converts a UTC time to local time and sets the UTC offset in minutes.
+typedef time_t (*LocalTimeFn)(time_t utc, int *offset_minutes);
+
+class TelemetryWriter {
+  public:
+    TelemetryWriter(char *buf, size_t size);
+
+    void begin_object(const char *key = NULL);
+    void end_object();
+    void begin_array(const char *key);
+    void end_array();
+
+    void add_int(const char *key, int32_t value);
+    void add_fixed(const char *key, int32_t value, uint8_t decimals);
+    void add_string(const char *key, const char *value);
+    void add_time(const char *key, time_t local, int offset_minutes);
+
+    const char *c_str() { return buf; }
+    size_t length() { return len; }
+    bool overflowed() { return overflow; }
+
+  private:
+    char *buf;
+    size_t size;
+    size_t len = 0;
+    bool overflow = false;
+    uint8_t depth = 0;
+    uint8_t has_members = 0; // Bit n is set once the container at depth n has a member
+
+    void put(char c);
+    void put(const char *s);
+    void put_uint(uint32_t value, uint8_t min_digits);
+    void put_key(const char *key);
+    void put_quoted(const char *s);
+};
+
+size_t serialize_state(char *buf, size_t size, const Sample *samples, int count, unsigned long interval_s,
+                       LocalTimeFn local_time);
+
+size_t pack_state(uint8_t *buf, size_t size, const Sample *samples, int count, unsigned long interval_s);
+int unpack_state(const uint8_t *buf, size_t len, Sample *samples, int max_count, unsigned long *interval_s);
+
+#endif
@@ -0,0 +1,92 @@
+/*
+ * Timekeeper
+ *
+ * The RTC is set once from NTP and then left free running. Later NTP samples are compared with the
+ * raw RTC over the longest baseline available, which keeps the whole-second quantization of both
+ * clocks out of the drift estimate as the baseline grows. Time is read as the latest NTP sample plus
+ * the drift-corrected RTC time elapsed since.
+ */
+#include "timekeeper.h"
+
+Timekeeper::Timekeeper(RTCZero &rtc, NTPClient &ntp) : rtc(rtc), ntp(ntp) {}
+
+/**
+ * Queries NTP and updates the drift estimate. Needs the radio to be connected.
+ * @return true if NTP answered.
+ */
+bool Timekeeper::sync() {
+  ntp.begin();
+  bool updated = ntp.forceUpdate();
+  uint32_t epoch = ntp.getEpochTime();
+  ntp.end();
+
+  if (!updated) {
+    return false;
+  }
+
+  if (!synced) {
+    rtc.begin();
+    rtc.setEpoch(epoch);
+
+    base_rtc = last_rtc = epoch;
+    base_epoch = last_epoch = epoch;
+    synced = true;
+    return true;
+  }
+
+  uint32_t rtc_epoch = rtc.getEpoch();
+
+  // If the prediction missed by more than its error bound the drift has changed (e.g. with
+  // temperature), so start a new baseline from the previous sample.
+  float residual = (int32_t) (now() - epoch);
+  if (fabs(residual) > error_bound() + CLOCK_RESOLUTION_S) {
+    base_rtc = last_rtc;
+    base_epoch = last_epoch;
+  }
+
+  int32_t baseline = epoch - base_epoch;
+  if (baseline > 0) {
+    // Both ends of the baseline are quantized to a second.
+    float quantization_ppm = 2 * CLOCK_RESOLUTION_S * 1e6 / baseline;
+
+    if (quantization_ppm < CLOCK_CRYSTAL_PPM) {
+      drift = ((int32_t) (rtc_epoch - base_rtc) - baseline) * 1e6 / baseline;
+      drift_uncertainty = min((float) (CLOCK_STABILITY_PPM + quantization_ppm), (float) CLOCK_CRYSTAL_PPM);
+    }
+  }
+
+  last_rtc = rtc_epoch;
+  last_epoch = epoch;
+  return true;
+}
+
+/**
+ * @return true if the estimated error of now() is above CLOCK_TOLERANCE_S, or NTP hasn't answered yet.
+ */
+bool Timekeeper::needs_sync() {
+  if (!synced) return true;
+
+  return (error_bound() > CLOCK_TOLERANCE_S) || (rtc.getEpoch() - last_rtc >= CLOCK_MAX_SYNC_INTERVAL_S);
+}
+
+/**
+ * @return The drift corrected time, or the raw RTC time if NTP hasn't answered yet.
+ */
+time_t Timekeeper::now() {
+  uint32_t rtc_epoch = rtc.getEpoch();
+
+  if (!synced) return rtc_epoch;
+
+  int32_t elapsed = rtc_epoch - last_rtc;
+  return last_epoch + elapsed - (int32_t) lroundf(elapsed * drift * 1e-6);
+}
+
+/**
+ * @return Estimated worst case error of now() in seconds.
+ */
+float Timekeeper::error_bound() {
+  if (!synced) return INFINITY;
+
+  int32_t elapsed = rtc.getEpoch() - last_rtc;
+  return CLOCK_RESOLUTION_S + elapsed * drift_uncertainty * 1e-6;
+}
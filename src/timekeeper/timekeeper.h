@@ -0,0 +1,46 @@
+/*
+ * Timekeeper
+ *
+ * Keeps wall clock time on the RTC between NTP queries. The RTC crystal's frequency error is measured
+ * against successive NTP samples and corrected in software, and a new NTP query is only due once the
+ * estimated error of the corrected time exceeds CLOCK_TOLERANCE_S.
+ */
+#ifndef TIMEKEEPER_H
+#define TIMEKEEPER_H
+
+#include "Arduino.h"
+#include <NTPClient.h>
+#include <RTCZero.h>
+
+#define CLOCK_TOLERANCE_S 2.0             // Max estimated error of the corrected time before NTP is due
+#define CLOCK_RESOLUTION_S 1.0            // RTC and NTPClient both count whole seconds
+#define CLOCK_CRYSTAL_PPM 50.0            // Drift assumed until it has been measured
+#define CLOCK_STABILITY_PPM 2.0           // Drift variation with temperature once measured
+#define CLOCK_MAX_SYNC_INTERVAL_S 604800  // Query NTP at least weekly
+
+class Timekeeper {
+  public:
+    Timekeeper(RTCZero &rtc, NTPClient &ntp);
+
+    bool sync();
+    bool needs_sync();
+    time_t now();
+
+    bool is_synced() { return synced; }
+    float drift_ppm() { return drift; }
+    float error_bound();
+
+  private:
+    RTCZero &rtc;
+    NTPClient &ntp;
+
+    bool synced = false;
+    uint32_t base_rtc = 0;     // RTC reading at the start of the drift measurement baseline
+    uint32_t base_epoch = 0;   // NTP time at the start of the baseline
+    uint32_t last_rtc = 0;     // RTC reading at the latest NTP sample
+    uint32_t last_epoch = 0;   // NTP time at the latest NTP sample
+    float drift = 0;           // RTC frequency error in ppm, positive when the RTC runs fast
+    float drift_uncertainty = CLOCK_CRYSTAL_PPM;
+};
+
+#endif
@@ -0,0 +1,81 @@
+/*
+ * Wake cycle trace
+ */
+
+#include "trace.h"
+
+#ifdef TRACE_ON
+
+WakeTrace wake_trace;
+
+static uint8_t put_u32(uint8_t *buf, uint32_t v) {
+  buf[0] = v & 0xFF;
+  buf[1] = (v >> 8) & 0xFF;
+  buf[2] = (v >> 16) & 0xFF;
+  buf[3] = (v >> 24) & 0xFF;
+  return 4;
+}
+
+void WakeTrace::cycle_begin() {
+  count = 0;
+  dropped = 0;
+  cycle_start_us = micros();
+}
+
+/**
+ * Starts timing a phase. Once the buffer is full, the phase is only counted as dropped.
+ * @return The slot holding the phase, to be passed to phase_end(), TRACE_MAX_EVENTS if dropped.
+ */
+uint8_t WakeTrace::phase_begin(uint8_t phase) {
+  if (count == TRACE_MAX_EVENTS) {
+    if (dropped < UINT8_MAX) dropped++;
+    return TRACE_MAX_EVENTS;
+  }
+
+  uint8_t slot = count++;
+  events[slot].phase = phase;
+  events[slot].start_us = micros() - cycle_start_us;
+  events[slot].duration_us = 0;
+  return slot;
+}
+
+void WakeTrace::phase_end(uint8_t slot) {
+  if (slot == TRACE_MAX_EVENTS) return;
+  events[slot].duration_us = micros() - cycle_start_us - events[slot].start_us;
+}
+
+/**
+ * Writes the binary record for the cycle (see trace_format.h) and advances the cycle counter.
+ * @param out The stream to write the record to.
+ */
+void WakeTrace::cycle_end(Print &out) {
+  uint8_t buf[TRACE_HEADER_SIZE];
+  uint8_t sum = 0;
+  uint8_t n = 0;
+
+  buf[n++] = TRACE_MAGIC_0;
+  buf[n++] = TRACE_MAGIC_1;
+  buf[n++] = TRACE_VERSION;
+  buf[n++] = count;
+  buf[n++] = dropped;
+  n += put_u32(&buf[n], cycle++);
+  n += put_u32(&buf[n], micros() - cycle_start_us);
+
+  for (uint8_t i = 2; i < n; i++) sum += buf[i];
+  out.write(buf, n);
+
+  for (uint8_t i = 0; i < count; i++) {
+    const Event &e = events[i];
+    uint8_t ev[TRACE_EVENT_SIZE];
+    ev[0] = e.phase;
+    put_u32(&ev[1], e.start_us);
+    put_u32(&ev[5], e.duration_us);
+
+    for (uint8_t j = 0; j < TRACE_EVENT_SIZE; j++) sum += ev[j];
+    out.write(ev, TRACE_EVENT_SIZE);
+  }
+
+  out.write(sum);
+}
+
+#endif
@@ -0,0 +1,69 @@
+/*
+ * Wake cycle trace
+ *
+ * Scoped phase markers that record micros() into a fixed buffer, dumped as one compact binary record
+ * per wake cycle. Phases past the end of the buffer are counted in the record as dropped. Everything
+ * compiles away unless TRACE_ON is defined.
+ */
+#ifndef TRACE_H
+#define TRACE_H
+
+// #define TRACE_ON    // Uncomment to record per-phase wake cycle timing
+
+#include "Arduino.h"
+#include "trace_format.h"
+
+#define TRACE_MAX_EVENTS 32    // Max phases recorded per wake cycle, 28 on a wake with 6 backfills
+#define TRACE_PORT Serial      // Where cycle records are written
+
+#ifdef TRACE_ON
+
+class WakeTrace {
+  public:
+    void cycle_begin();
+    void cycle_end(Print &out);
+    uint8_t phase_begin(uint8_t phase);
+    void phase_end(uint8_t slot);
+
+  private:
+    struct Event {
+      uint8_t phase;
+      uint32_t start_us;
+      uint32_t duration_us;
+    };
+
+    Event events[TRACE_MAX_EVENTS];
+    uint8_t count = 0;
+    uint8_t dropped = 0;
+    uint32_t cycle = 0;
+    uint32_t cycle_start_us = 0;
+};
+
+extern WakeTrace wake_trace;
+
+class TracePhase {
+  public:
+    explicit TracePhase(uint8_t phase) : slot(wake_trace.phase_begin(phase)) {}
+    ~TracePhase() { wake_trace.phase_end(slot); }
+
+  private:
+    uint8_t slot;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+// Times the rest of the enclosing scope as the given phase.
+#define TRACE_PHASE(phase) TracePhase TRACE_CONCAT(trace_phase_, __LINE__)(phase)
+#define TRACE_CYCLE_BEGIN() wake_trace.cycle_begin()
+#define TRACE_CYCLE_END() wake_trace.cycle_end(TRACE_PORT)
+
+#else
+
+#define TRACE_PHASE(phase)
+#define TRACE_CYCLE_BEGIN()
+#define TRACE_CYCLE_END()
+
+#endif
+
+#endif
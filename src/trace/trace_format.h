@@ -0,0 +1,50 @@
+/*
+ * Wake cycle trace: phase list and binary record layout.
+ *
+ * Shared by the firmware and the host-side analyzer, so it must stay free of Arduino headers.
+ */
+#ifndef TRACE_FORMAT_H
+#define TRACE_FORMAT_H
+
+// X(id, name) for every traced phase of a wake cycle. Append new phases at the end so recorded
+// traces keep decoding.
+#define TRACE_PHASES(X) \
+  X(PHASE_BATTERY, "battery") \
+  X(PHASE_MQTT_LOOP, "mqtt_loop") \
+  X(PHASE_SENSOR_PWR, "sensor_pwr") \
+  X(PHASE_WIFI_START, "wifi_start") \
+  X(PHASE_SENSOR_WARMUP, "sensor_warmup") \
+  X(PHASE_MQTT_CONNECT, "mqtt_connect") \
+  X(PHASE_CLOCK_SYNC, "clock_sync") \
+  X(PHASE_SENSORS, "sensors") \
+  X(PHASE_SERIALIZE, "serialize") \
+  X(PHASE_PUBLISH, "publish") \
+  X(PHASE_POST_PUBLISH, "post_publish") \
+  X(PHASE_WIFI_END, "wifi_end") \
+  X(PHASE_NINA_BOOT, "nina_boot") \
+  X(PHASE_BACKFILL, "backfill") \
+  X(PHASE_BACKLOG_SPILL, "backlog_spill")
+
+#define TRACE_PHASE_ENUM(id, name) id,
+
+enum TracePhaseId {
+  TRACE_PHASES(TRACE_PHASE_ENUM)
+  TRACE_PHASE_COUNT
+};
+
+#undef TRACE_PHASE_ENUM
+
+// One record is written per wake cycle, all integers little-endian:
+//
+//   u8  TRACE_MAGIC_0, u8 TRACE_MAGIC_1, u8 TRACE_VERSION, u8 event count,
+//   u8  events dropped because the cycle had more than fit the firmware's buffer
+//   u32 cycle number, u32 cycle duration (us)
+//   event count * { u8 phase, u32 start offset from cycle begin (us), u32 duration (us) }
+//   u8  checksum: sum of all bytes from the version byte onwards, mod 256
+#define TRACE_MAGIC_0 0xA5
+#define TRACE_MAGIC_1 'T'
+#define TRACE_VERSION 2
+#define TRACE_HEADER_SIZE 13
+#define TRACE_EVENT_SIZE 9
+
+#endif
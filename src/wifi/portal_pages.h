@@ -0,0 +1,322 @@
+/*
+ * AP portal pages, generated by sim/tools/portal_assets from src/wifi/portal/. Do not edit, run
+ * `make -C sim` after changing a page.
+ */
+#ifndef PORTAL_PAGES_H
+#define PORTAL_PAGES_H
+
+// form.html: 2380 B, 1977 B minified, 742 B gzip
+const uint8_t FORM_PAGE_GZIP[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xad, 0x94, 0xef, 0x6f, 0xd3, 0x3c,
+  0x10, 0xc7, 0xff, 0x15, 0x63, 0xde, 0x2e, 0xeb, 0x32, 0x18, 0xcf, 0x94, 0x26, 0x79, 0xc3, 0x40,
+  0x43, 0xe2, 0xc7, 0x50, 0x0b, 0x88, 0x57, 0x93, 0x13, 0x5f, 0x9b, 0x53, 0x1d, 0x3b, 0xd8, 0x4e,
+  0xbb, 0x6a, 0xe2, 0x7f, 0x7f, 0xce, 0x71, 0xb7, 0xa6, 0x0c, 0x09, 0xd0, 0xf6, 0x2a, 0x3e, 0x9f,
+  0x7d, 0xf7, 0xf1, 0xdd, 0x37, 0x97, 0x3f, 0xbb, 0xf8, 0xf4, 0x7a, 0xfe, 0xfd, 0xea, 0x0d, 0xbb,
+  0x9c, 0x7f, 0x78, 0x5f, 0xe6, 0x8d, 0x6f, 0x15, 0x53, 0x42, 0x2f, 0x0b, 0x0e, 0x9a, 0x93, 0x0d,
+  0x42, 0x96, 0xb9, 0x47, 0xaf, 0xa0, 0x9c, 0x5b, 0x4c, 0x66, 0xa0, 0x9d, 0xb1, 0xec, 0x1b, 0xbe,
+  0x45, 0xf6, 0xda, 0xe8, 0x05, 0x2e, 0x7b, 0x2b, 0x3c, 0x1a, 0x9d, 0x4f, 0xe2, 0xa1, 0xbc, 0x05,
+  0x2f, 0x98, 0x16, 0x2d, 0x14, 0x7c, 0x8d, 0xb0, 0xe9, 0x8c, 0xf5, 0x9c, 0xd5, 0x46, 0x7b, 0xd0,
+  0xbe, 0xe0, 0x1b, 0x94, 0xbe, 0x29, 0x24, 0xac, 0xb1, 0x86, 0x64, 0x30, 0x8e, 0x18, 0x6a, 0xf4,
+  0x28, 0x54, 0xe2, 0x6a, 0xa1, 0xa0, 0x48, 0x8f, 0x4f, 0xf8, 0x2e, 0x4a, 0xe3, 0x7d, 0x97, 0xc0,
+  0x8f, 0x1e, 0xd7, 0x05, 0xb7, 0xb0, 0xb0, 0xe0, 0x9a, 0x51, 0xa8, 0x57, 0xe1, 0x9c, 0xf3, 0x5b,
+  0x4a, 0x7a, 0xbc, 0x30, 0xb6, 0x4d, 0x40, 0x41, 0x4b, 0x9e, 0xdb, 0x56, 0xd8, 0x25, 0xea, 0x2c,
+  0x3d, 0xe9, 0x6e, 0x58, 0x7a, 0xd6, 0xdd, 0xfc, 0x3c, 0x70, 0xd3, 0xeb, 0x2a, 0x50, 0xb7, 0x43,
+  0xee, 0x2c, 0x3d, 0xa3, 0x43, 0x53, 0x89, 0xae, 0x53, 0x62, 0x9b, 0xa1, 0x56, 0xa8, 0x21, 0xa9,
+  0x94, 0xa9, 0x57, 0x53, 0x0f, 0x37, 0x3e, 0x11, 0x0a, 0x97, 0x3a, 0xb3, 0xb8, 0x6c, 0xfc, 0x2f,
+  0x51, 0x50, 0x77, 0xbd, 0xbf, 0xad, 0x8c, 0x95, 0x60, 0x13, 0x2b, 0x24, 0xf6, 0x2e, 0x7b, 0x49,
+  0xb1, 0xe2, 0x4e, 0xa6, 0x8d, 0x86, 0x69, 0x27, 0xa4, 0x44, 0xbd, 0x0c, 0xfb, 0xec, 0xfc, 0x01,
+  0xc7, 0xb1, 0xeb, 0xab, 0x16, 0xef, 0x70, 0x13, 0x05, 0x0b, 0x4f, 0x3c, 0x21, 0xc6, 0xdd, 0xbd,
+  0xb3, 0xf0, 0x80, 0x00, 0x98, 0x6c, 0xa0, 0x5a, 0x21, 0xe1, 0x74, 0x1d, 0x08, 0x2b, 0x74, 0x0d,
+  0x31, 0xc1, 0x38, 0x59, 0x25, 0xea, 0xd5, 0xd2, 0x9a, 0x5e, 0xcb, 0xa4, 0x36, 0xca, 0xd8, 0xec,
+  0xb9, 0x94, 0x72, 0xfa, 0x00, 0xf0, 0x10, 0x22, 0x53, 0xc2, 0xf9, 0xa4, 0x6e, 0x50, 0xc9, 0x3b,
+  0x0e, 0x6f, 0xba, 0xec, 0x94, 0x92, 0xfe, 0xac, 0x8c, 0xdc, 0xde, 0x3e, 0x88, 0xea, 0x3c, 0x80,
+  0xaa, 0x54, 0x0f, 0xd3, 0x05, 0x35, 0x22, 0x59, 0x88, 0x16, 0xd5, 0x36, 0xfb, 0x0a, 0x44, 0x25,
+  0xc5, 0xd1, 0x25, 0xa8, 0x35, 0x78, 0xac, 0xc5, 0x91, 0x13, 0xda, 0x25, 0x0e, 0x2c, 0x2e, 0xee,
+  0x9f, 0x33, 0x44, 0xcd, 0x27, 0xb1, 0x65, 0xf9, 0x24, 0x4a, 0x2b, 0x64, 0x21, 0x99, 0xa5, 0x23,
+  0x75, 0x91, 0x2b, 0x2d, 0xf3, 0xae, 0x7c, 0x43, 0x8d, 0xb6, 0x2c, 0x6a, 0x25, 0xb4, 0x7d, 0x2f,
+  0x36, 0x46, 0x1d, 0x34, 0x9b, 0x2c, 0x9f, 0x74, 0x65, 0x1e, 0x9e, 0xc3, 0x48, 0x2e, 0x8d, 0x91,
+  0x05, 0xbf, 0xfa, 0x34, 0x9b, 0x73, 0x26, 0xea, 0x70, 0xa8, 0xe0, 0x75, 0x03, 0xf5, 0xaa, 0x13,
+  0xce, 0x1d, 0x07, 0x59, 0x93, 0x5a, 0x24, 0xae, 0x59, 0x4d, 0x4f, 0x76, 0x05, 0x1f, 0x57, 0x81,
+  0x3c, 0x83, 0x28, 0x18, 0x6d, 0x06, 0x89, 0x2e, 0xf0, 0xda, 0x39, 0x94, 0xbc, 0xfc, 0x46, 0x4b,
+  0xf6, 0x11, 0xfc, 0xc6, 0xd8, 0x15, 0x9b, 0xcd, 0xde, 0x5d, 0x50, 0xca, 0xe1, 0x64, 0x99, 0x0f,
+  0xfd, 0x67, 0x7e, 0xdb, 0x91, 0xce, 0x83, 0x54, 0xf8, 0x4e, 0xf3, 0xfb, 0xdb, 0x0c, 0xe5, 0x81,
+  0xd9, 0x8a, 0x1b, 0x05, 0x7a, 0x49, 0xf2, 0xe7, 0x2f, 0x52, 0xce, 0x6c, 0x10, 0xb6, 0x05, 0xc9,
+  0x26, 0x54, 0x0b, 0x02, 0xfb, 0x17, 0xba, 0xf0, 0xa6, 0x1d, 0xdd, 0x15, 0x2d, 0x09, 0x4f, 0xfe,
+  0x9e, 0xac, 0xdb, 0x79, 0x0f, 0xe8, 0x86, 0xdb, 0x7b, 0xba, 0x68, 0x3e, 0x0d, 0x5d, 0xfb, 0xc3,
+  0xfb, 0xeb, 0xc6, 0x38, 0xda, 0xfe, 0xf0, 0x79, 0x3e, 0x67, 0x97, 0xb4, 0xfc, 0x73, 0xcd, 0xf6,
+  0xb7, 0x06, 0xaa, 0x91, 0x39, 0xa2, 0x4a, 0x4f, 0xff, 0x7b, 0x1c, 0xd6, 0x30, 0x89, 0x22, 0xd6,
+  0x15, 0x2d, 0x7f, 0x8f, 0xa5, 0xfb, 0xb6, 0x02, 0x7b, 0x00, 0x16, 0x27, 0xd8, 0x3d, 0x58, 0x34,
+  0x47, 0x60, 0xe7, 0x64, 0x21, 0xa9, 0x2d, 0x3d, 0x39, 0x7d, 0xc9, 0xd9, 0x5a, 0xd0, 0xbf, 0x41,
+  0xc6, 0xf9, 0xf9, 0x8b, 0xc7, 0xe1, 0xf6, 0xf4, 0xf3, 0xec, 0x70, 0xbf, 0xd0, 0xf2, 0x2f, 0xab,
+  0x38, 0xdc, 0xda, 0xc3, 0x46, 0xf3, 0x09, 0x7b, 0x1b, 0x95, 0x17, 0x8b, 0xf8, 0x4f, 0xca, 0xdb,
+  0xdf, 0x1e, 0x95, 0xf2, 0x09, 0x95, 0x17, 0xc7, 0xc4, 0x75, 0x48, 0xc6, 0xcb, 0x8b, 0x38, 0x33,
+  0x3e, 0x92, 0xf1, 0xe7, 0xba, 0x8d, 0x6f, 0x0e, 0x6c, 0x07, 0x1b, 0x8f, 0xa0, 0x8b, 0x09, 0x77,
+  0xbe, 0x38, 0xec, 0xf9, 0x2e, 0xff, 0x9d, 0x15, 0x09, 0xe2, 0xbc, 0xba, 0xd7, 0xce, 0x6c, 0xe7,
+  0xbc, 0x4f, 0x31, 0x09, 0x81, 0xe9, 0x13, 0x67, 0xe5, 0x24, 0x0c, 0xb3, 0xf2, 0x7f, 0x82, 0x1f,
+  0x3d, 0xfe, 0xb9, 0x07, 0x00, 0x00,
+};
+
+const uint8_t FORM_PAGE_IDENTITY[] PROGMEM = {
+  0x3c, 0x21, 0x44, 0x4f, 0x43, 0x54, 0x59, 0x50, 0x45, 0x20, 0x48, 0x54, 0x4d, 0x4c, 0x3e, 0x3c,
+  0x68, 0x74, 0x6d, 0x6c, 0x20, 0x6c, 0x61, 0x6e, 0x67, 0x3d, 0x22, 0x65, 0x6e, 0x22, 0x3e, 0x3c,
+  0x68, 0x65, 0x61, 0x64, 0x3e, 0x3c, 0x74, 0x69, 0x74, 0x6c, 0x65, 0x3e, 0x54, 0x72, 0x69, 0x2d,
+  0x53, 0x65, 0x6e, 0x73, 0x6f, 0x72, 0x20, 0x57, 0x69, 0x46, 0x69, 0x20, 0x43, 0x6f, 0x6e, 0x66,
+  0x69, 0x67, 0x75, 0x72, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x3c, 0x2f, 0x74, 0x69, 0x74, 0x6c, 0x65,
+  0x3e, 0x3c, 0x6d, 0x65, 0x74, 0x61, 0x20, 0x6e, 0x61, 0x6d, 0x65, 0x3d, 0x22, 0x76, 0x69, 0x65,
+  0x77, 0x70, 0x6f, 0x72, 0x74, 0x22, 0x20, 0x63, 0x6f, 0x6e, 0x74, 0x65, 0x6e, 0x74, 0x3d, 0x22,
+  0x77, 0x69, 0x64, 0x74, 0x68, 0x3d, 0x64, 0x65, 0x76, 0x69, 0x63, 0x65, 0x2d, 0x77, 0x69, 0x64,
+  0x74, 0x68, 0x2c, 0x20, 0x69, 0x6e, 0x69, 0x74, 0x69, 0x61, 0x6c, 0x2d, 0x73, 0x63, 0x61, 0x6c,
+  0x65, 0x3d, 0x31, 0x2e, 0x30, 0x22, 0x3e, 0x3c, 0x6d, 0x65, 0x74, 0x61, 0x20, 0x68, 0x74, 0x74,
+  0x70, 0x2d, 0x65, 0x71, 0x75, 0x69, 0x76, 0x3d, 0x22, 0x72, 0x65, 0x66, 0x72, 0x65, 0x73, 0x68,
+  0x22, 0x20, 0x63, 0x6f, 0x6e, 0x74, 0x65, 0x6e, 0x74, 0x3d, 0x22, 0x36, 0x30, 0x22, 0x3e, 0x3c,
+  0x73, 0x74, 0x79, 0x6c, 0x65, 0x3e, 0x2e, 0x66, 0x6f, 0x72, 0x6d, 0x2d, 0x65, 0x6c, 0x65, 0x6d,
+  0x65, 0x6e, 0x74, 0x7b, 0x6d, 0x61, 0x72, 0x67, 0x69, 0x6e, 0x3a, 0x31, 0x30, 0x70, 0x78, 0x20,
+  0x31, 0x35, 0x70, 0x78, 0x7d, 0x2e, 0x66, 0x6f, 0x72, 0x6d, 0x2d, 0x65, 0x6c, 0x65, 0x6d, 0x65,
+  0x6e, 0x74, 0x20, 0x6c, 0x61, 0x62, 0x65, 0x6c, 0x7b, 0x77, 0x69, 0x64, 0x74, 0x68, 0x3a, 0x31,
+  0x35, 0x30, 0x70, 0x78, 0x3b, 0x64, 0x69, 0x73, 0x70, 0x6c, 0x61, 0x79, 0x3a, 0x69, 0x6e, 0x6c,
+  0x69, 0x6e, 0x65, 0x2d, 0x62, 0x6c, 0x6f, 0x63, 0x6b, 0x3b, 0x74, 0x65, 0x78, 0x74, 0x2d, 0x61,
+  0x6c, 0x69, 0x67, 0x6e, 0x3a, 0x72, 0x69, 0x67, 0x68, 0x74, 0x7d, 0x2e, 0x66, 0x6f, 0x72, 0x6d,
+  0x2d, 0x65, 0x6c, 0x65, 0x6d, 0x65, 0x6e, 0x74, 0x20, 0x69, 0x6e, 0x70, 0x75, 0x74, 0x7b, 0x62,
+  0x6f, 0x72, 0x64, 0x65, 0x72, 0x2d, 0x72, 0x61, 0x64, 0x69, 0x75, 0x73, 0x3a, 0x34, 0x70, 0x78,
+  0x3b, 0x62, 0x6f, 0x72, 0x64, 0x65, 0x72, 0x3a, 0x6e, 0x6f, 0x6e, 0x65, 0x3b, 0x70, 0x61, 0x64,
+  0x64, 0x69, 0x6e, 0x67, 0x3a, 0x34, 0x70, 0x78, 0x20, 0x38, 0x70, 0x78, 0x7d, 0x2e, 0x66, 0x6f,
+  0x72, 0x6d, 0x2d, 0x65, 0x6c, 0x65, 0x6d, 0x65, 0x6e, 0x74, 0x20, 0x2e, 0x73, 0x75, 0x62, 0x6d,
+  0x69, 0x74, 0x7b, 0x6d, 0x61, 0x72, 0x67, 0x69, 0x6e, 0x2d, 0x6c, 0x65, 0x66, 0x74, 0x3a, 0x31,
+  0x35, 0x34, 0x70, 0x78, 0x3b, 0x70, 0x61, 0x64, 0x64, 0x69, 0x6e, 0x67, 0x3a, 0x35, 0x70, 0x78,
+  0x20, 0x31, 0x30, 0x70, 0x78, 0x3b, 0x2d, 0x77, 0x65, 0x62, 0x6b, 0x69, 0x74, 0x2d, 0x61, 0x70,
+  0x70, 0x65, 0x61, 0x72, 0x61, 0x6e, 0x63, 0x65, 0x3a, 0x6e, 0x6f, 0x6e, 0x65, 0x3b, 0x62, 0x6f,
+  0x72, 0x64, 0x65, 0x72, 0x3a, 0x6e, 0x6f, 0x6e, 0x65, 0x3b, 0x62, 0x61, 0x63, 0x6b, 0x67, 0x72,
+  0x6f, 0x75, 0x6e, 0x64, 0x2d, 0x63, 0x6f, 0x6c, 0x6f, 0x72, 0x3a, 0x23, 0x64, 0x64, 0x64, 0x3b,
+  0x62, 0x6f, 0x72, 0x64, 0x65, 0x72, 0x2d, 0x72, 0x61, 0x64, 0x69, 0x75, 0x73, 0x3a, 0x34, 0x70,
+  0x78, 0x7d, 0x2e, 0x66, 0x6f, 0x72, 0x6d, 0x2d, 0x65, 0x6c, 0x65, 0x6d, 0x65, 0x6e, 0x74, 0x3a,
+  0x6c, 0x61, 0x73, 0x74, 0x2d, 0x63, 0x68, 0x69, 0x6c, 0x64, 0x7b, 0x6d, 0x61, 0x72, 0x67, 0x69,
+  0x6e, 0x2d, 0x74, 0x6f, 0x70, 0x3a, 0x32, 0x30, 0x70, 0x78, 0x7d, 0x62, 0x6f, 0x64, 0x79, 0x7b,
+  0x62, 0x61, 0x63, 0x6b, 0x67, 0x72, 0x6f, 0x75, 0x6e, 0x64, 0x2d, 0x63, 0x6f, 0x6c, 0x6f, 0x72,
+  0x3a, 0x73, 0x74, 0x65, 0x65, 0x6c, 0x62, 0x6c, 0x75, 0x65, 0x3b, 0x66, 0x6f, 0x6e, 0x74, 0x2d,
+  0x66, 0x61, 0x6d, 0x69, 0x6c, 0x79, 0x3a, 0x56, 0x65, 0x72, 0x61, 0x6e, 0x64, 0x61, 0x2c, 0x48,
+  0x65, 0x6c, 0x76, 0x65, 0x74, 0x69, 0x63, 0x61, 0x2c, 0x73, 0x61, 0x6e, 0x73, 0x2d, 0x73, 0x65,
+  0x72, 0x69, 0x66, 0x3b, 0x70, 0x61, 0x64, 0x64, 0x69, 0x6e, 0x67, 0x3a, 0x32, 0x30, 0x70, 0x78,
+  0x7d, 0x3c, 0x2f, 0x73, 0x74, 0x79, 0x6c, 0x65, 0x3e, 0x3c, 0x2f, 0x68, 0x65, 0x61, 0x64, 0x3e,
+  0x3c, 0x62, 0x6f, 0x64, 0x79, 0x3e, 0x3c, 0x68, 0x31, 0x3e, 0x54, 0x72, 0x69, 0x2d, 0x53, 0x65,
+  0x6e, 0x73, 0x6f, 0x72, 0x3c, 0x2f, 0x68, 0x31, 0x3e, 0x3c, 0x70, 0x3e, 0x45, 0x6e, 0x74, 0x65,
+  0x72, 0x20, 0x64, 0x65, 0x76, 0x69, 0x63, 0x65, 0x20, 0x63, 0x6f, 0x6e, 0x66, 0x69, 0x67, 0x75,
+  0x72, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x62, 0x65, 0x6c, 0x6f, 0x77, 0x3a, 0x3c, 0x2f, 0x70,
+  0x3e, 0x3c, 0x66, 0x6f, 0x72, 0x6d, 0x20, 0x6d, 0x65, 0x74, 0x68, 0x6f, 0x64, 0x3d, 0x22, 0x50,
+  0x4f, 0x53, 0x54, 0x22, 0x20, 0x61, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x3d, 0x22, 0x63, 0x68, 0x65,
+  0x63, 0x6b, 0x70, 0x61, 0x73, 0x73, 0x2e, 0x68, 0x74, 0x6d, 0x6c, 0x22, 0x3e, 0x3c, 0x64, 0x69,
+  0x76, 0x20, 0x63, 0x6c, 0x61, 0x73, 0x73, 0x3d, 0x22, 0x66, 0x6f, 0x72, 0x6d, 0x2d, 0x65, 0x6c,
+  0x65, 0x6d, 0x65, 0x6e, 0x74, 0x22, 0x3e, 0x3c, 0x6c, 0x61, 0x62, 0x65, 0x6c, 0x20, 0x66, 0x6f,
+  0x72, 0x3d, 0x22, 0x77, 0x69, 0x66, 0x69, 0x5f, 0x73, 0x73, 0x69, 0x64, 0x22, 0x3e, 0x57, 0x69,
+  0x66, 0x69, 0x20, 0x4e, 0x65, 0x74, 0x77, 0x6f, 0x72, 0x6b, 0x20, 0x53, 0x53, 0x49, 0x44, 0x3a,
+  0x3c, 0x2f, 0x6c, 0x61, 0x62, 0x65, 0x6c, 0x3e, 0x3c, 0x69, 0x6e, 0x70, 0x75, 0x74, 0x20, 0x74,
+  0x79, 0x70, 0x65, 0x3d, 0x22, 0x74, 0x65, 0x78, 0x74, 0x22, 0x20, 0x6e, 0x61, 0x6d, 0x65, 0x3d,
+  0x22, 0x77, 0x69, 0x66, 0x69, 0x5f, 0x73, 0x73, 0x69, 0x64, 0x22, 0x20, 0x69, 0x64, 0x3d, 0x22,
+  0x77, 0x69, 0x66, 0x69, 0x5f, 0x73, 0x73, 0x69, 0x64, 0x22, 0x20, 0x6d, 0x61, 0x78, 0x6c, 0x65,
+  0x6e, 0x67, 0x74, 0x68, 0x3d, 0x22, 0x33, 0x31, 0x22, 0x20, 0x72, 0x65, 0x71, 0x75, 0x69, 0x72,
+  0x65, 0x64, 0x20, 0x2f, 0x3e, 0x3c, 0x2f, 0x64, 0x69, 0x76, 0x3e, 0x3c, 0x64, 0x69, 0x76, 0x20,
+  0x63, 0x6c, 0x61, 0x73, 0x73, 0x3d, 0x22, 0x66, 0x6f, 0x72, 0x6d, 0x2d, 0x65, 0x6c, 0x65, 0x6d,
+  0x65, 0x6e, 0x74, 0x22, 0x3e, 0x3c, 0x6c, 0x61, 0x62, 0x65, 0x6c, 0x20, 0x66, 0x6f, 0x72, 0x3d,
+  0x22, 0x77, 0x69, 0x66, 0x69, 0x5f, 0x70, 0x61, 0x73, 0x73, 0x22, 0x3e, 0x57, 0x69, 0x66, 0x69,
+  0x20, 0x50, 0x61, 0x73, 0x73, 0x77, 0x6f, 0x72, 0x64, 0x3a, 0x3c, 0x2f, 0x6c, 0x61, 0x62, 0x65,
+  0x6c, 0x3e, 0x3c, 0x69, 0x6e, 0x70, 0x75, 0x74, 0x20, 0x74, 0x79, 0x70, 0x65, 0x3d, 0x22, 0x70,
+  0x61, 0x73, 0x73, 0x77, 0x6f, 0x72, 0x64, 0x22, 0x20, 0x6e, 0x61, 0x6d, 0x65, 0x3d, 0x22, 0x77,
+  0x69, 0x66, 0x69, 0x5f, 0x70, 0x61, 0x73, 0x73, 0x22, 0x20, 0x69, 0x64, 0x3d, 0x22, 0x77, 0x69,
+  0x66, 0x69, 0x5f, 0x70, 0x61, 0x73, 0x73, 0x22, 0x20, 0x6d, 0x61, 0x78, 0x6c, 0x65, 0x6e, 0x67,
+  0x74, 0x68, 0x3d, 0x22, 0x33, 0x31, 0x22, 0x20, 0x72, 0x65, 0x71, 0x75, 0x69, 0x72, 0x65, 0x64,
+  0x20, 0x2f, 0x3e, 0x3c, 0x2f, 0x64, 0x69, 0x76, 0x3e, 0x3c, 0x64, 0x69, 0x76, 0x20, 0x63, 0x6c,
+  0x61, 0x73, 0x73, 0x3d, 0x22, 0x66, 0x6f, 0x72, 0x6d, 0x2d, 0x65, 0x6c, 0x65, 0x6d, 0x65, 0x6e,
+  0x74, 0x22, 0x3e, 0x3c, 0x6c, 0x61, 0x62, 0x65, 0x6c, 0x20, 0x66, 0x6f, 0x72, 0x3d, 0x22, 0x6d,
+  0x71, 0x74, 0x74, 0x5f, 0x68, 0x6f, 0x73, 0x74, 0x22, 0x3e, 0x4d, 0x51, 0x54, 0x54, 0x20, 0x48,
+  0x6f, 0x73, 0x74, 0x3a, 0x3c, 0x2f, 0x6c, 0x61, 0x62, 0x65, 0x6c, 0x3e, 0x3c, 0x69, 0x6e, 0x70,
+  0x75, 0x74, 0x20, 0x74, 0x79, 0x70, 0x65, 0x3d, 0x22, 0x74, 0x65, 0x78, 0x74, 0x22, 0x20, 0x6e,
+  0x61, 0x6d, 0x65, 0x3d, 0x22, 0x6d, 0x71, 0x74, 0x74, 0x5f, 0x68, 0x6f, 0x73, 0x74, 0x22, 0x20,
+  0x69, 0x64, 0x3d, 0x22, 0x6d, 0x71, 0x74, 0x74, 0x5f, 0x68, 0x6f, 0x73, 0x74, 0x22, 0x20, 0x6d,
+  0x61, 0x78, 0x6c, 0x65, 0x6e, 0x67, 0x74, 0x68, 0x3d, 0x22, 0x31, 0x32, 0x37, 0x22, 0x20, 0x72,
+  0x65, 0x71, 0x75, 0x69, 0x72, 0x65, 0x64, 0x20, 0x2f, 0x3e, 0x3c, 0x2f, 0x64, 0x69, 0x76, 0x3e,
+  0x3c, 0x64, 0x69, 0x76, 0x20, 0x63, 0x6c, 0x61, 0x73, 0x73, 0x3d, 0x22, 0x66, 0x6f, 0x72, 0x6d,
+  0x2d, 0x65, 0x6c, 0x65, 0x6d, 0x65, 0x6e, 0x74, 0x22, 0x3e, 0x3c, 0x6c, 0x61, 0x62, 0x65, 0x6c,
+  0x20, 0x66, 0x6f, 0x72, 0x3d, 0x22, 0x6d, 0x71, 0x74, 0x74, 0x5f, 0x70, 0x6f, 0x72, 0x74, 0x22,
+  0x3e, 0x4d, 0x51, 0x54, 0x54, 0x20, 0x50, 0x6f, 0x72, 0x74, 0x3a, 0x3c, 0x2f, 0x6c, 0x61, 0x62,
+  0x65, 0x6c, 0x3e, 0x3c, 0x69, 0x6e, 0x70, 0x75, 0x74, 0x20, 0x74, 0x79, 0x70, 0x65, 0x3d, 0x22,
+  0x6e, 0x75, 0x6d, 0x62, 0x65, 0x72, 0x22, 0x20, 0x6e, 0x61, 0x6d, 0x65, 0x3d, 0x22, 0x6d, 0x71,
+  0x74, 0x74, 0x5f, 0x70, 0x6f, 0x72, 0x74, 0x22, 0x20, 0x69, 0x64, 0x3d, 0x22, 0x6d, 0x71, 0x74,
+  0x74, 0x5f, 0x70, 0x6f, 0x72, 0x74, 0x22, 0x20, 0x6d, 0x61, 0x78, 0x6c, 0x65, 0x6e, 0x67, 0x74,
+  0x68, 0x3d, 0x22, 0x38, 0x22, 0x20, 0x6d, 0x69, 0x6e, 0x3d, 0x22, 0x31, 0x30, 0x32, 0x34, 0x22,
+  0x20, 0x76, 0x61, 0x6c, 0x75, 0x65, 0x3d, 0x22, 0x31, 0x38, 0x38, 0x33, 0x22, 0x20, 0x72, 0x65,
+  0x71, 0x75, 0x69, 0x72, 0x65, 0x64, 0x20, 0x2f, 0x3e, 0x3c, 0x2f, 0x64, 0x69, 0x76, 0x3e, 0x3c,
+  0x64, 0x69, 0x76, 0x20, 0x63, 0x6c, 0x61, 0x73, 0x73, 0x3d, 0x22, 0x66, 0x6f, 0x72, 0x6d, 0x2d,
+  0x65, 0x6c, 0x65, 0x6d, 0x65, 0x6e, 0x74, 0x22, 0x3e, 0x3c, 0x6c, 0x61, 0x62, 0x65, 0x6c, 0x20,
+  0x66, 0x6f, 0x72, 0x3d, 0x22, 0x6d, 0x71, 0x74, 0x74, 0x5f, 0x75, 0x73, 0x65, 0x72, 0x22, 0x3e,
+  0x4d, 0x51, 0x54, 0x54, 0x20, 0x55, 0x73, 0x65, 0x72, 0x3a, 0x3c, 0x2f, 0x6c, 0x61, 0x62, 0x65,
+  0x6c, 0x3e, 0x3c, 0x69, 0x6e, 0x70, 0x75, 0x74, 0x20, 0x74, 0x79, 0x70, 0x65, 0x3d, 0x22, 0x74,
+  0x65, 0x78, 0x74, 0x22, 0x20, 0x6e, 0x61, 0x6d, 0x65, 0x3d, 0x22, 0x6d, 0x71, 0x74, 0x74, 0x5f,
+  0x75, 0x73, 0x65, 0x72, 0x22, 0x20, 0x69, 0x64, 0x3d, 0x22, 0x6d, 0x71, 0x74, 0x74, 0x5f, 0x75,
+  0x73, 0x65, 0x72, 0x22, 0x20, 0x6d, 0x61, 0x78, 0x6c, 0x65, 0x6e, 0x67, 0x74, 0x68, 0x3d, 0x22,
+  0x33, 0x31, 0x22, 0x20, 0x72, 0x65, 0x71, 0x75, 0x69, 0x72, 0x65, 0x64, 0x20, 0x2f, 0x3e, 0x3c,
+  0x2f, 0x64, 0x69, 0x76, 0x3e, 0x3c, 0x64, 0x69, 0x76, 0x20, 0x63, 0x6c, 0x61, 0x73, 0x73, 0x3d,
+  0x22, 0x66, 0x6f, 0x72, 0x6d, 0x2d, 0x65, 0x6c, 0x65, 0x6d, 0x65, 0x6e, 0x74, 0x22, 0x3e, 0x3c,
+  0x6c, 0x61, 0x62, 0x65, 0x6c, 0x20, 0x66, 0x6f, 0x72, 0x3d, 0x22, 0x6d, 0x71, 0x74, 0x74, 0x5f,
+  0x70, 0x61, 0x73, 0x73, 0x22, 0x3e, 0x4d, 0x51, 0x54, 0x54, 0x20, 0x50, 0x61, 0x73, 0x73, 0x77,
+  0x6f, 0x72, 0x64, 0x3a, 0x3c, 0x2f, 0x6c, 0x61, 0x62, 0x65, 0x6c, 0x3e, 0x3c, 0x69, 0x6e, 0x70,
+  0x75, 0x74, 0x20, 0x74, 0x79, 0x70, 0x65, 0x3d, 0x22, 0x70, 0x61, 0x73, 0x73, 0x77, 0x6f, 0x72,
+  0x64, 0x22, 0x20, 0x6e, 0x61, 0x6d, 0x65, 0x3d, 0x22, 0x6d, 0x71, 0x74, 0x74, 0x5f, 0x70, 0x61,
+  0x73, 0x73, 0x22, 0x20, 0x69, 0x64, 0x3d, 0x22, 0x6d, 0x71, 0x74, 0x74, 0x5f, 0x70, 0x61, 0x73,
+  0x73, 0x22, 0x20, 0x6d, 0x61, 0x78, 0x6c, 0x65, 0x6e, 0x67, 0x74, 0x68, 0x3d, 0x22, 0x33, 0x31,
+  0x22, 0x20, 0x72, 0x65, 0x71, 0x75, 0x69, 0x72, 0x65, 0x64, 0x20, 0x2f, 0x3e, 0x3c, 0x2f, 0x64,
+  0x69, 0x76, 0x3e, 0x3c, 0x64, 0x69, 0x76, 0x20, 0x63, 0x6c, 0x61, 0x73, 0x73, 0x3d, 0x22, 0x66,
+  0x6f, 0x72, 0x6d, 0x2d, 0x65, 0x6c, 0x65, 0x6d, 0x65, 0x6e, 0x74, 0x22, 0x3e, 0x3c, 0x6c, 0x61,
+  0x62, 0x65, 0x6c, 0x20, 0x66, 0x6f, 0x72, 0x3d, 0x22, 0x64, 0x65, 0x76, 0x69, 0x63, 0x65, 0x5f,
+  0x6e, 0x61, 0x6d, 0x65, 0x22, 0x3e, 0x44, 0x65, 0x76, 0x69, 0x63, 0x65, 0x20, 0x4e, 0x61, 0x6d,
+  0x65, 0x3a, 0x3c, 0x2f, 0x6c, 0x61, 0x62, 0x65, 0x6c, 0x3e, 0x3c, 0x69, 0x6e, 0x70, 0x75, 0x74,
+  0x20, 0x74, 0x79, 0x70, 0x65, 0x3d, 0x22, 0x74, 0x65, 0x78, 0x74, 0x22, 0x20, 0x6e, 0x61, 0x6d,
+  0x65, 0x3d, 0x22, 0x64, 0x65, 0x76, 0x69, 0x63, 0x65, 0x5f, 0x6e, 0x61, 0x6d, 0x65, 0x22, 0x20,
+  0x69, 0x64, 0x3d, 0x22, 0x64, 0x65, 0x76, 0x69, 0x63, 0x65, 0x5f, 0x6e, 0x61, 0x6d, 0x65, 0x22,
+  0x20, 0x6d, 0x61, 0x78, 0x6c, 0x65, 0x6e, 0x67, 0x74, 0x68, 0x3d, 0x22, 0x33, 0x31, 0x22, 0x20,
+  0x72, 0x65, 0x71, 0x75, 0x69, 0x72, 0x65, 0x64, 0x20, 0x2f, 0x3e, 0x3c, 0x2f, 0x64, 0x69, 0x76,
+  0x3e, 0x3c, 0x64, 0x69, 0x76, 0x20, 0x63, 0x6c, 0x61, 0x73, 0x73, 0x3d, 0x22, 0x66, 0x6f, 0x72,
+  0x6d, 0x2d, 0x65, 0x6c, 0x65, 0x6d, 0x65, 0x6e, 0x74, 0x22, 0x3e, 0x3c, 0x69, 0x6e, 0x70, 0x75,
+  0x74, 0x20, 0x63, 0x6c, 0x61, 0x73, 0x73, 0x3d, 0x22, 0x73, 0x75, 0x62, 0x6d, 0x69, 0x74, 0x22,
+  0x20, 0x74, 0x79, 0x70, 0x65, 0x3d, 0x22, 0x73, 0x75, 0x62, 0x6d, 0x69, 0x74, 0x22, 0x20, 0x6e,
+  0x61, 0x6d, 0x65, 0x3d, 0x22, 0x61, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x22, 0x20, 0x76, 0x61, 0x6c,
+  0x75, 0x65, 0x3d, 0x22, 0x53, 0x75, 0x62, 0x6d, 0x69, 0x74, 0x22, 0x20, 0x2f, 0x3e, 0x3c, 0x2f,
+  0x64, 0x69, 0x76, 0x3e, 0x3c, 0x2f, 0x66, 0x6f, 0x72, 0x6d, 0x3e, 0x3c, 0x2f, 0x62, 0x6f, 0x64,
+  0x79, 0x3e, 0x3c, 0x2f, 0x68, 0x74, 0x6d, 0x6c, 0x3e,
+};
+
+const PortalAsset FORM_PAGE = {
+  "text/html; charset=utf-8",
+  FORM_PAGE_GZIP, 742,
+  FORM_PAGE_IDENTITY, 1977,
+  0xfe3d1f82
+};
+
+// gen404.html: 248 B, 217 B minified, 181 B gzip
+const uint8_t GEN404_PAGE_GZIP[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x4d, 0x8f, 0xc1, 0x0e, 0x82, 0x30,
+  0x10, 0x44, 0x7f, 0xa5, 0xf6, 0x2c, 0xa2, 0xf7, 0x96, 0x0b, 0x6a, 0x3c, 0x68, 0x34, 0x91, 0xc4,
+  0x78, 0xac, 0xb0, 0xd0, 0x4d, 0xca, 0x16, 0xcb, 0x02, 0xf1, 0xef, 0x05, 0xe1, 0xe0, 0x69, 0xf2,
+  0x92, 0xc9, 0xcb, 0x8c, 0x5a, 0xed, 0xaf, 0x69, 0xf6, 0xbc, 0x1d, 0xc4, 0x29, 0xbb, 0x9c, 0x13,
+  0x65, 0xb9, 0x76, 0xc2, 0x19, 0xaa, 0xb4, 0x04, 0x92, 0x23, 0x83, 0x29, 0x12, 0xc5, 0xc8, 0x0e,
+  0x92, 0x2c, 0x60, 0x74, 0x07, 0x6a, 0x7d, 0x10, 0x0f, 0x3c, 0xa2, 0x48, 0x3d, 0x95, 0x58, 0x75,
+  0xc1, 0x30, 0x7a, 0x52, 0xf1, 0x5c, 0x52, 0x35, 0xb0, 0x11, 0x64, 0x6a, 0xd0, 0xb2, 0x47, 0x18,
+  0x1a, 0x1f, 0x58, 0x8a, 0xdc, 0x13, 0x03, 0xb1, 0x96, 0x03, 0x16, 0x6c, 0x75, 0x01, 0x3d, 0xe6,
+  0x10, 0xfd, 0x60, 0x2d, 0x90, 0x90, 0xd1, 0xb8, 0xa8, 0xcd, 0x8d, 0x03, 0xbd, 0xdb, 0x6c, 0xe5,
+  0x62, 0xb1, 0xcc, 0x4d, 0x04, 0xef, 0x0e, 0x7b, 0x2d, 0x03, 0x94, 0x01, 0x5a, 0xfb, 0xa7, 0x9a,
+  0x6a, 0xf1, 0xbc, 0xef, 0xe5, 0x8b, 0xcf, 0x08, 0x4b, 0x4c, 0x1f, 0x92, 0x2f, 0x95, 0x9b, 0x3c,
+  0xe5, 0xd9, 0x00, 0x00, 0x00,
+};
+
+const uint8_t GEN404_PAGE_IDENTITY[] PROGMEM = {
+  0x3c, 0x21, 0x44, 0x4f, 0x43, 0x54, 0x59, 0x50, 0x45, 0x20, 0x48, 0x54, 0x4d, 0x4c, 0x3e, 0x3c,
+  0x68, 0x74, 0x6d, 0x6c, 0x20, 0x6c, 0x61, 0x6e, 0x67, 0x3d, 0x22, 0x65, 0x6e, 0x22, 0x3e, 0x3c,
+  0x68, 0x65, 0x61, 0x64, 0x3e, 0x3c, 0x74, 0x69, 0x74, 0x6c, 0x65, 0x3e, 0x54, 0x72, 0x69, 0x2d,
+  0x53, 0x65, 0x6e, 0x73, 0x6f, 0x72, 0x20, 0x57, 0x69, 0x46, 0x69, 0x20, 0x43, 0x6f, 0x6e, 0x66,
+  0x69, 0x67, 0x75, 0x72, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x3c, 0x2f, 0x74, 0x69, 0x74, 0x6c, 0x65,
+  0x3e, 0x3c, 0x6d, 0x65, 0x74, 0x61, 0x20, 0x6e, 0x61, 0x6d, 0x65, 0x3d, 0x22, 0x76, 0x69, 0x65,
+  0x77, 0x70, 0x6f, 0x72, 0x74, 0x22, 0x20, 0x63, 0x6f, 0x6e, 0x74, 0x65, 0x6e, 0x74, 0x3d, 0x22,
+  0x77, 0x69, 0x64, 0x74, 0x68, 0x3d, 0x64, 0x65, 0x76, 0x69, 0x63, 0x65, 0x2d, 0x77, 0x69, 0x64,
+  0x74, 0x68, 0x2c, 0x20, 0x69, 0x6e, 0x69, 0x74, 0x69, 0x61, 0x6c, 0x2d, 0x73, 0x63, 0x61, 0x6c,
+  0x65, 0x3d, 0x31, 0x2e, 0x30, 0x22, 0x3e, 0x3c, 0x6d, 0x65, 0x74, 0x61, 0x20, 0x68, 0x74, 0x74,
+  0x70, 0x2d, 0x65, 0x71, 0x75, 0x69, 0x76, 0x3d, 0x22, 0x72, 0x65, 0x66, 0x72, 0x65, 0x73, 0x68,
+  0x22, 0x20, 0x63, 0x6f, 0x6e, 0x74, 0x65, 0x6e, 0x74, 0x3d, 0x22, 0x30, 0x22, 0x3e, 0x3c, 0x2f,
+  0x68, 0x65, 0x61, 0x64, 0x3e, 0x3c, 0x62, 0x6f, 0x64, 0x79, 0x3e, 0x3c, 0x2f, 0x62, 0x6f, 0x64,
+  0x79, 0x3e, 0x3c, 0x2f, 0x68, 0x74, 0x6d, 0x6c, 0x3e,
+};
+
+const PortalAsset GEN404_PAGE = {
+  "text/html; charset=utf-8",
+  GEN404_PAGE_GZIP, 181,
+  GEN404_PAGE_IDENTITY, 217,
+  0xe53c9b95
+};
+
+// success.html: 877 B, 732 B minified, 454 B gzip
+const uint8_t SUCCESS_PAGE_GZIP[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x65, 0x92, 0x41, 0x6f, 0xdb, 0x30,
+  0x0c, 0x85, 0xff, 0x8a, 0xea, 0x5d, 0xa3, 0xa4, 0x1e, 0x96, 0x61, 0x70, 0x6c, 0x5f, 0xba, 0x0d,
+  0x3d, 0x6c, 0xd8, 0x80, 0x06, 0x1d, 0x7a, 0x94, 0x2d, 0xda, 0x26, 0x22, 0x53, 0x9a, 0x44, 0xc7,
+  0x09, 0x82, 0xfe, 0xf7, 0xc9, 0xf1, 0x32, 0xa4, 0xcb, 0x91, 0x14, 0xf5, 0xde, 0x47, 0xf0, 0xe5,
+  0x77, 0x9f, 0x7f, 0x3c, 0x6c, 0x5f, 0x7e, 0x7e, 0x11, 0x8f, 0xdb, 0xef, 0xdf, 0xca, 0xbc, 0xe3,
+  0xde, 0x08, 0xa3, 0xa8, 0x2d, 0x12, 0xa0, 0x24, 0xd6, 0xa0, 0x74, 0x99, 0x33, 0xb2, 0x81, 0x72,
+  0xeb, 0x51, 0x3e, 0x01, 0x05, 0xeb, 0xc5, 0x2f, 0xfc, 0x8a, 0xe2, 0xc1, 0x52, 0x83, 0xed, 0xe0,
+  0x15, 0xa3, 0xa5, 0x7c, 0x35, 0x0f, 0xe5, 0x3d, 0xb0, 0x12, 0xa4, 0x7a, 0x28, 0x92, 0x3d, 0xc2,
+  0xe8, 0xac, 0xe7, 0x44, 0xd4, 0x96, 0x18, 0x88, 0x8b, 0x64, 0x44, 0xcd, 0x5d, 0xa1, 0x61, 0x8f,
+  0x35, 0xc8, 0x73, 0xb1, 0x10, 0x48, 0xc8, 0xa8, 0x8c, 0x0c, 0xb5, 0x32, 0x50, 0xa4, 0xcb, 0xfb,
+  0xe4, 0xaf, 0x4a, 0xc7, 0xec, 0x24, 0xfc, 0x1e, 0x70, 0x5f, 0x24, 0x1e, 0x1a, 0x0f, 0xa1, 0xbb,
+  0x92, 0xfa, 0x38, 0xcd, 0x05, 0x3e, 0x46, 0xd3, 0x65, 0x63, 0x7d, 0x2f, 0xc1, 0x40, 0x1f, 0x5f,
+  0x4e, 0xbd, 0xf2, 0x2d, 0x52, 0x96, 0xde, 0xbb, 0x83, 0x48, 0xd7, 0xee, 0xf0, 0xfa, 0xe6, 0x39,
+  0x6e, 0x57, 0x81, 0x39, 0x9d, 0xbd, 0xb3, 0x74, 0x1d, 0x87, 0x36, 0x1a, 0x83, 0x33, 0xea, 0x98,
+  0x21, 0x19, 0x24, 0x90, 0x95, 0xb1, 0xf5, 0x6e, 0xc3, 0x70, 0x60, 0xa9, 0x0c, 0xb6, 0x94, 0x79,
+  0x6c, 0x3b, 0xfe, 0x4f, 0x05, 0xc9, 0x0d, 0x7c, 0xaa, 0xac, 0xd7, 0xe0, 0xa5, 0x57, 0x1a, 0x87,
+  0x90, 0x7d, 0x88, 0x5a, 0x73, 0x27, 0x23, 0x4b, 0xb0, 0x71, 0x4a, 0x6b, 0xa4, 0x76, 0xea, 0x8b,
+  0x4f, 0x37, 0x1c, 0xcb, 0x30, 0x54, 0x3d, 0x5e, 0x70, 0xa5, 0x81, 0x86, 0x23, 0xcf, 0xa4, 0x71,
+  0xf9, 0xb7, 0x9e, 0x16, 0x98, 0x00, 0xe5, 0x08, 0xd5, 0x0e, 0x23, 0x8e, 0x73, 0xa0, 0xbc, 0xa2,
+  0x1a, 0x66, 0x83, 0x6b, 0xb3, 0x4a, 0xd5, 0xbb, 0xd6, 0xdb, 0x81, 0xb4, 0xac, 0xad, 0xb1, 0x3e,
+  0x7b, 0xa7, 0xb5, 0xde, 0xdc, 0x00, 0xbe, 0x85, 0xc8, 0x8c, 0x0a, 0x2c, 0xeb, 0x0e, 0x8d, 0xbe,
+  0x70, 0xb0, 0x75, 0xd9, 0xfb, 0x68, 0xfa, 0x5a, 0x59, 0x7d, 0x3c, 0xdd, 0xa8, 0x06, 0x06, 0x30,
+  0x95, 0x19, 0x60, 0xd3, 0xc4, 0x43, 0xc8, 0x46, 0xf5, 0x68, 0x8e, 0xd9, 0x33, 0x44, 0x2a, 0xad,
+  0x16, 0x8f, 0x60, 0xf6, 0xc0, 0x58, 0xab, 0x45, 0x50, 0x14, 0x64, 0x00, 0x8f, 0xcd, 0xbf, 0x75,
+  0xce, 0xaa, 0xf9, 0x6a, 0x3e, 0x59, 0xbe, 0x9a, 0xa3, 0x35, 0xb9, 0xc4, 0x98, 0xa5, 0xd7, 0xe9,
+  0x7a, 0x02, 0x1e, 0x5c, 0x8c, 0x57, 0xef, 0x0c, 0x30, 0xdc, 0xc5, 0xd1, 0xb4, 0xcc, 0x5d, 0xf9,
+  0x62, 0x07, 0xd1, 0xab, 0xa3, 0x20, 0x3b, 0x8a, 0xda, 0xd8, 0x00, 0x82, 0x3b, 0x0c, 0x62, 0x44,
+  0xd2, 0x76, 0x5c, 0xe6, 0x2b, 0x17, 0x45, 0x67, 0xb9, 0xd5, 0x14, 0xe3, 0xf2, 0x0f, 0x50, 0x1e,
+  0x9d, 0x72, 0xdc, 0x02, 0x00, 0x00,
+};
+
+const uint8_t SUCCESS_PAGE_IDENTITY[] PROGMEM = {
+  0x3c, 0x21, 0x44, 0x4f, 0x43, 0x54, 0x59, 0x50, 0x45, 0x20, 0x48, 0x54, 0x4d, 0x4c, 0x3e, 0x3c,
+  0x68, 0x74, 0x6d, 0x6c, 0x20, 0x6c, 0x61, 0x6e, 0x67, 0x3d, 0x22, 0x65, 0x6e, 0x22, 0x3e, 0x3c,
+  0x68, 0x65, 0x61, 0x64, 0x3e, 0x3c, 0x74, 0x69, 0x74, 0x6c, 0x65, 0x3e, 0x54, 0x72, 0x69, 0x2d,
+  0x53, 0x65, 0x6e, 0x73, 0x6f, 0x72, 0x20, 0x57, 0x69, 0x46, 0x69, 0x20, 0x43, 0x6f, 0x6e, 0x66,
+  0x69, 0x67, 0x75, 0x72, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x3c, 0x2f, 0x74, 0x69, 0x74, 0x6c, 0x65,
+  0x3e, 0x3c, 0x6d, 0x65, 0x74, 0x61, 0x20, 0x6e, 0x61, 0x6d, 0x65, 0x3d, 0x22, 0x76, 0x69, 0x65,
+  0x77, 0x70, 0x6f, 0x72, 0x74, 0x22, 0x20, 0x63, 0x6f, 0x6e, 0x74, 0x65, 0x6e, 0x74, 0x3d, 0x22,
+  0x77, 0x69, 0x64, 0x74, 0x68, 0x3d, 0x64, 0x65, 0x76, 0x69, 0x63, 0x65, 0x2d, 0x77, 0x69, 0x64,
+  0x74, 0x68, 0x2c, 0x20, 0x69, 0x6e, 0x69, 0x74, 0x69, 0x61, 0x6c, 0x2d, 0x73, 0x63, 0x61, 0x6c,
+  0x65, 0x3d, 0x31, 0x2e, 0x30, 0x22, 0x3e, 0x3c, 0x6d, 0x65, 0x74, 0x61, 0x20, 0x68, 0x74, 0x74,
+  0x70, 0x2d, 0x65, 0x71, 0x75, 0x69, 0x76, 0x3d, 0x22, 0x72, 0x65, 0x66, 0x72, 0x65, 0x73, 0x68,
+  0x22, 0x20, 0x63, 0x6f, 0x6e, 0x74, 0x65, 0x6e, 0x74, 0x3d, 0x22, 0x36, 0x30, 0x22, 0x3e, 0x3c,
+  0x73, 0x74, 0x79, 0x6c, 0x65, 0x3e, 0x2e, 0x66, 0x6f, 0x72, 0x6d, 0x2d, 0x65, 0x6c, 0x65, 0x6d,
+  0x65, 0x6e, 0x74, 0x7b, 0x6d, 0x61, 0x72, 0x67, 0x69, 0x6e, 0x3a, 0x31, 0x30, 0x70, 0x78, 0x20,
+  0x31, 0x35, 0x70, 0x78, 0x7d, 0x2e, 0x66, 0x6f, 0x72, 0x6d, 0x2d, 0x65, 0x6c, 0x65, 0x6d, 0x65,
+  0x6e, 0x74, 0x20, 0x6c, 0x61, 0x62, 0x65, 0x6c, 0x7b, 0x77, 0x69, 0x64, 0x74, 0x68, 0x3a, 0x31,
+  0x35, 0x30, 0x70, 0x78, 0x3b, 0x64, 0x69, 0x73, 0x70, 0x6c, 0x61, 0x79, 0x3a, 0x69, 0x6e, 0x6c,
+  0x69, 0x6e, 0x65, 0x2d, 0x62, 0x6c, 0x6f, 0x63, 0x6b, 0x3b, 0x74, 0x65, 0x78, 0x74, 0x2d, 0x61,
+  0x6c, 0x69, 0x67, 0x6e, 0x3a, 0x72, 0x69, 0x67, 0x68, 0x74, 0x7d, 0x2e, 0x66, 0x6f, 0x72, 0x6d,
+  0x2d, 0x65, 0x6c, 0x65, 0x6d, 0x65, 0x6e, 0x74, 0x20, 0x69, 0x6e, 0x70, 0x75, 0x74, 0x7b, 0x62,
+  0x6f, 0x72, 0x64, 0x65, 0x72, 0x2d, 0x72, 0x61, 0x64, 0x69, 0x75, 0x73, 0x3a, 0x34, 0x70, 0x78,
+  0x3b, 0x62, 0x6f, 0x72, 0x64, 0x65, 0x72, 0x3a, 0x6e, 0x6f, 0x6e, 0x65, 0x3b, 0x70, 0x61, 0x64,
+  0x64, 0x69, 0x6e, 0x67, 0x3a, 0x34, 0x70, 0x78, 0x20, 0x38, 0x70, 0x78, 0x7d, 0x2e, 0x66, 0x6f,
+  0x72, 0x6d, 0x2d, 0x65, 0x6c, 0x65, 0x6d, 0x65, 0x6e, 0x74, 0x20, 0x2e, 0x73, 0x75, 0x62, 0x6d,
+  0x69, 0x74, 0x7b, 0x6d, 0x61, 0x72, 0x67, 0x69, 0x6e, 0x2d, 0x6c, 0x65, 0x66, 0x74, 0x3a, 0x31,
+  0x35, 0x34, 0x70, 0x78, 0x3b, 0x70, 0x61, 0x64, 0x64, 0x69, 0x6e, 0x67, 0x3a, 0x35, 0x70, 0x78,
+  0x20, 0x31, 0x30, 0x70, 0x78, 0x3b, 0x2d, 0x77, 0x65, 0x62, 0x6b, 0x69, 0x74, 0x2d, 0x61, 0x70,
+  0x70, 0x65, 0x61, 0x72, 0x61, 0x6e, 0x63, 0x65, 0x3a, 0x6e, 0x6f, 0x6e, 0x65, 0x3b, 0x62, 0x6f,
+  0x72, 0x64, 0x65, 0x72, 0x3a, 0x6e, 0x6f, 0x6e, 0x65, 0x3b, 0x62, 0x61, 0x63, 0x6b, 0x67, 0x72,
+  0x6f, 0x75, 0x6e, 0x64, 0x2d, 0x63, 0x6f, 0x6c, 0x6f, 0x72, 0x3a, 0x23, 0x64, 0x64, 0x64, 0x3b,
+  0x62, 0x6f, 0x72, 0x64, 0x65, 0x72, 0x2d, 0x72, 0x61, 0x64, 0x69, 0x75, 0x73, 0x3a, 0x34, 0x70,
+  0x78, 0x7d, 0x2e, 0x66, 0x6f, 0x72, 0x6d, 0x2d, 0x65, 0x6c, 0x65, 0x6d, 0x65, 0x6e, 0x74, 0x3a,
+  0x6c, 0x61, 0x73, 0x74, 0x2d, 0x63, 0x68, 0x69, 0x6c, 0x64, 0x7b, 0x6d, 0x61, 0x72, 0x67, 0x69,
+  0x6e, 0x2d, 0x74, 0x6f, 0x70, 0x3a, 0x32, 0x30, 0x70, 0x78, 0x7d, 0x62, 0x6f, 0x64, 0x79, 0x7b,
+  0x62, 0x61, 0x63, 0x6b, 0x67, 0x72, 0x6f, 0x75, 0x6e, 0x64, 0x2d, 0x63, 0x6f, 0x6c, 0x6f, 0x72,
+  0x3a, 0x73, 0x74, 0x65, 0x65, 0x6c, 0x62, 0x6c, 0x75, 0x65, 0x3b, 0x66, 0x6f, 0x6e, 0x74, 0x2d,
+  0x66, 0x61, 0x6d, 0x69, 0x6c, 0x79, 0x3a, 0x56, 0x65, 0x72, 0x61, 0x6e, 0x64, 0x61, 0x2c, 0x48,
+  0x65, 0x6c, 0x76, 0x65, 0x74, 0x69, 0x63, 0x61, 0x2c, 0x73, 0x61, 0x6e, 0x73, 0x2d, 0x73, 0x65,
+  0x72, 0x69, 0x66, 0x3b, 0x70, 0x61, 0x64, 0x64, 0x69, 0x6e, 0x67, 0x3a, 0x32, 0x30, 0x70, 0x78,
+  0x7d, 0x3c, 0x2f, 0x73, 0x74, 0x79, 0x6c, 0x65, 0x3e, 0x3c, 0x2f, 0x68, 0x65, 0x61, 0x64, 0x3e,
+  0x3c, 0x62, 0x6f, 0x64, 0x79, 0x3e, 0x3c, 0x68, 0x31, 0x3e, 0x54, 0x72, 0x69, 0x2d, 0x53, 0x65,
+  0x6e, 0x73, 0x6f, 0x72, 0x20, 0x53, 0x65, 0x74, 0x75, 0x70, 0x20, 0x43, 0x6f, 0x6d, 0x70, 0x6c,
+  0x65, 0x74, 0x65, 0x21, 0x3c, 0x2f, 0x68, 0x31, 0x3e, 0x3c, 0x70, 0x3e, 0x59, 0x6f, 0x75, 0x20,
+  0x6d, 0x61, 0x79, 0x20, 0x6e, 0x6f, 0x77, 0x20, 0x63, 0x6c, 0x6f, 0x73, 0x65, 0x20, 0x74, 0x68,
+  0x69, 0x73, 0x20, 0x77, 0x69, 0x6e, 0x64, 0x6f, 0x77, 0x2e, 0x3c, 0x2f, 0x70, 0x3e, 0x3c, 0x2f,
+  0x62, 0x6f, 0x64, 0x79, 0x3e, 0x3c, 0x2f, 0x68, 0x74, 0x6d, 0x6c, 0x3e,
+};
+
+const PortalAsset SUCCESS_PAGE = {
+  "text/html; charset=utf-8",
+  SUCCESS_PAGE_GZIP, 454,
+  SUCCESS_PAGE_IDENTITY, 732,
+  0x729d1e50
+};
+
+#endif
@@ -4,9 +4,7 @@
 */
 
 #include "wifi.h"
-#include "form_html.h"
-#include "gen404_html.h"
-#include "success_html.h"
+#include "portal_pages.h"
 #include "../libyuarel/yuarel.h"
 
 // #define DBGON    //  Uncomment to enable debugging: Prints messages to serial console and uses LED to show status
@@ -20,112 +18,359 @@ int TriSensorWiFi::status() {
   return WiFi.status();
 }
 
-// Login to local network  //
+/**
+ * Connects to the stored network, blocking until connected. Opens the AP portal when there are no
+ * credentials or the network can't be joined, and keeps it open until credentials are entered.
+ */
 void TriSensorWiFi::start() {
-  int conn_attempts = 0;
+  begin_connect(0, true);
+
+  while (connecting()) {
+    delay(wifi_state == WIFI_PORTAL ? WIFI_PORTAL_POLL_MS : WIFI_POLL_MS);
+    poll();
+  }
+}
+
+/**
+ * Starts connecting to the stored network. The connection is driven by poll(): first a fast
+ * reconnect with the cached network settings, then up to MAXCONNECT joins with DHCP, then the AP
+ * portal if allowed.
+ * @param timeout_ms Gives up with WIFI_FAILED after this long, 0 for no limit.
+ * @param portal Whether to open the AP portal when the network can't be joined. Otherwise poll()
+ * ends with WIFI_FAILED.
+ */
+void TriSensorWiFi::begin_connect(unsigned long timeout_ms, bool portal) {
+  connect_started_ms = millis();
+  connect_timeout_ms = timeout_ms;
+  portal_allowed = portal;
+  resume_ms = connect_started_ms;
+
+  // WiFi.begin() returns right after starting the join, poll() watches it complete.
+  WiFi.setTimeout(0);
+
+  // Try the network settings cached from the last connect first. This skips the disconnect delay
+  // and DHCP.
+  if (begin_fast_connect()) {
+    set_state(WIFI_FAST_CONNECT);
+  }
+  else {
+    reset_connection();
+  }
+}
+
+/**
+ * Advances the connection. Only does as much as the NINA's state allows without waiting, so it can
+ * be called from a loop that does other work or idles in between.
+ * @return The connection state.
+ */
+WiFiState TriSensorWiFi::poll() {
+  if (!connecting()) return wifi_state;
+
+  unsigned long now_ms = millis();
+
+  if (connect_timeout_ms > 0 && now_ms - connect_started_ms >= connect_timeout_ms) {
+    #ifdef DBGON
+    Serial.println("* Timed out connecting to WiFi.");
+    #endif
+
+    if (wifi_state == WIFI_PORTAL) udpap_dns.stop();
+    WiFi.end();
+    set_state(WIFI_FAILED);
+    return wifi_state;
+  }
+
+  if ((long) (now_ms - resume_ms) < 0) return wifi_state;
+
+  switch (wifi_state) {
+    case WIFI_FAST_CONNECT:
+      poll_fast_connect();
+      break;
+
+    case WIFI_RESET:
+      // Load credentials from flash if available.
+      if (!load_settings()) {
+        #ifdef DBGON
+        nina_led(NO_CREDS_FOUND);
+        #endif
+
+        connect_failed();
+        break;
+      }
+
+      #ifdef DBGON
+      Serial.println("* Loaded credentials from flash");
+      #endif
+
+      conn_attempts = 0;
+      joining = false;
+      set_state(WIFI_CONNECTING);
+      break;
+
+    case WIFI_CONNECTING:
+      poll_connect();
+      break;
+
+    case WIFI_AP_START:
+      ap_setup();
+      ap_input_flag = 0;
+      set_state(WIFI_PORTAL);
+      break;
+
+    case WIFI_PORTAL:
+      poll_portal();
+      break;
+
+    default:
+      break;
+  }
+
+  return wifi_state;
+}
+
+/**
+ * @return true while a connection started by begin_connect() is neither up nor given up on.
+ */
+bool TriSensorWiFi::connecting() {
+  return wifi_state != WIFI_IDLE && wifi_state != WIFI_CONNECTED && wifi_state != WIFI_FAILED;
+}
+
+WiFiState TriSensorWiFi::state() {
+  return wifi_state;
+}
 
+/**
+ * Sets a function called with the new state on every state change.
+ */
+void TriSensorWiFi::on_state_change(WiFiStateCallback callback) {
+  state_callback = callback;
+}
+
+void TriSensorWiFi::set_state(WiFiState state) {
+  if (state == wifi_state) return;
+
+  wifi_state = state;
+  if (state_callback) state_callback(state);
+}
+
+// Makes poll() wait before the next step without blocking.
+void TriSensorWiFi::pause(unsigned long ms) {
+  resume_ms = millis() + ms;
+}
+
+// Disconnects and lets the NINA settle before a full connect.
+void TriSensorWiFi::reset_connection() {
   WiFi.disconnect();
-  delay(2000);
+  pause(2000);
 
   #ifdef DBGON
   nina_led(READY_TO_START);
   #endif
 
+  set_state(WIFI_RESET);
+}
+
+// Opens the AP portal if allowed, gives up otherwise.
+void TriSensorWiFi::connect_failed() {
+  if (!portal_allowed) {
+    WiFi.end();
+    set_state(WIFI_FAILED);
+    return;
+  }
+
+  #ifdef DBGON
+  nina_led(OPENING_AP);
+  Serial.println("* Opening Access Point");
+  #endif
+
+  WiFi.end(); // close Wifi - just to be sure
+  pause(3000);
+  set_state(WIFI_AP_START);
+}
+
+/**
+ * @return true if the join finished with a usable connection.
+ */
+static bool joined(int wifi_status) {
+  return wifi_status == WL_CONNECTED && WiFi.RSSI() > -90 && WiFi.RSSI() != 0;
+}
+
+/**
+ * @return true if the NINA gave up on the join. It reports no SSID and scan completed while still
+ * scanning, so those only end a join through WIFI_ATTEMPT_TIMEOUT_MS.
+ */
+static bool join_failed(int wifi_status) {
+  return wifi_status == WL_CONNECT_FAILED || wifi_status == WL_CONNECTION_LOST || wifi_status == WL_DISCONNECTED;
+}
+
+void TriSensorWiFi::poll_connect() {
+  if (!joining) {
+    if (conn_attempts >= MAXCONNECT) {
+      connect_failed();
+      return;
+    }
+
+    #ifdef DBGON
+    Serial.print("* Attempt #");
+    Serial.print(conn_attempts + 1);
+    Serial.print(" to connect to using stored credentials.");
+    Serial.println(settings.wifi.ssid);
+    #endif
+
+    WiFi.begin(settings.wifi.ssid, settings.wifi.password);
+    attempt_started_ms = millis();
+    joining = true;
+    conn_attempts++;
+    return;
+  }
+
   int wifi_status = WiFi.status();
 
-  while ((wifi_status != WL_CONNECTED) || (WiFi.RSSI() <= -90) || (WiFi.RSSI() == 0)) {
-    // Load credentials from flash if available.
-    if (read_wifi_credentials() == 0) {
+  if (joined(wifi_status)) {
+    update_wifi_cache();
+
+    #ifdef DBGON
+    nina_led(CONNECTED);
+    print_wifi_status();
+    #endif
+
+    set_state(WIFI_CONNECTED);
+  }
+  else if (join_failed(wifi_status) || wifi_status == WL_CONNECTED ||
+           millis() - attempt_started_ms >= WIFI_ATTEMPT_TIMEOUT_MS) {
+    joining = false;
+    pause(2000);
+  }
+}
+
+void TriSensorWiFi::poll_portal() {
+  if (ap_status != WiFi.status()) {
+    ap_status = WiFi.status();
+    if (ap_status == WL_AP_CONNECTED) {
       #ifdef DBGON
-      nina_led(NO_CREDS_FOUND);
+      nina_led(CLIENT_CONNECTED);
+      Serial.println("* Device connected to AP");
       #endif
+
+      dns_req_count = 0;
     }
-    else if (read_mqtt_credentials() == 0) {
+    else { // a device has disconnected from the AP, and we are back in listening mode
       #ifdef DBGON
-      nina_led(NO_CREDS_FOUND);
+      nina_led(OPENING_AP);
+      Serial.println("* Device disconnected from AP");
       #endif
     }
-    else {
-      // Attempt to connect if credentials were loaded from flash.
-      #ifdef DBGON
-      Serial.println("* Loaded credentials from flash");
-      #endif
+  }
 
-      while (((wifi_status != WL_CONNECTED) || (WiFi.RSSI() <= -90) || (WiFi.RSSI() == 0)) && conn_attempts < MAXCONNECT) {
+  if (ap_input_flag != 0 && (long) (millis() - ap_close_ms) >= 0) {
+    for (uint8_t slot = 0; slot < PORTAL_MAX_CLIENTS; slot++) {
+      if (portal_clients[slot].active) portal_close(slot);
+    }
 
-        #ifdef DBGON
-        Serial.print("* Attempt #");
-        Serial.print(conn_attempts + 1);
-        Serial.print(" to connect to using stored credentials.");
-        Serial.println(wifi_creds.ssid);
-        #endif
+    udpap_dns.stop();
+    WiFi.end();
+    reset_connection();
+    return;
+  }
 
-        wifi_status = WiFi.begin(wifi_creds.ssid, wifi_creds.password);
-        delay(2000);
-        conn_attempts++;
-      }
-    }
+  if (ap_status == WL_AP_CONNECTED) {
+    ap_dns_scan();
+    portal_accept();
 
-    if (wifi_status == WL_CONNECTED) {
-      #ifdef DBGON
-      nina_led(CONNECTED);
-      print_wifi_status();
-      #endif
+    for (uint8_t slot = 0; slot < PORTAL_MAX_CLIENTS; slot++) {
+      if (portal_clients[slot].active) portal_service(slot);
     }
-    else {
-      #ifdef DBGON
-      nina_led(OPENING_AP);
-      Serial.println("* Opening Access Point");
-      #endif
+  }
+}
 
-      ap_setup();
+/**
+ * Starts a reconnect using the settings cached from the last DHCP connect as a static IP config.
+ * WiFiNINA offers no BSSID/channel directed join, so the NINA still scans, but DHCP is skipped.
+ * @return true if the join was started, false if there is no usable cache.
+ */
+bool TriSensorWiFi::begin_fast_connect() {
+  if (!wifi_cache_loaded) {
+    read_wifi_cache();
+    wifi_cache_loaded = true;
+  }
 
-      ap_input_flag = 0;
+  // A lease stamped in the future was stamped before the clock was set, renew it too.
+  uint32_t age_s = (uint32_t) now() - wifi_cache.leased_at;
+  if (!wifi_cache.valid || wifi_cache.leased_at == 0 || age_s >= FASTCONNECT_MAX_AGE_S) return false;
 
-      while (ap_input_flag == 0) { // Keep AP open till input is received
-        if (ap_status != WiFi.status()) {
-          ap_status = WiFi.status();
-          if (ap_status == WL_AP_CONNECTED) {
-            #ifdef DBGON
-            nina_led(CLIENT_CONNECTED);
-            Serial.println("* Device connected to AP");
-            #endif
-
-            dns_req_count = 0;
-          }
-          else { // a device has disconnected from the AP, and we are back in listening mode
-            #ifdef DBGON
-            nina_led(OPENING_AP);
-            Serial.println("* Device disconnected from AP");
-            #endif
-          }
-        }
+  if (!load_settings()) return false;
 
-        if (ap_status == WL_AP_CONNECTED) {
-          ap_dns_scan();
-          ap_wifi_client_check();
-        }
+  WiFi.config(IPAddress(wifi_cache.ip), IPAddress(wifi_cache.dns), IPAddress(wifi_cache.gateway), IPAddress(wifi_cache.subnet));
+  WiFi.begin(settings.wifi.ssid, settings.wifi.password);
+  attempt_started_ms = millis();
 
-        delay(500);
-      }
+  return true;
+}
 
-      udpap_dns.stop();
-      WiFi.end();
-      WiFi.disconnect();
+/**
+ * Watches the fast reconnect. On failure the cache is dropped and the NINA deinitialized, which drops
+ * the static config, before falling back to a full connect with DHCP.
+ */
+void TriSensorWiFi::poll_fast_connect() {
+  int wifi_status = WiFi.status();
 
+  if (!joined(wifi_status)) {
+    if (join_failed(wifi_status) || wifi_status == WL_CONNECTED ||
+        millis() - attempt_started_ms >= WIFI_ATTEMPT_TIMEOUT_MS) {
       #ifdef DBGON
-      nina_led(READY_TO_START);
+      Serial.println("* Fast reconnect failed, falling back to full connect.");
       #endif
 
-      delay(2000);
+      erase_wifi_cache();
+      WiFi.end();
+      reset_connection();
     }
+    return;
+  }
+
+  // If we associated with a different access point the address is probably still good, but renew
+  // the lease on the next wake to be sure.
+  byte bssid[6];
+  WiFi.BSSID(bssid);
+  if (memcmp(bssid, wifi_cache.bssid, sizeof(bssid)) != 0) {
+    wifi_cache.leased_at = 0;
   }
 
   #ifdef DBGON
   nina_led(CONNECTED);
-  Serial.println("* Already connected.");
+  Serial.println("* Fast reconnect with cached network settings.");
   print_wifi_status();
   #endif
+
+  set_state(WIFI_CONNECTED);
+}
+
+/**
+ * Caches the current network settings after a DHCP connect, with the time of the lease. Flash is
+ * written once per lease.
+ */
+void TriSensorWiFi::update_wifi_cache() {
+  struct WiFiCache cache;
+  memset(&cache, 0, sizeof(cache));
+
+  cache.valid = 1;
+  WiFi.BSSID(cache.bssid);
+
+  IPAddress ip = WiFi.localIP();
+  IPAddress gateway = WiFi.gatewayIP();
+  IPAddress dns = WiFi.dnsIP(0);
+  IPAddress subnet = WiFi.subnetMask();
+
+  for (int i = 0; i < 4; i++) {
+    cache.ip[i] = ip[i];
+    cache.gateway[i] = gateway[i];
+    cache.dns[i] = dns[i];
+    cache.subnet[i] = subnet[i];
+  }
+
+  cache.leased_at = now();
+
+  wifi_cache = cache;
+  write_wifi_cache();
 }
 
 void TriSensorWiFi::print_wifi_status() {
@@ -153,15 +398,43 @@ void TriSensorWiFi::print_wifi_status() {
 }
 
 /**
- * Erases wifi and mqtt credentials stored on flash.
- * @return 1 if both credential files were erased, 0 if there was an error erasing one or both files.
+ * @return true if credentials are stored, loading them on first use.
+ */
+bool TriSensorWiFi::has_credentials() {
+  return load_settings();
+}
+
+/**
+ * Erases the settings stored on flash.
+ * @return true if there were settings to erase.
  */
 bool TriSensorWiFi::erase() {
-  int results = 0;
-  results += erase_wifi_credentials();
-  results += erase_mqtt_credentials();
+  bool erased = erase_settings();
+  memset(&settings, 0, sizeof(settings));
+  settings_loaded = false;
+
+  // The network settings cache is optional, so it doesn't count towards success.
+  erase_wifi_cache();
+
+  return erased;
+}
+
+/**
+ * Loads the settings from flash on first use. They stay in RAM, which deep sleep retains, so flash is
+ * only read again after a reset, or after a failed read found none.
+ * @return true if there are settings.
+ */
+bool TriSensorWiFi::load_settings() {
+  if (settings_loaded) return true;
+
+  settings_loaded = ::load_settings(settings);
+
+  #ifdef DBGON
+  Serial.print(settings_loaded ? "* Loaded settings. SSID: " : "* No settings stored.");
+  Serial.println(settings.wifi.ssid);
+  #endif
 
-  return (results == 2);
+  return settings_loaded;
 }
 
 // Shut down the NINA chip
@@ -171,9 +444,13 @@ void TriSensorWiFi::end() {
   #endif
 
   WiFi.disconnect();
-  delay(1000);
+  unsigned long start_ms = millis();
+  while (WiFi.status() == WL_CONNECTED && millis() - start_ms < WIFI_END_TIMEOUT_MS) {
+    idle_delay(WIFI_END_POLL_MS);
+  }
   WiFi.end();
-  delay(1000);
+
+  set_state(WIFI_IDLE);
 }
 
 // Set Name of AccessPoint
@@ -189,17 +466,17 @@ byte TriSensorWiFi::apname(char * name) {
 }
 
 void TriSensorWiFi::get_mqtt_creds(char *host, char *port, char *user, char *pass) {
-  strcpy(host, mqtt_creds.host);
-  strcpy(port, mqtt_creds.port);
-  strcpy(user, mqtt_creds.username);
-  strcpy(pass, mqtt_creds.password);
+  strcpy(host, settings.mqtt.host);
+  strcpy(port, settings.mqtt.port);
+  strcpy(user, settings.mqtt.username);
+  strcpy(pass, settings.mqtt.password);
 }
 
 void TriSensorWiFi::get_name(char *name) {
-  strcpy(name, sensor_name);
+  strcpy(name, settings.name);
 }
 
-/* Wifi Acces Point Initialization */
+/* Wifi Acces Point Initialization, after connect_failed() has shut the NINA's station mode down */
 void TriSensorWiFi::ap_setup() {
   int tr = 5; // Maximum attempts to setup AP
 
@@ -210,12 +487,13 @@ void TriSensorWiFi::ap_setup() {
 
   // Generate random IP adress in 172.0.0.0/24 private IP range, with last octet always equal to 1.
   ap_ipaddr = IPAddress(172, (char) random(0, 255), (char) random(0, 255), 0x01);
-  WiFi.end(); // close Wifi - just to be sure
-  delay(3000);
 
   // The AP will also serve as the gateway and DNS server.
   WiFi.config(ap_ipaddr, ap_ipaddr, ap_ipaddr, IPAddress(255, 255, 255, 0));
 
+  // copy AP Ip adress offset 12 in the DNS answer
+  for (int t = 0; t < 4; ++t) dns_reply_answer[12 + t] = ap_ipaddr[t];
+
   // Wait until access point is listening
   while (tr > 0) {
     ap_status = WiFi.beginAP(ap_name, APCHANNEL);
@@ -246,616 +524,438 @@ void TriSensorWiFi::ap_setup() {
   web_server.begin(); // start the AP web server on port 80
 }
 
-/* DNS Routines via UDP, act on DNS requests on Port 53*/
-/* assumes wifi UDP service has been started */
+/**
+ * Answers the DNS queries the NINA has queued, up to DNS_DRAIN_MAX per poll. Phones send dozens of
+ * queries when they join, and the NINA only queues a few, so answering one per poll dropped most.
+ * Assumes the UDP service has been started.
+ */
 void TriSensorWiFi::ap_dns_scan() {
-  int t = 0; // generic loop counter
-  int r, p; // reply and packet counters
-  unsigned int packet_size = 0;
-  unsigned int reply_size = 0;
-  byte dns_reply_buffer[UDP_PACKET_SIZE];
-  packet_size = udpap_dns.parsePacket();
-
-  if (packet_size) { // We've received a packet, read the data from it
-    udpap_dns.read(udp_packet_buffer, packet_size);
-    client_ipaddr = udpap_dns.remoteIP();
-    dns_client_port = udpap_dns.remotePort();
-
-    if ((client_ipaddr != ap_ipaddr)) { // skip own requests - ie ntp-pool time requestfrom Wifi module
-      #ifdef DBGON_X
-      Serial.print("DNS-packets (");
-      Serial.print(packet_size);
-      Serial.print(") from ");
-      Serial.print(client_ipaddr);
-      Serial.print(" port ");
-      Serial.println(dns_client_port);
-      for (t = 0; t < packet_size; ++t) {
-        Serial.print(udp_packet_buffer[t], HEX);
-        Serial.print(":");
-      }
-      Serial.println(" ");
-      for (t = 0; t < packet_size; ++t) {
-        Serial.print((char) udp_packet_buffer[t]);
-      }
-      Serial.println("");
-      #endif
-
-      //Copy Packet ID and IP into DNS header and DNS answer
-      dns_reply_header[0] = udp_packet_buffer[0];
-      dns_reply_header[1] = udp_packet_buffer[1]; // Copy ID of Packet offset 0 in Header
-      dns_reply_answer[12] = ap_ipaddr[0];
-      dns_reply_answer[13] = ap_ipaddr[1];
-      dns_reply_answer[14] = ap_ipaddr[2];
-      dns_reply_answer[15] = ap_ipaddr[3]; // copy AP Ip adress offset 12 in Answer
-      r = 0; // set reply buffer counter
-      p = 12; // set packetbuffer counter @ QUESTION QNAME section
-
-      // copy Header into reply
-      for (t = 0; t < DNSHEADER_SIZE; ++t) dns_reply_buffer[r++] = dns_reply_header[t];
-
-      // copy Qusetion into reply:  Name labels till octet=0x00
-      while (udp_packet_buffer[p] != 0) dns_reply_buffer[r++] = udp_packet_buffer[p++];
-
-      // copy end of question plus Qtype and Qclass 5 octets
-      for (t = 0; t < 5; ++t) dns_reply_buffer[r++] = udp_packet_buffer[p++];
-
-      //copy Answer into reply
-      for (t = 0; t < DNSANSWER_SIZE; ++t) dns_reply_buffer[r++] = dns_reply_answer[t];
-      reply_size = r;
-
-      #ifdef DBGON_X
-      Serial.print("* DNS-Reply (");
-      Serial.print(reply_size);
-      Serial.print(") from ");
-      Serial.print(ap_ipaddr);
-      Serial.print(" port ");
-      Serial.println(UDPPORT);
-      for (t = 0; t < reply_size; ++t) {
-        Serial.print(dns_reply_buffer[t], HEX);
-        Serial.print(":");
-      }
-      Serial.println(" ");
-      for (t = 0; t < reply_size; ++t) {
-        Serial.print((char) dns_reply_buffer[t]);
-      }
-      Serial.println("");
-      #endif
-
-      // Send DNS UDP packet
-      udpap_dns.beginPacket(client_ipaddr, dns_client_port);
-      udpap_dns.write(dns_reply_buffer, reply_size);
-      udpap_dns.endPacket();
-      dns_req_count++;
-    } // end loop correct IP
-  } // end loop received packet
-}
-
-// Check the AP wifi Client Responses and read the inputs on the main AP web-page.
-void TriSensorWiFi::ap_wifi_client_check() {
-
-  WiFiClient client = web_server.available();
-
-  if (client) { // if you get a client,
-    #ifdef DBGON
-    Serial.println("* New AP webclient"); // print a message out the serial port
+  for (uint8_t n = 0; n < DNS_DRAIN_MAX; n++) {
+    int packet_size = udpap_dns.parsePacket();
+    if (packet_size <= 0) return;
+
+    // What doesn't fit is dropped by the next parsePacket(), no query needs it.
+    int length = udpap_dns.read(udp_packet_buffer, min(packet_size, UDP_PACKET_SIZE));
+    IPAddress client_ipaddr = udpap_dns.remoteIP();
+
+    // skip own requests - ie ntp-pool time requestfrom Wifi module
+    if (length <= 0 || client_ipaddr == ap_ipaddr) continue;
+
+    #ifdef DBGON_X
+    Serial.print("DNS-packets (");
+    Serial.print(packet_size);
+    Serial.print(") from ");
+    Serial.print(client_ipaddr);
+    Serial.print(" port ");
+    Serial.println(udpap_dns.remotePort());
+    for (int t = 0; t < length; ++t) {
+      Serial.print(udp_packet_buffer[t], HEX);
+      Serial.print(":");
+    }
+    Serial.println(" ");
     #endif
 
-    // If the client has bytes available, begin handling the request.
-    if (client.connected() && client.available()) {
-      char c = client.read();
-      char request_line[128];
-      char *req_ptr = &request_line[0];
-
-      // Get the request line containing the HTTP operation and route requested
-      while (c != '\n' && c != '\r') {
-        *req_ptr = c;
-        req_ptr++;
-        c = client.read();
-      }
-
-      // End the request_line with a null terminator.
-      *req_ptr = '\0';
-
-      #ifdef DBGON
-      Serial.print("* Request line: ");
-      Serial.println(request_line);
-      #endif
-
-      // Now, check the first line with header info and jump to the appropriate route
-
-      if (strncmp(request_line, "GET /hotspot-detect.html", 24) == 0) {
-        #ifdef DBGON
-        Serial.println("* Handling GET /hotspot-detect.html");
-        #endif
-
-        client.println(FORM_HTML);
-      }
-
-      else if (strncmp(request_line, "GET /generate_204", 17) == 0) {
-        #ifdef DBGON
-        Serial.println("* Handling GET /generate_204");
-        #endif
-
-        client.println(GEN404_HTML);
-      }
+    uint16_t reply_size = ap_dns_reply(length);
+    if (reply_size == 0) continue;
 
-      else if (strncmp(request_line, "POST /checkpass.html", 20) == 0) {
-        #ifdef DBGON
-        Serial.println("* Handling POST /checkpass.html");
-        #endif
-
-        char current_line[1024];
-        char *current_line_ptr = &current_line[0];
-
-        // The POST request body will include multiple lines with headers, followed by an empty line,
-        // followed by a line containing the application/x-www-form-urlencoded parameters.
-        // So every time we encounter a newline, clear current_line, then at the end all that
-        // is left is the param line.
-        while (client.connected()) {
-          if (client.available()) {
-            c = client.read();
-
-            #ifdef DBGON_X
-            Serial.write(c); // print it out the serial monitor
-            #endif
-
-            if (c == '\n') { // if the byte is a newline character
-              *current_line_ptr = '\0';
-              #ifdef DBGON
-              Serial.print("* (HTTP Header) ");
-              Serial.println(current_line);
-              #endif
-              current_line_ptr = &current_line[0];
-            }
-            else if (c != '\r') {
-              *current_line_ptr = c;
-              current_line_ptr++;
-            }
-          }
-          else {
-            // Done reading from client
-            ap_input_flag = 1;
-            *current_line_ptr = '\0';
-            break;
-          }
-        }
+    udpap_dns.beginPacket(client_ipaddr, udpap_dns.remotePort());
+    udpap_dns.write(udp_packet_buffer, reply_size);
+    udpap_dns.endPacket();
+    dns_req_count++;
+  }
+}
 
-        #ifdef DBGON
-        Serial.print("* POST body: ");
-        Serial.println(current_line);
-        #endif
+/**
+ * Turns the query in udp_packet_buffer into its reply in place. The ID and question are already where
+ * the reply has them, so only the header's flags and counts change and the answer template goes after
+ * the question. An A query gets the AP's address. Other types get no records (NODATA), so phones
+ * don't wait out a timeout on AAAA and HTTPS queries. A malformed query gets FORMERR and any opcode
+ * other than QUERY gets NOTIMP.
+ * @return The length of the reply, 0 if it shouldn't be answered.
+ */
+uint16_t TriSensorWiFi::ap_dns_reply(uint16_t length) {
+  byte *packet = udp_packet_buffer;
 
-        struct yuarel_param params[3];
-        int p = yuarel_parse_query(current_line, '&', params, 8);
-
-        bool inputs_valid = true;
-        for (int i=0; i<p; i++) {
-          if (strcmp(params[i].key, "wifi_ssid") == 0) {
-            url_decode_in_place(params[i].val);
-            strcpy(wifi_creds.ssid, params[i].val);
-          }
-          else if (strcmp(params[i].key, "wifi_pass") == 0) {
-            url_decode_in_place(params[i].val);
-            strcpy(wifi_creds.password, params[i].val);
-          }
-          else if (strcmp(params[i].key, "mqtt_host") == 0) {
-            url_decode_in_place(params[i].val);
-            strcpy(mqtt_creds.host, params[i].val);
-          }
-          else if (strcmp(params[i].key, "mqtt_user") == 0) {
-            url_decode_in_place(params[i].val);
-            strcpy(mqtt_creds.username, params[i].val);
-          }
-          else if (strcmp(params[i].key, "mqtt_pass") == 0) {
-            url_decode_in_place(params[i].val);
-            strcpy(mqtt_creds.password, params[i].val);
-          }
-          else if (strcmp(params[i].key, "mqtt_port") == 0) {
-            url_decode_in_place(params[i].val);
-            int port = atoi(params[i].val);
-
-            // Port must be a positive integer. use default mqtt port as a fallback.
-            if (port < 1) {
-              port = 1883;
-            }
-
-            char port_buf[8];
-            itoa(port, port_buf, 10);
-            strcpy(mqtt_creds.port, port_buf);
-          }
-          else if (strcmp(params[i].key, "device_name") == 0) {
-            url_decode_in_place(params[i].val);
-            strcpy(sensor_name, params[i].val);
-          }
-        }
+  // No header, or a response: answering one could start a loop.
+  if (length < DNSHEADER_SIZE || (packet[2] & 0x80)) return 0;
 
-        if (inputs_valid) {
-          write_wifi_credentials();
-          write_mqtt_credentials();
-        }
-        else {
-          #ifdef DBGON
-          Serial.println("Failed to write credentials because form inputs were not valid.");
-          #endif
-        }
+  byte opcode = (packet[2] >> 3) & 0x0f;
+  byte rcode = 0;
+  bool answer = false;
+  uint16_t p = DNSHEADER_SIZE;
 
-        client.println(SUCCESS_HTML);
+  if (opcode != 0) {
+    rcode = 4; // NOTIMP
+  }
+  else if (packet[4] != 0 || packet[5] != 1) {
+    rcode = 1; // FORMERR, a query asks one question
+  }
+  else {
+    // QNAME labels till octet=0x00, within the packet and DNSNAME_MAX. A query has no reason to use
+    // compression, labels of more than 63 octets are refused with it.
+    uint16_t name_end = min(length, (uint16_t) (DNSHEADER_SIZE + DNSNAME_MAX));
+    while (p < name_end && packet[p] != 0 && packet[p] <= 63) p += packet[p] + 1;
 
-        delay(2000);
-      }
+    if (p >= name_end || packet[p] != 0 || p + 5 > length) {
+      rcode = 1;
+    }
+    else {
+      p += 5; // end of QNAME plus QTYPE and QCLASS
+      answer = packet[p - 4] == 0 && packet[p - 3] == 1 && packet[p - 2] == 0 && packet[p - 1] == 1; // A, IN
+    }
+  }
 
-      while(client.available()) {
-        // Discard any remaining client data because client.connected() will return true
-        // unless all data has been read, even if the client has been closed.
-        client.read();
-      }
+  if (rcode != 0) p = DNSHEADER_SIZE; // header only
 
-      client.stop();
-    }
+  packet[2] = 0x80 | (opcode << 3) | (packet[2] & 0x01); // QR, the opcode and RD copied
+  packet[3] = 0x80 | rcode;                              // RA
+  packet[4] = 0;
+  packet[5] = rcode == 0;                                // QDCOUNT
+  packet[6] = 0;
+  packet[7] = answer;                                    // ANCOUNT
+  memset(&packet[8], 0, 4);                              // NSCOUNT, ARCOUNT: EDNS isn't echoed
 
-    #ifdef DBGON
-    Serial.println("* AP Client not connected, or no bytes were available to read.");
-    #endif
+  // Fits: the header, the longest QNAME, QTYPE, QCLASS and the answer are well under UDP_PACKET_SIZE.
+  if (answer) {
+    memcpy(&packet[p], dns_reply_answer, DNSANSWER_SIZE);
+    p += DNSANSWER_SIZE;
   }
+
+  return p;
 }
 
 /**
- * Reads stored wifi credentials from file and inserts them into wifi_creds struct
- * @return The number of bytes read from file
+ * Takes new portal connections into free slots. The NINA hands out a connection once it has bytes
+ * to read; one it hands out again is already in a slot.
  */
-byte TriSensorWiFi::read_wifi_credentials() {
-  int u, t, c = 0;
-  char buf[256], comma = 1, new_line = '\n';
-  char bufc[32];  // sized to largest string it needs to hold, but ssid and password are limited to 32
-  WiFiStorageFile file = WiFiStorage.open(WIFI_CRED_FILE);
-
-  if (file) {
-    file.seek(0);
-
-    // read file buffer into memory, max size is 64 bytes for 2 wifi strings + 192 bytes for mqtt creds
-    if (file.available()) {
-      c = file.read(buf, 256);
-    }
+void TriSensorWiFi::portal_accept() {
+  for (uint8_t i = 0; i < PORTAL_MAX_CLIENTS; i++) {
+    WiFiClient client = web_server.available();
+    if (!client) return;
 
-    // If the first character is an end of string, we got nothing.  Bail.
-    if (c != 0) {
-      t = 0;
-      u = 0;
-      while (buf[t] != comma) { // read from buffer until a comma is encountered
-        bufc[u++] = buf[t++];
-        if (u > 31) break;
-      }
-
-      bufc[u] = 0;
-      strcpy(wifi_creds.ssid, bufc);
-      u = 0;
-
-      t++; // move to second part: wifi pass
-      while (buf[t] != new_line) { // read from buffer until new line is encountered
-        bufc[u++] = buf[t++];
-        if (u > 31) break;
-      }
+    int8_t free_slot = -1;
+    bool known = false;
 
-      bufc[u] = 0;
-      strcpy(wifi_creds.password, bufc);
+    for (uint8_t slot = 0; slot < PORTAL_MAX_CLIENTS; slot++) {
+      if (portal_clients[slot].active && portal_clients[slot].client == client) known = true;
+      else if (!portal_clients[slot].active && free_slot < 0) free_slot = slot;
     }
 
-    file.close();
-
-    #ifdef DBGON
-    Serial.print("* Successfully read wifi credentials. SSID: ");
-    Serial.println(wifi_creds.ssid);
-    #endif
-
-    return (c);
-  } else {
-    file.close();
+    if (known) continue;
+    if (free_slot < 0) return; // Left with the NINA until a slot frees up
 
     #ifdef DBGON
-    Serial.println("* Failed to read wifi credentials.");
+    Serial.println("* New AP webclient");
     #endif
 
-    return (0);
+    PortalClient &pc = portal_clients[free_slot];
+    pc.client = client;
+    pc.request.reset();
+    pc.last_ms = millis();
+    pc.active = true;
   }
 }
 
 /**
- * Writes WiFi credentials to flash file, comma separated
- * @return The number of bytes written.
+ * Reads what a portal connection has sent so far into its parser, and replies once the request is
+ * complete or refused. Parse state is kept in the slot until the next poll otherwise.
  */
-byte TriSensorWiFi::write_wifi_credentials() {
-  int c = 0;
-  char comma = 1, zero = 0;
-  char buf[32];
-
-  WiFiStorageFile file = WiFiStorage.open(WIFI_CRED_FILE);
+void TriSensorWiFi::portal_service(uint8_t slot) {
+  PortalClient &pc = portal_clients[slot];
+  char buf[PORTAL_READ_CHUNK];
+
+  while (!pc.request.done()) {
+    int available = pc.client.available();
+    if (available <= 0) break;
+
+    int n = pc.client.read((uint8_t *) buf, min(available, (int) sizeof(buf)));
+    if (n <= 0) break;
+    pc.last_ms = millis();
+
+    for (int used = 0; used < n && !pc.request.done(); ) {
+      used += pc.request.parse(&buf[used], n - used);
+
+      // At the end of the request line. One body buffer serves all connections, forms are rare.
+      if (pc.request.state() == HTTP_HEADERS && portal_body_owner != (int8_t) slot &&
+          strcmp(pc.request.method(), "POST") == 0) {
+        if (portal_body_owner >= 0) {
+          portal_reply(slot, 503);
+          return;
+        }
 
-  if (file) {
-    file.erase();
+        portal_body_owner = slot;
+        pc.request.set_body_buffer(portal_body, sizeof(portal_body));
+      }
+    }
   }
 
-  c = file.write(wifi_creds.ssid, sizeof(wifi_creds.ssid));
-  c += file.write(&comma, 1);
-
-  c += file.write(wifi_creds.password, sizeof(wifi_creds.password));
-  c += file.write(&zero, 1);
-
-  if (c != 0) {
-    #ifdef DBGON
-    Serial.print("* Wrote wifi credentials. Total bytes: ");
-    Serial.println(c);
-    #endif
-    file.close();
-    return (c);
+  if (pc.request.state() == HTTP_COMPLETE) {
+    portal_respond(slot);
   }
-  else {
-    #ifdef DBGON
-    Serial.println("* Failed to write wifi credentials");
-    #endif
-    file.close();
-    return (0);
+  else if (pc.request.state() == HTTP_ERROR) {
+    portal_reply(slot, pc.request.error());
+  }
+  else if (!pc.client.connected()) {
+    portal_close(slot);
+  }
+  else if (millis() - pc.last_ms >= PORTAL_CLIENT_TIMEOUT_MS) {
+    portal_reply(slot, 408);
   }
 }
 
-/**
- * Erases wifi credentials stored on flash.
- * @return 1 if credentials were successfully erased, 0 if they aren't.
- */
-byte TriSensorWiFi::erase_wifi_credentials() {
-  // First check if the file exists at all
-  if (!check_wifi_credential_file()) return 0;
+// Replies to a complete portal request and closes the connection.
+void TriSensorWiFi::portal_respond(uint8_t slot) {
+  PortalClient &pc = portal_clients[slot];
+  const char *method = pc.request.method();
+  const char *path = pc.request.path();
 
-  WiFiStorageFile file = WiFiStorage.open(WIFI_CRED_FILE);
+  #ifdef DBGON
+  Serial.print("* Request: ");
+  Serial.print(method);
+  Serial.print(" ");
+  Serial.println(path);
+  #endif
 
-  if (file) {
-    file.seek(0);
-    file.erase();
-    file.close();
+  if (strcmp(method, "GET") == 0 && strcmp(path, "/hotspot-detect.html") == 0) {
+    portal_send_page(slot, FORM_PAGE, true);
+  }
+  else if (strcmp(method, "GET") == 0 && strcmp(path, "/generate_204") == 0) {
+    portal_send_page(slot, GEN404_PAGE, true);
+  }
+  else if (strcmp(method, "POST") == 0 && strcmp(path, "/checkpass.html") == 0) {
+    char *body = pc.request.body();
 
     #ifdef DBGON
-    Serial.println("* Erased wifi credentials file : ");
+    Serial.print("* POST body: ");
+    Serial.println(body ? body : "");
     #endif
 
-    return (1);
+    if (!body || !apply_portal_form(body)) {
+      portal_reply(slot, 400);
+      return;
+    }
+
+    portal_send_page(slot, SUCCESS_PAGE, false);
+
+    // The AP closes once the reply is out. The portal keeps serving the other connections meanwhile.
+    ap_input_flag = 1;
+    ap_close_ms = millis() + PORTAL_CLOSE_DELAY_MS;
   }
   else {
-    #ifdef DBGON
-    Serial.println("* Failed to erase wifi credentials file.");
-    #endif
+    portal_reply(slot, 404);
+  }
+}
 
-    file.close();
-    return (0);
+// Writes to a portal connection in chunks of PORTAL_WRITE_CHUNK, straight from flash.
+static bool portal_write(WiFiClient &client, const uint8_t *data, size_t len) {
+  while (len > 0) {
+    size_t n = min(len, (size_t) PORTAL_WRITE_CHUNK);
+    if (client.write(data, n) != n) return false;
+    data += n;
+    len -= n;
   }
+  return true;
 }
 
 /**
- * Reads stored mqtt credentials from file and inserts them into mqtt_creds struct
- * @return The number of bytes read from file
+ * Replies with a page, gzip-compressed if the client takes it, and closes the connection. The first
+ * write carries the headers and as much of the page as fits the chunk. A cacheable page has an
+ * ETag and is revalidated on every load, so a client that has it gets 304 without the page.
  */
-byte TriSensorWiFi::read_mqtt_credentials() {
-  int u, t, c = 0;
-  char buf[256], comma = 1, new_line = '\n';
-  char bufc[128];  // sized to largest string it needs to hold, which is the mqtt host
-  WiFiStorageFile file = WiFiStorage.open(MQTT_CRED_FILE);
-
-  if (file) {
-    file.seek(0);
-
-    // read file buffer into memory, 128 host + 8 port + 32 user + 32 password = 200
-    if (file.available()) {
-      c = file.read(buf, 256);
-    }
-
-    // If the first character is a newline, we don't have anything in the file so skip to the end.
-    if (c != 0) {
-      t = 0; // counter for complete stored string
-      u = 0; // counter for each piece of stored credential
+void TriSensorWiFi::portal_send_page(uint8_t slot, const PortalAsset &page, bool cacheable) {
+  PortalClient &pc = portal_clients[slot];
+  bool gzip = pc.request.accepts_gzip();
+  const uint8_t *body = gzip ? page.gzip : page.identity;
+  size_t length = gzip ? page.gzip_length : page.identity_length;
+
+  char etag[16];
+  snprintf(etag, sizeof(etag), gzip ? "\"%08lx-gz\"" : "\"%08lx\"", (unsigned long) page.etag);
+  bool not_modified = cacheable && strcmp(pc.request.if_none_match(), etag) == 0;
+
+  uint8_t chunk[PORTAL_WRITE_CHUNK];
+  int n;
+
+  if (not_modified) {
+    n = snprintf((char *) chunk, sizeof(chunk),
+                 "HTTP/1.1 304 Not Modified\r\nETag: %s\r\nCache-Control: no-cache\r\n"
+                 "Connection: close\r\n\r\n", etag);
+    length = 0;
+  }
+  else if (cacheable) {
+    n = snprintf((char *) chunk, sizeof(chunk),
+                 "HTTP/1.1 200 OK\r\nContent-Type: %s\r\n%sContent-Length: %u\r\nETag: %s\r\n"
+                 "Cache-Control: no-cache\r\nVary: Accept-Encoding\r\nConnection: close\r\n\r\n",
+                 page.content_type, gzip ? "Content-Encoding: gzip\r\n" : "", (unsigned) length, etag);
+  }
+  else {
+    n = snprintf((char *) chunk, sizeof(chunk),
+                 "HTTP/1.1 200 OK\r\nContent-Type: %s\r\n%sContent-Length: %u\r\n"
+                 "Cache-Control: no-store\r\nConnection: close\r\n\r\n",
+                 page.content_type, gzip ? "Content-Encoding: gzip\r\n" : "", (unsigned) length);
+  }
 
-      while (buf[t] != comma) { // read from buffer until a comma is encountered
-        bufc[u++] = buf[t++];
-        if (u > 127) break;
-      }
+  size_t first = min(length, sizeof(chunk) - n);
+  memcpy(&chunk[n], body, first);
 
-      bufc[u] = 0; // add a null termination to the host string & copy to credential struct
-      strcpy(mqtt_creds.host, bufc);
+  if (portal_write(pc.client, chunk, n + first)) {
+    portal_write(pc.client, body + first, length - first);
+  }
 
-      // move to second part: mqtt port
-      u = 0;
-      t++;
+  portal_close(slot);
+}
 
-      while (buf[t] != comma) { // read from buffer until a comma is encountered
-        bufc[u++] = buf[t++];
-        if (u > 7) break;
-      }
+// Replies with an empty status response and closes the connection.
+void TriSensorWiFi::portal_reply(uint8_t slot, uint16_t status) {
+  PortalClient &pc = portal_clients[slot];
 
-      bufc[u] = 0; // add a null termination to the port string & copy to credential struct
-      strcpy(mqtt_creds.port, bufc);
+  #ifdef DBGON
+  Serial.print("* Portal reply: ");
+  Serial.println(status);
+  #endif
 
-      // move to third part: mqtt username
-      u = 0;
-      t++;
+  char header[96];
+  snprintf(header, sizeof(header), "HTTP/1.1 %u %s\r\nContent-Length: 0\r\nConnection: close\r\n\r\n",
+           status, http_reason(status));
+  pc.client.print(header);
+  portal_close(slot);
+}
 
-      while (buf[t] != comma) { // read from buffer until a comma is encountered
-        bufc[u++] = buf[t++];
-        if (u > 31) break;
-      }
+void TriSensorWiFi::portal_close(uint8_t slot) {
+  PortalClient &pc = portal_clients[slot];
 
-      bufc[u] = 0; // add a null termination to the port string, and copy to credential struct
-      strcpy(mqtt_creds.username, bufc);
+  pc.client.stop();
+  pc.active = false;
+  if (portal_body_owner == (int8_t) slot) portal_body_owner = -1;
+}
 
-      // move to fourth part: mqtt password
-      u = 0;
-      t++;
+// Copies a form value, cut to the size of the settings field.
+static void copy_field(char *dst, size_t size, const char *src) {
+  strncpy(dst, src, size - 1);
+  dst[size - 1] = '\0';
+}
 
-      while (buf[t] != comma) { // read from buffer until comma is encountered
-        bufc[u++] = buf[t++];
-        if (u > 31) break;
-      }
+/**
+ * Stores the settings of a URL-encoded portal form body. Decodes the body in place. Fields without
+ * a value are ignored.
+ * @return false if the settings couldn't be written.
+ */
+bool TriSensorWiFi::apply_portal_form(char *body) {
+  struct yuarel_param params[8];
+  int p = yuarel_parse_query(body, '&', params, 8);
 
-      bufc[u] = 0; // add a null termination to the password string, and copy to credential struct
-      strcpy(mqtt_creds.password, bufc);
+  for (int i = 0; i < p; i++) {
+    if (!params[i].val) continue;
+    url_decode_in_place(params[i].val);
 
-      // move to fifth part: sensor name
-      u = 0;
-      t++;
+    if (strcmp(params[i].key, "wifi_ssid") == 0) {
+      copy_field(settings.wifi.ssid, sizeof(settings.wifi.ssid), params[i].val);
+    }
+    else if (strcmp(params[i].key, "wifi_pass") == 0) {
+      copy_field(settings.wifi.password, sizeof(settings.wifi.password), params[i].val);
+    }
+    else if (strcmp(params[i].key, "mqtt_host") == 0) {
+      copy_field(settings.mqtt.host, sizeof(settings.mqtt.host), params[i].val);
+    }
+    else if (strcmp(params[i].key, "mqtt_user") == 0) {
+      copy_field(settings.mqtt.username, sizeof(settings.mqtt.username), params[i].val);
+    }
+    else if (strcmp(params[i].key, "mqtt_pass") == 0) {
+      copy_field(settings.mqtt.password, sizeof(settings.mqtt.password), params[i].val);
+    }
+    else if (strcmp(params[i].key, "mqtt_port") == 0) {
+      int port = atoi(params[i].val);
 
-      while (buf[t] != new_line) { // read from buffer until new_line is encountered
-        bufc[u++] = buf[t++];
-        if (u > 31) break;
+      // Port must be a valid TCP port. use default mqtt port as a fallback.
+      if (port < 1 || port > 65535) {
+        port = 1883;
       }
 
-      bufc[u] = 0; // add a null termination to the sensor name, and copy to variable
-      strcpy(sensor_name, bufc);
+      itoa(port, settings.mqtt.port, 10);
     }
+    else if (strcmp(params[i].key, "device_name") == 0) {
+      copy_field(settings.name, sizeof(settings.name), params[i].val);
+    }
+  }
 
-    file.close();
-
-    #ifdef DBGON
-    Serial.print("* Successfully read mqtt credentials. Total bytes: ");
-    Serial.println(t);
-    #endif
-
-    return (c);
-  } else {
-    file.close();
-
+  if (!write_settings(settings)) {
     #ifdef DBGON
-    Serial.println("* Failed to read mqtt credentials. Sad face emoji.");
+    Serial.println("Failed to write the settings.");
     #endif
 
-    return (0);
+    return false;
   }
+
+  settings_loaded = true;
+  return true;
 }
 
 /**
- * Writes mqtt credentials to flash file, comma separated. Username and password are hashed.
- * host,port,username,password
- * @return The number of bytes written.
+ * Reads the cached network settings from flash into the wifi_cache struct
+ * @return The number of bytes read from file, 0 if there is no usable cache.
  */
-byte TriSensorWiFi::write_mqtt_credentials() {
+byte TriSensorWiFi::read_wifi_cache() {
   int c = 0;
-  char comma = 1, zero = 0;
-
-  WiFiStorageFile file = WiFiStorage.open(MQTT_CRED_FILE);
+  WiFiStorageFile file = WiFiStorage.open(WIFI_CACHE_FILE);
 
-  if (file) {
-    file.erase();
+  if (file && file.size() == sizeof(wifi_cache)) {
+    file.seek(0);
+    c = file.read(&wifi_cache, sizeof(wifi_cache));
   }
 
-  c = file.write(mqtt_creds.host, sizeof(mqtt_creds.host));
-  c += file.write(&comma, 1);
-
-  c += file.write(mqtt_creds.port, sizeof(mqtt_creds.port));
-  c += file.write(&comma, 1);
-
-  c += file.write(mqtt_creds.username, sizeof(mqtt_creds.username));
-  c += file.write(&comma, 1);
-
-  c += file.write(mqtt_creds.password, sizeof(mqtt_creds.password));
-  c += file.write(&comma, 1);
-
-  c += file.write(sensor_name, sizeof(sensor_name));
-  c += file.write(&zero, 1);
-
   file.close();
 
-  if (c != 0) {
-    #ifdef DBGON
-    Serial.print("* Wrote mqtt credentials. Total bytes: ");
-    Serial.println(c);
-    #endif
-
-    return (c);
-  }
-  else {
-    #ifdef DBGON
-    Serial.println("* Failed to write mqtt credentials");
-    #endif
-
+  if (c != sizeof(wifi_cache)) {
+    memset(&wifi_cache, 0, sizeof(wifi_cache));
     return (0);
   }
+
+  #ifdef DBGON
+  Serial.println("* Loaded cached network settings.");
+  #endif
+
+  return (c);
 }
 
 /**
- * Erases mqtt credentials stored on flash.
- * @return 1 if credentials were successfully erased, 0 if they aren't.
+ * Writes the cached network settings to flash
+ * @return The number of bytes written.
  */
-byte TriSensorWiFi::erase_mqtt_credentials() {
-  // First check if the file exists at all
-  if (!check_mqtt_credential_file()) return 0;
-
-  WiFiStorageFile file = WiFiStorage.open(MQTT_CRED_FILE);
+byte TriSensorWiFi::write_wifi_cache() {
+  int c = 0;
+  WiFiStorageFile file = WiFiStorage.open(WIFI_CACHE_FILE);
 
   if (file) {
-    file.seek(0);
     file.erase();
-
-    #ifdef DBGON
-    Serial.print("* Erased mqtt credentials file : ");
-    Serial.println(file);
-    #endif
-
-    file.close();
-    return (1);
   }
-  else {
-    #ifdef DBGON
-    Serial.println("* Could not erase mqtt credentials file. This might mean the file does not exist.");
-    #endif
 
-    file.close();
-    return (0);
-  }
-}
+  c = file.write(&wifi_cache, sizeof(wifi_cache));
+  file.close();
 
-/**
- * Checks whether the WiFi credential file exists
- * @return boolean true if the file is found, false if it is NOT found
-*/
-bool TriSensorWiFi::check_wifi_credential_file() {
-  WiFiStorageFile file = WiFiStorage.open(WIFI_CRED_FILE);
+  #ifdef DBGON
+  Serial.print("* Wrote cached network settings. Total bytes: ");
+  Serial.println(c);
+  #endif
 
-  if (file) {
-    #ifdef DBGON
-    Serial.print("* WiFi credentials file found: ");
-    Serial.println(WIFI_CRED_FILE);
-    #endif
-    file.close();
-    return true;
-  }
-  else {
-    #ifdef DBGON
-    Serial.print("* WiFi credential file NOT found: ");
-    Serial.println(WIFI_CRED_FILE);
-    #endif
-    file.close();
-    return false;
-  }
+  return (c);
 }
 
 /**
- * Checks whether the MQTT credential file exists
- * @return boolean true if the file is found, false if it is NOT found
+ * Drops the cached network settings from RAM and flash.
+ * @return 1 if the cache file was erased, 0 if there was none.
  */
-bool TriSensorWiFi::check_mqtt_credential_file() {
-  WiFiStorageFile file = WiFiStorage.open(MQTT_CRED_FILE);
+byte TriSensorWiFi::erase_wifi_cache() {
+  memset(&wifi_cache, 0, sizeof(wifi_cache));
+
+  WiFiStorageFile file = WiFiStorage.open(WIFI_CACHE_FILE);
 
   if (file) {
-    #ifdef DBGON
-    Serial.print("* MQTT credentials file found: ");
-    Serial.println(MQTT_CRED_FILE);
-    #endif
-    file.close();
-    return true;
-  }
-  else {
-    #ifdef DBGON
-    Serial.print("* MQTT credential file NOT found: ");
-    Serial.println(MQTT_CRED_FILE);
-    #endif
+    file.erase();
     file.close();
-    return false;
+    return (1);
   }
+
+  file.close();
+  return (0);
 }
 
 /* Set RGB led on uBlox Module R-G-B , max 128*/
@@ -913,15 +1013,10 @@ void TriSensorWiFi::url_decode(char *dst, const char *src) {
 }
 
 /**
- * Replaces a char array containing an encuded url string with its decoded equivalent
+ * Replaces a char array containing an encuded url string with its decoded equivalent. Decoding never
+ * writes ahead of where it reads, so it needs no second buffer.
  * @param input The url string to be decoded
  */
 void TriSensorWiFi::url_decode_in_place(char *input) {
-  char *orig = input;
-  char decoded[strlen(input)];
-
-  TriSensorWiFi::url_decode(decoded, input);
-
-  input = orig;
-  strcpy(input, decoded);
+  url_decode(input, input);
 }
@@ -9,21 +9,39 @@
 #include "Arduino.h"
 #include <WiFiNINA.h>
 #include <WiFiUdp.h>
+#include <TimeLib.h>
+#include "../settings/settings.h"
+#include "../http/http.h"
+#include "../idle/idle.h"
 
 #define SSIDBUFFERSIZE 32
 #define APCHANNEL  5 // AP wifi channel
 
-#define WIFI_CRED_FILE "/fs/wifi_creds"
-#define MQTT_CRED_FILE "/fs/mqtt_creds"
+#define WIFI_CACHE_FILE "/fs/wifi_cache"
 
 #define MAXCONNECT 3                       // Max number of wifi logon connects before opening AP
 #define ESCAPECONNECT 15                   // Max number of Total wifi logon retries-connects before escaping/stopping the Wifi start
+#define FASTCONNECT_MAX_AGE_S 43200        // Lease age before renewing it with a full DHCP connect, half a typical 1 day lease
+#define WIFI_ATTEMPT_TIMEOUT_MS 10000      // Max time for one join before retrying
+#define WIFI_POLL_MS 50                    // Time between NINA status checks in start()
+#define WIFI_END_TIMEOUT_MS 200            // Max wait in end() for the NINA to report the network left
+#define WIFI_END_POLL_MS 10                // Time between NINA status checks in end(), CPU idle
+#define WIFI_PORTAL_POLL_MS 20             // Time between portal polls in start(), bounds the time to first byte
+
+// Define the AP portal's web server
+#define PORTAL_MAX_CLIENTS 4               // Connections served at once, phones open a few each
+#define PORTAL_CLIENT_TIMEOUT_MS 5000      // Closes a connection that sent nothing for this long
+#define PORTAL_READ_CHUNK 64               // Bytes read from a socket per SPI transfer
+#define PORTAL_BODY_MAX 1024               // Largest form body, all fields at their maxlength URL-encoded
+#define PORTAL_CLOSE_DELAY_MS 2000         // Lets the reply to the form go out before the AP is closed
+#define PORTAL_WRITE_CHUNK 1024            // Bytes per socket write, one SPI transfer the NINA's socket takes whole
 
 // Define UDP settings for DNS
-#define UDP_PACKET_SIZE 1024          // UDP packet size time out, preventign too large packet reads
+#define UDP_PACKET_SIZE 512           // Largest query read, the classic DNS UDP limit; the rest of a longer one is dropped
 #define DNSHEADER_SIZE 12             // DNS Header
 #define DNSANSWER_SIZE 16             // DNS Answer = standard set with Packet Compression
-#define DNSMAXREQUESTS 32             // trigger first DNS requests, to redirect to own web-page
+#define DNSNAME_MAX 255               // Longest QNAME, length octets included
+#define DNS_DRAIN_MAX 16              // Queries answered per portal poll at most, so the web server isn't starved
 #define UDPPORT  53                   // local port to listen for UDP packets
 
 // Define RGB values for NINALed
@@ -34,23 +52,59 @@
 #define OPENING_AP 6,0,10         //PURPLE
 #define CLIENT_CONNECTED 0,6,10   //CYAN
 
-struct WiFiCreds {
-  char ssid[32] = "";
-  char password[32] = "";
+// Network settings from the last successful DHCP connect, reused as a static config to skip DHCP.
+struct WiFiCache {
+  uint8_t valid;
+  uint8_t bssid[6];
+  uint8_t ip[4];
+  uint8_t gateway[4];
+  uint8_t dns[4];
+  uint8_t subnet[4];
+  uint32_t leased_at;   // Epoch time of the DHCP connect, 0 to renew the lease on the next connect
 };
 
-struct MqttCreds {
-  char host[128];
-  char port[8];
-  char username[32];
-  char password[32];
+enum WiFiState : uint8_t {
+  WIFI_IDLE,          // No connection started
+  WIFI_FAST_CONNECT,  // Joining with the cached network settings
+  WIFI_RESET,         // Waiting for the NINA to settle after a disconnect
+  WIFI_CONNECTING,    // Joining with DHCP, up to MAXCONNECT attempts
+  WIFI_AP_START,      // Waiting for the NINA to leave station mode before opening the AP
+  WIFI_PORTAL,        // AP portal open, waiting for credentials
+  WIFI_CONNECTED,
+  WIFI_FAILED         // Timed out, or the network can't be joined and the portal isn't allowed
 };
 
+// A portal page, minified and compressed at build time into portal_pages.h (see sim/tools/portal_assets).
+struct PortalAsset {
+  const char *content_type;
+  const uint8_t *gzip;
+  uint16_t gzip_length;
+  const uint8_t *identity;   // Minified, for clients that don't take gzip
+  uint16_t identity_length;
+  uint32_t etag;             // CRC-32 of the minified page
+};
+
+// A portal connection, parsed across polls until its request is complete.
+struct PortalClient {
+  WiFiClient client;
+  HttpRequest request;
+  unsigned long last_ms;   // Last time bytes arrived
+  bool active;
+};
+
+typedef void (*WiFiStateCallback)(WiFiState state);
+
 class TriSensorWiFi {
   public:
     TriSensorWiFi();
     int status();
     void start();
+    void begin_connect(unsigned long timeout_ms, bool portal);
+    WiFiState poll();
+    bool connecting();
+    WiFiState state();
+    void on_state_change(WiFiStateCallback callback);
+    bool has_credentials();
     bool erase();
     byte apname(char *name);
     void end();
@@ -58,21 +112,7 @@ class TriSensorWiFi {
     void get_name(char *name);
 
   private:
-    byte dns_reply_header[DNSHEADER_SIZE] = {
-      0x00,
-      0x00, // ID, to be filled in #offset 0
-      0x81,
-      0x80, // answer header Codes
-      0x00,
-      0x01, //QDCOUNT = 1 question
-      0x00,
-      0x01, //ANCOUNT = 1 answer
-      0x00,
-      0x00, //NSCOUNT / ignore
-      0x00,
-      0x00 //ARCOUNT / ignore
-    };
-
+    // Answer to an A query, appended after the question. The address is filled in once the AP is up.
     byte dns_reply_answer[DNSANSWER_SIZE] = {
       0xc0,
       0x0c, // pointer to pos 12 : NAME Labels
@@ -95,37 +135,62 @@ class TriSensorWiFi {
     char ap_name[SSIDBUFFERSIZE];
     int ap_status = WL_IDLE_STATUS;
     int ap_input_flag;
+    unsigned long ap_close_ms = 0;         // When the AP closes, once ap_input_flag is set
+
+    WiFiState wifi_state = WIFI_IDLE;
+    WiFiStateCallback state_callback = NULL;
+    unsigned long connect_started_ms = 0;
+    unsigned long connect_timeout_ms = 0;
+    unsigned long attempt_started_ms = 0;
+    unsigned long resume_ms = 0;           // poll() does nothing before this time
+    bool portal_allowed = true;
+    bool joining = false;                  // A WiFi.begin() is in progress
+    int conn_attempts = 0;
+
+    Settings settings = {};
+    bool settings_loaded = false;          // Read from flash once, then kept in RAM
+    struct WiFiCache wifi_cache = {};
+    bool wifi_cache_loaded = false;
 
-    struct WiFiCreds wifi_creds = {};
-    struct MqttCreds mqtt_creds = {};
-
-    char sensor_name[32];
-
-    int dns_client_port;
     int dns_req_count = 0;
 
-    byte udp_packet_buffer[UDP_PACKET_SIZE];
+    byte udp_packet_buffer[UDP_PACKET_SIZE];    // A query, turned into its reply in place
+
+    PortalClient portal_clients[PORTAL_MAX_CLIENTS] = {};
+    char portal_body[PORTAL_BODY_MAX + 1];
+    int8_t portal_body_owner = -1;         // Slot of the connection lent portal_body, -1 if free
 
     WiFiServer web_server = WiFiServer(80);
     WiFiUDP udpap_dns;
     IPAddress ap_ipaddr;
-    IPAddress client_ipaddr;
 
     static void url_decode(char *dst, const char *src);
     static void url_decode_in_place(char *input);
 
-    bool check_wifi_credential_file();
-    byte erase_wifi_credentials();
-    byte write_wifi_credentials();
-    byte read_wifi_credentials();
-
-    bool check_mqtt_credential_file();
-    byte erase_mqtt_credentials();
-    byte write_mqtt_credentials();
-    byte read_mqtt_credentials();
-
-    void ap_wifi_client_check();
+    bool load_settings();
+
+    void set_state(WiFiState state);
+    void pause(unsigned long ms);
+    void reset_connection();
+    void connect_failed();
+    void poll_connect();
+    void poll_portal();
+    bool begin_fast_connect();
+    void poll_fast_connect();
+    void update_wifi_cache();
+    byte read_wifi_cache();
+    byte write_wifi_cache();
+    byte erase_wifi_cache();
+
+    void portal_accept();
+    void portal_service(uint8_t slot);
+    void portal_respond(uint8_t slot);
+    void portal_send_page(uint8_t slot, const PortalAsset &page, bool cacheable);
+    void portal_reply(uint8_t slot, uint16_t status);
+    void portal_close(uint8_t slot);
+    bool apply_portal_form(char *body);
     void ap_dns_scan();
+    uint16_t ap_dns_reply(uint16_t length);
     void list_networks();
     void ap_setup();
     void print_wifi_status();
@@ -8,10 +8,23 @@
 #include <DHT.h>
 #include <DHT_U.h>
 #include <ArduinoLowPower.h>
-#include <Battery.h>
 
 #include "config.h"
 #include "src/wifi/wifi.h"
+#include "src/timekeeper/timekeeper.h"
+#include "src/telemetry/telemetry.h"
+#include "src/logstore/logstore.h"
+#include "src/discovery/discovery.h"
+#include "src/hash/hash.h"
+#include "src/idle/idle.h"
+#include "src/backlog/backlog.h"
+#include "src/connect/connect.h"
+#include "src/report/report.h"
+#include "src/schedule/schedule.h"
+#include "src/adc/adc.h"
+#include "src/battery/battery.h"
+#include "src/sensors/sensors.h"
+#include "src/trace/trace.h"
 
 // The current consumption of both the DHT22 and the photoresistor circuit is less than 1mA, well
 // below the max of the Digital IO pins. Use Digital IO pins to power these only when necessary to
@@ -23,20 +36,66 @@
 #define DHT_INPUT 7
 #define PHOTORES_INPUT A1
 
+// Photoresistor divider readings, on the ADC burst's 0..65520 scale, that map to 0% and 100%
+// illuminance. Measure them on the board in the dark and in direct light. Define
+// ILLUMINANCE_LOG_RESPONSE in config.h for a log mapping between them.
+#ifndef PHOTORES_DARK_COUNTS
+#define PHOTORES_DARK_COUNTS 5760
+#endif
+#ifndef PHOTORES_BRIGHT_COUNTS
+#define PHOTORES_BRIGHT_COUNTS 55680
+#endif
+
 // Connecting this pin to ground and restarting will clear the wifi/mqtt stored values in flash.
 #define RESET_PIN 14
 #define FW_VERSION "0.2.0"
 
+// Max number of samples kept in RAM between transmissions. RAM is retained in deep sleep.
+#define BATCH_MAX_SAMPLES 12
+
+// After a failed transmission the oldest buffered samples are spilled to the flash backlog in chunks
+// while this many or more are buffered, so the buffer never fills up and drops one.
+#define BACKLOG_SPILL_AT (BATCH_MAX_SAMPLES - 2)
+
+// Backfill publishes per wake at most, each up to BATCH_MAX_SAMPLES samples from the flash backlog.
+#define BACKFILL_MAX_PUBLISHES 6
+
+// The MQTT client copies a publish into its write buffer, so that fits the packet header, a topic and
+// the largest payload. The only messages received are the retained discovery configs checked at boot,
+// under 500 B with topic and header for the longest device name, and the read buffer fits those.
+#define MQTT_PAYLOAD_SIZE (128 + BATCH_MAX_SAMPLES * 112)
+#define MQTT_HEADER_SIZE 72     // Fixed header, a topic of up to 59 characters and the packet ID
+#define MQTT_READ_SIZE 640
+
+// Samples per transmission, can be overridden in config.h. The radio stays off on the wakes in between.
+#ifndef BATCH_SIZE
+#define BATCH_SIZE 1
+#endif
+
+// Wakes fall on fixed slots of absolute time, at an offset within update_interval_ms derived from the
+// client ID. Define WAKE_PHASE_MS in config.h to assign the offset instead.
+#define SCHEDULE_HASH_SEED 0x9e3779b9UL   // Hashes the client ID for the wake phase and random()
+
+// Define STATE_PAYLOAD_PACKED in config.h to publish the packed binary state (see telemetry.h) on
+// <base topic>/packed instead of JSON on the state topic. sim/tools/state_bridge republishes it as
+// JSON for Home Assistant.
+
 RTCZero rtc = RTCZero();
 
 WiFiUDP ntpUDP = WiFiUDP();
 WiFiClient net = WiFiClient();
 
 NTPClient ntp = NTPClient(ntpUDP, "us.pool.ntp.org");
-MQTTClient mqtt = MQTTClient(512);
+Timekeeper timekeeper = Timekeeper(rtc, ntp);
+MQTTClient mqtt = MQTTClient(MQTT_READ_SIZE, MQTT_HEADER_SIZE + MQTT_PAYLOAD_SIZE);
 DHT dht(DHT_INPUT, DHT_TYPE);
 
 TriSensorWiFi wifi;
+AdcBurst adc;
+LogStore state_log; // State rewritten on most wakes, begun the first time the NINA is up
+SampleBacklog backlog(state_log); // Samples that couldn't be published, oldest first
+BacklogStats backlog_reported = {}; // Backlog counters last published to the backlog topic
+uint16_t backlog_reported_depth = 0;
 
 char APName[] = "Tri-Sensor";
 
@@ -44,31 +103,75 @@ char clientId[13];
 
 char base_topic[60];
 char state_topic[60];
+char packed_state_topic[60];
 char availability_topic[60];
+char backfill_topic[60];
+char backlog_topic[60];
+
+unsigned long update_interval_ms = 5 * 60 * 1000; // 5 minutes. Nominal time between samples.
+unsigned long min_update_interval_ms = 60 * 1000; // Floor while the values change fast
+unsigned long max_update_interval_ms = 30 * 60 * 1000; // Ceiling when the battery is nearly empty
+unsigned long heartbeat_interval_s = 60 * 60; // Max time between reports while the values are stable
+int batch_size = BATCH_SIZE;
+// NINA boot time after reset, based on value here: https://www.element14.com/community/community/project14/iot-in-the-cloud/blog/2019/05/27/the-windchillator-reducing-the-sleep-current-of-the-arduino-mkr-wifi-1010-to-800-ua
+unsigned long nina_boot_ms = 2600;
+unsigned long nina_released_ms = 0;
+bool nina_released = false;
+unsigned long wifi_connect_timeout_ms = 30000; // Max time for a wake's connect, fast reconnect and full connects
+unsigned long wifi_poll_ms = 50; // Time between NINA status checks while connecting
+int publish_ack_timeout_ms = 5000; // Max wait for the broker's PUBACK before shutting the radio down
+int discovery_verify_ms = 1000; // Max wait for the broker to return the retained discovery configs
+unsigned long discovery_poll_ms = 10; // Time between reads of the broker's messages while verifying
+unsigned int discovery_retained = 0; // Retained discovery configs received while verifying
+bool discovery_checked = false; // Discovery published or found unchanged since boot
+int mqtt_connect_attempts = 3; // Max broker connects per wake
+unsigned long mqtt_retry_ms = 1000; // Pause after the first refused connect, doubled after each one
+unsigned long connect_backoff_base_s = 5 * 60; // Wait after a wake that couldn't connect, doubled per failed wake
+unsigned long connect_backoff_max_s = 60 * 60; // Longest wait between wakes that connect
+unsigned long connect_budget_mas = 1000; // Max charge a wake spends connecting, WiFi and broker together
+unsigned int nina_radio_ma = 85; // NINA current with WiFi up, turns the budget into radio time
+
+Sample samples[BATCH_MAX_SAMPLES];
+int sample_count = 0;
+
+ReportPolicy report_policy = ReportPolicy(heartbeat_interval_s);
+SampleScheduler scheduler = SampleScheduler(update_interval_ms, min_update_interval_ms, max_update_interval_ms);
+ConnectPolicy connect_policy = ConnectPolicy(state_log, connect_backoff_base_s, connect_backoff_max_s,
+                                             connect_budget_mas, nina_radio_ma);
+
+char mqtt_payload[MQTT_PAYLOAD_SIZE]; // Outgoing messages are written here, never on the heap
 
-char sensor_id_t[16];
-char sensor_id_h[16];
-char sensor_id_i[16];
-char sensor_id_b[16];
-
-char temperature_config_topic[60];
-char humidity_config_topic[60];
-char illuminance_config_topic[60];
-char battery_config_topic[60];
-
-String temperature_disc_payload;
-String humidity_disc_payload;
-String illuminance_disc_payload;
-String battery_disc_payload;
-
-unsigned long update_interval_ms = 5 * 60 * 1000; // 5 minutes
-
-int BAT_MIN_MV = 3200;
-int BAT_MAX_MV = 4100;
 float DIVIDER_RATIO = (1200.0 + 330.0) / 1200.0; // From MKR1010 Schematic -> See R8 & R9
 int ADC_REF_VOLTAGE = 3300;
 
-Battery battery(BAT_MIN_MV, BAT_MAX_MV, ADC_BATTERY);
+// Open circuit voltage of a single cell LiPo at 0%, 10%, ... 100% charge.
+const uint16_t battery_ocv_mv[] = {3270, 3690, 3740, 3770, 3790, 3820, 3870, 3920, 3980, 4060, 4150};
+
+BatteryMonitor battery(adc, ADC_BATTERY, ADC_REF_VOLTAGE, DIVIDER_RATIO, battery_ocv_mv);
+
+// Entities exposed to Home Assistant by each driver, value_key being the sensor's key in the state payload.
+constexpr SensorDescriptor dht_entities[] = {
+  // suffix, device class, name, unit, value key
+  {"t", "temperature", " Temperature", "°C", "temperature"},
+  {"h", "humidity", " Humidity", "%", "humidity"},
+};
+constexpr SensorDescriptor photoresistor_entities[] = {
+  {"i", "illuminance", " Illuminance", "%", "illuminance"},
+};
+constexpr SensorDescriptor battery_entities[] = {
+  {"b", "battery", " Tri-Sensor Battery", "%", "battery"},
+  {"v", "voltage", " Battery Voltage", "V", "battery_voltage"},
+  {"vl", "voltage", " Battery Voltage Under Load", "V", "battery_loaded_voltage"},
+};
+
+DhtSensor dht_sensor(dht, DHT22_PWR, dht_entities);
+PhotoresistorSensor photoresistor_sensor(adc, PHOTORES_INPUT, PHOTORES_PWR, PHOTORES_DARK_COUNTS,
+                                         PHOTORES_BRIGHT_COUNTS, photoresistor_entities);
+BatterySensor battery_sensor(battery, battery_entities);
+
+// Every sensor the device samples. Add a driver here to add a sensor.
+SensorDriver *const sensor_drivers[] = {&dht_sensor, &photoresistor_sensor, &battery_sensor};
+SensorRegistry sensors(sensor_drivers);
 
 void setup() {
   Serial.begin(115200);
@@ -84,9 +187,11 @@ void setup() {
   pinMode(LED_BUILTIN, OUTPUT);
   digitalWrite(LED_BUILTIN, LOW);
 
-  pinMode(DHT22_PWR,OUTPUT);
-  pinMode(PHOTORES_PWR,OUTPUT);
-  sensorPwrDisable();
+  sensors.setup();
+
+  // Before the NINA boots, the one rest measurement the first sample can use.
+  battery.begin();
+  battery.measure_rest();
 
   if (wifi.status() == WL_NO_SHIELD) { // check for the presence of wifi shield:
     Serial.println("WiFi shield not present");
@@ -107,8 +212,7 @@ void setup() {
   Serial.println(WiFi.firmwareVersion());
 
   wifi.apname(APName);
-  Serial.println("Starting MyTriSensorWiFi");
-  wifi.start();
+  wifi.on_state_change(wifiStateChanged);
 
   byte mac[6];
   WiFi.macAddress(mac);
@@ -116,97 +220,457 @@ void setup() {
   Serial.print("Client ID: ");
   Serial.println(clientId);
 
-  buildSensorIds();
   buildTopicNames();
-  buildDiscoveryPayloads();
+
+  uint32_t client_hash = fnv1a(SCHEDULE_HASH_SEED, clientId, strlen(clientId));
+
+  // The backoff's jitter differs between devices, and between boots of one device.
+  randomSeed(client_hash ^ battery.rest_mv() ^ micros());
+
+  // Devices powered up together wake at their own phase, and keep it across resets.
+#ifdef WAKE_PHASE_MS
+  scheduler.set_phase(WAKE_PHASE_MS);
+#else
+  scheduler.set_phase(client_hash % update_interval_ms);
+#endif
+
+  // The system clock follows the drift corrected RTC. Loop wakes resync it with syncClockToRtc().
+  setSyncInterval(43200); // Seconds between resync of system clock to RTC.  43200 = 12h
+  setSyncProvider(syncClock);
+
+  // The NINA is out of reset from power up.
+  connect_policy.begin();
+
+  if (wifi.has_credentials()) {
+    // Like any wake: within the connect budget, without the portal, and not while a backoff kept
+    // from before the reset is running.
+    connect_policy.begin_wake();
+    if (connect_policy.due(now())) wifiConnect();
+  }
+  else {
+    // Only the portal can get credentials, it stays open until they are entered.
+    Serial.println("Starting MyTriSensorWiFi");
+    wifi.start();
+    connect_policy.begin_wake();
+  }
 
   if (wifi.status() == WL_CONNECTED) {
+    // The sensors settle for the first sample while the clock syncs and discovery is published.
+    sensors.power_up();
+
     ntpClockUpdate();
     syncClockToRtc();
+
     mqttConnect();
     mqttPublishDiscovery();
   }
+
+  // Without a connection the wakes sample and buffer, and retry on the connect policy's backoff.
+  if (mqtt.connected()) {
+    connect_policy.connected();
+  }
   else {
-    Serial.println("Can't start due to failure to connect to WiFi network.");
+    Serial.println("Can't connect at start, retrying on later wakes.");
+    connect_policy.failed(wifi.status() == WL_CONNECTED ? CONNECT_MQTT : CONNECT_WIFI, now());
+    printBackoff();
     wifi.end();
-    LowPower.deepSleep();
+    ninaHold();
   }
 }
 
 void loop() {
+  TRACE_CYCLE_BEGIN();
+
   digitalWrite(LED_BUILTIN, HIGH);
 
-  battery.begin(ADC_REF_VOLTAGE, DIVIDER_RATIO, &sigmoidal);
+  syncClockToRtc();
 
-  mqtt.loop();
+  bool radio_up = wifi.status() == WL_CONNECTED;
 
-  sensorPwrEnable();
+  // The battery is measured at rest before the NINA draws any current.
+  if (!radio_up) battery.measure_rest();
 
-  if (wifi.status() != WL_CONNECTED) {
-    digitalWrite(NINA_RESETN, LOW);
-    // Based on value here: https://www.element14.com/community/community/project14/iot-in-the-cloud/blog/2019/05/27/the-windchillator-reducing-the-sleep-current-of-the-arduino-mkr-wifi-1010-to-800-ua
-    delay(2600);
-    wifi.start();
+  // A heartbeat, or samples left from a failed publish, need the radio whatever this sample reads.
+  // Then the NINA boots while the sensors settle instead of after them. While the connect policy
+  // backs off after failed wakes, the radio stays off whatever is due.
+  bool heartbeat = report_policy.heartbeat_due(now());
+  bool connect_due = connect_policy.due(now());
+  if ((heartbeat || sample_count >= batch_size) && connect_due && !radio_up) {
+    ninaRelease();
+  }
+
+  {
+    // Each sensor is powered just long enough to settle by the time the slowest one has.
+    TRACE_PHASE(PHASE_SENSOR_WARMUP);
+    sensors.settle();
+  }
+
+  Sample sample;
+  takeSample(sample);
+  scheduler.update(sample);
+
+  // The sensors are off before the network round trip starts.
+  sensors.power_down();
+
+  // Samples within the deadbands of the last reported one are dropped, unless a heartbeat is due.
+  if (heartbeat || report_policy.changed(sample)) {
+    bufferSample(sample);
+    report_policy.reported(sample);
+  }
+
+  // Only bring up the radio for a heartbeat or once the buffered samples complete a batch.
+  if (!connect_due || (!heartbeat && sample_count < batch_size && sample_count < BATCH_MAX_SAMPLES)) {
+    // setup() leaves the radio up after publishing discovery; don't keep it on while batching.
+    if (wifi.status() == WL_CONNECTED) {
+      TRACE_PHASE(PHASE_WIFI_END);
+      wifi.end();
+      ninaHold();
+    }
+
+    if (!connect_due) spillWithoutRadio();
+
+    digitalWrite(LED_BUILTIN, LOW);
+
+    TRACE_CYCLE_END();
+
+    LowPower.deepSleep(scheduler.sleep_ms(now()));
+    return;
+  }
+
+  {
+    TRACE_PHASE(PHASE_MQTT_LOOP);
+    mqtt.loop();
+  }
+
+  if (nina_released || wifi.status() != WL_CONNECTED) {
+    TRACE_PHASE(PHASE_WIFI_START);
+    ninaRelease();
+    ninaWaitBoot();
+    connect_policy.begin_wake();
+    wifiConnect();
   }
   else {
-    // If WiFi was already connected, we still need to give the sensor array time to power up.
-    delay(1000);
+    connect_policy.begin_wake();
   }
 
   if (WiFi.status() == WL_CONNECTED && !mqtt.connected()) {
+    TRACE_PHASE(PHASE_MQTT_CONNECT);
     mqttConnect();
   }
 
   if (mqtt.connected()) {
+    connect_policy.connected();
+
+    // Discovery is published on the first connect after boot, which a failed start() leaves to a wake.
+    if (!discovery_checked) mqttPublishDiscovery();
+  }
+  else {
+    connect_policy.failed(WiFi.status() == WL_CONNECTED ? CONNECT_MQTT : CONNECT_WIFI, now());
+    printBackoff();
+  }
+
+  // Again under the radio's load, for the internal resistance and the loaded voltage of this report.
+  if (WiFi.status() == WL_CONNECTED) {
+    batteryUnderLoad();
+  }
+
+  {
+    TRACE_PHASE(PHASE_CLOCK_SYNC);
+
+    // NTP is only queried on wakes that have the radio up anyway, once the clock's estimated error
+    // exceeds its tolerance.
+    if (WiFi.status() == WL_CONNECTED && timekeeper.needs_sync()) {
+      ntpClockUpdate();
+    }
+
     syncClockToRtc();
+  }
+
+  // The state is published at QoS 1, so once publishSamples() returns the broker has it and the
+  // radio can be shut down right away. Unpublished samples stay buffered for the next transmission,
+  // the oldest of them in flash once the buffer fills up.
+  if (mqtt.connected() && publishSamples(state_payload_topic(), samples, sample_count, scheduler.interval_ms() / 1000, NULL)) {
+    sample_count = 0;
+    report_policy.published(sample.time);
+    backfillSamples();
+  }
+  else {
+    spillSamples();
+  }
 
-    dht.begin();
+  {
+    TRACE_PHASE(PHASE_WIFI_END);
+    wifi.end();
+    ninaHold();
+  }
 
-    StaticJsonDocument<200> doc;
+  digitalWrite(LED_BUILTIN, LOW);
 
-    int illum_val = 100 * analogRead(PHOTORES_INPUT) / 1023;
-    char ill_str[6];
+  TRACE_CYCLE_END();
 
-    dtostrf(illum_val, 5, 1, ill_str);
+  LowPower.deepSleep(scheduler.sleep_ms(now()));
+}
 
-    doc["time"] = iso8601_date();
-    doc["temperature"] = dht.readTemperature();
-    doc["humidity"] = dht.readHumidity();
-    doc["illuminance"] = ill_str; // Just a percentage of full scale for now.
-    doc["battery"] = battery.level();
+/**
+ * Takes the NINA out of reset, unless it already is. It boots on its own while the sketch carries on,
+ * ninaWaitBoot() waits for whatever is left of its boot time.
+ */
+void ninaRelease() {
+  if (nina_released) return;
 
-    String msg;
-    serializeJson(doc, msg);
-    mqtt.publish(state_topic, msg);
-    Serial.print("Publishing message: ");
-    Serial.println(msg);
+  digitalWrite(NINA_RESETN, LOW);
+  nina_released_ms = millis();
+  nina_released = true;
+}
+
+void ninaWaitBoot() {
+  TRACE_PHASE(PHASE_NINA_BOOT);
 
-    delay(5000);
+  unsigned long elapsed_ms = millis() - nina_released_ms;
+  if (elapsed_ms < nina_boot_ms) idle_delay(nina_boot_ms - elapsed_ms);
+}
+
+/**
+ * Connects to the stored network without opening the AP portal, which would keep the radio up until
+ * someone enters credentials. The CPU idles between NINA status checks. Gives up after
+ * wifi_connect_timeout_ms, or sooner once the wake's connect budget is spent.
+ * @return true if connected.
+ */
+bool wifiConnect() {
+  unsigned long timeout_ms = min(wifi_connect_timeout_ms, connect_policy.budget_left_ms());
+  if (timeout_ms == 0) return false;
+
+  wifi.begin_connect(timeout_ms, false);
+
+  while (wifi.connecting()) {
+    idle_delay(wifi_poll_ms);
+    wifi.poll();
   }
 
-  wifi.end();
+  return wifi.state() == WIFI_CONNECTED;
+}
+
+void wifiStateChanged(WiFiState state) {
+  if (state == WIFI_PORTAL) {
+    Serial.println("WiFi: opened the AP portal");
+  }
+  else if (state == WIFI_FAILED) {
+    Serial.println("WiFi: giving up on connecting");
+  }
+}
+
+/**
+ * Holds the NINA in reset, its lowest power state.
+ */
+void ninaHold() {
   digitalWrite(NINA_RESETN, HIGH);
+  nina_released = false;
+}
 
-  // Turn off power to DHT22 and light sensor
-  sensorPwrDisable();
+/**
+ * Reads all sensors.
+ */
+void takeSample(Sample &sample) {
+  TRACE_PHASE(PHASE_SENSORS);
 
-  digitalWrite(LED_BUILTIN, LOW);
+  sample.time = now();
+  sensors.sample(sample);
+}
 
-  LowPower.deepSleep(update_interval_ms);
+/**
+ * Measures the battery with WiFi up and gives the latest buffered sample that voltage.
+ */
+void batteryUnderLoad() {
+  battery.measure_loaded();
+  if (sample_count > 0) samples[sample_count - 1].battery_loaded_mv = battery.loaded_mv();
+
+  Serial.print("Battery: ");
+  Serial.print(battery.rest_mv());
+  Serial.print(" mV at rest, ");
+  Serial.print(battery.loaded_mv());
+  Serial.print(" mV under load, ");
+  Serial.print(battery.resistance_mohm());
+  Serial.println(" mOhm");
 }
 
-void sensorPwrEnable() {
-  digitalWrite(DHT22_PWR, HIGH);
-  digitalWrite(PHOTORES_PWR, HIGH);
+/**
+ * Adds a sample to the buffer of samples to publish. When the buffer is full the oldest sample is
+ * dropped.
+ */
+void bufferSample(const Sample &sample) {
+  if (sample_count == BATCH_MAX_SAMPLES) {
+    memmove(&samples[0], &samples[1], (BATCH_MAX_SAMPLES - 1) * sizeof(Sample));
+    sample_count--;
+  }
+
+  samples[sample_count++] = sample;
 }
 
-void sensorPwrDisable() {
-  digitalWrite(DHT22_PWR, LOW);
-  digitalWrite(PHOTORES_PWR, LOW);
+/**
+ * @return The state topic, or the packed state topic when STATE_PAYLOAD_PACKED is defined.
+ */
+const char *state_payload_topic() {
+#ifdef STATE_PAYLOAD_PACKED
+  return packed_state_topic;
+#else
+  return state_topic;
+#endif
+}
+
+/**
+ * Publishes samples as a state message (see serialize_state() for the format), or as a packed record
+ * when STATE_PAYLOAD_PACKED is defined.
+ * The message is sent at QoS 1 and waits up to publish_ack_timeout_ms for the broker's PUBACK.
+ * @param ack_us Set to the time the broker took to acknowledge, if not NULL.
+ * @return true if the broker acknowledged the message.
+ */
+bool publishSamples(const char *topic, const Sample *batch, int count, unsigned long interval_s,
+                    unsigned long *ack_us) {
+  size_t msg_len;
+
+  {
+    TRACE_PHASE(PHASE_SERIALIZE);
+#ifdef STATE_PAYLOAD_PACKED
+    msg_len = pack_state((uint8_t *) mqtt_payload, sizeof(mqtt_payload), batch, count, interval_s);
+#else
+    msg_len = serialize_state(mqtt_payload, sizeof(mqtt_payload), batch, count, interval_s, localTime);
+#endif
+  }
+
+  if (msg_len == 0) {
+    Serial.println("State message doesn't fit the payload buffer.");
+    return false;
+  }
+
+#ifdef STATE_PAYLOAD_PACKED
+  Serial.print("Publishing packed message: ");
+  Serial.print(msg_len);
+  Serial.println(" bytes");
+#else
+  Serial.print("Publishing message: ");
+  Serial.println(mqtt_payload);
+#endif
+
+  bool published;
+  unsigned long elapsed_us;
+  {
+    TRACE_PHASE(PHASE_PUBLISH);
+
+    // Blocks until the PUBACK arrives or the timeout elapses.
+    mqtt.setTimeout(publish_ack_timeout_ms);
+    unsigned long start_us = micros();
+    published = mqtt.publish(topic, mqtt_payload, msg_len, false, 1);
+    elapsed_us = micros() - start_us;
+  }
+
+  if (ack_us) *ack_us = elapsed_us;
+
+  if (published) {
+    Serial.print("Publish acknowledged in ");
+    Serial.print(elapsed_us / 1000.0, 1);
+    Serial.println(" ms");
+  }
+  else {
+    Serial.print("Publish not acknowledged, error ");
+    Serial.println(mqtt.lastError());
+  }
+
+  return published;
+}
+
+/**
+ * After a failed transmission, moves the oldest buffered samples to the flash backlog, a chunk at a
+ * time, until fewer than BACKLOG_SPILL_AT are buffered. Needs the NINA, which the transmission
+ * brought up. A chunk that can't be written stays buffered.
+ */
+void spillSamples() {
+  // Until the clock is first set the samples carry the RTC's time since boot, which ntpClockUpdate()
+  // corrects in RAM only.
+  if (!timekeeper.is_synced()) return;
+
+  while (sample_count >= BACKLOG_SPILL_AT) {
+    if (!backlog.spill(samples, BACKLOG_CHUNK_SAMPLES, scheduler.interval_ms() / 1000)) {
+      Serial.println("Backlog: spill failed");
+      return;
+    }
+
+    sample_count -= BACKLOG_CHUNK_SAMPLES;
+    memmove(&samples[0], &samples[BACKLOG_CHUNK_SAMPLES], sample_count * sizeof(Sample));
+
+    Serial.print("Backlog: spilled ");
+    Serial.print(BACKLOG_CHUNK_SAMPLES);
+    Serial.print(" samples, ");
+    Serial.print(backlog.depth());
+    Serial.println(" in flash");
+  }
+}
+
+/**
+ * While the connect policy backs off, spills the buffered samples to flash once the buffer fills up.
+ * The NINA boots for its storage only, WiFi stays off.
+ */
+void spillWithoutRadio() {
+  if (sample_count < BACKLOG_SPILL_AT || !timekeeper.is_synced()) return;
+
+  TRACE_PHASE(PHASE_BACKLOG_SPILL);
+  ninaRelease();
+  ninaWaitBoot();
+  spillSamples();
+  ninaHold();
+}
+
+/**
+ * Publishes the samples waiting in the flash backlog to the backfill topic, oldest first, in the state
+ * payload's format with their original times. Each message takes as many whole chunks as fit
+ * BATCH_MAX_SAMPLES, up to BACKFILL_MAX_PUBLISHES messages per wake; the rest waits for the next
+ * transmission. Then the backlog metrics go out, retained, if they changed.
+ */
+void backfillSamples() {
+  if (!backlog.begin()) return;
+
+  for (int i = 0; i < BACKFILL_MAX_PUBLISHES && backlog.depth() > 0; i++) {
+    TRACE_PHASE(PHASE_BACKFILL);
+
+    Sample batch[BATCH_MAX_SAMPLES];
+    uint8_t chunks;
+    unsigned long interval_s;
+    unsigned long ack_us;
+
+    int count = backlog.oldest(batch, BATCH_MAX_SAMPLES, &chunks, &interval_s);
+    if (count == 0) break;
+
+    if (!publishSamples(backfill_topic, batch, count, interval_s, &ack_us) || !backlog.release(chunks, ack_us)) {
+      break;
+    }
+  }
+
+  const BacklogStats &stats = backlog.stats();
+  if (backlog.depth() == backlog_reported_depth && memcmp(&stats, &backlog_reported, sizeof(stats)) == 0) return;
+
+  size_t len = backlog.serialize_metrics(mqtt_payload, sizeof(mqtt_payload));
+  if (len > 0 && mqtt.publish(backlog_topic, mqtt_payload, len, true, 1)) {
+    backlog_reported = stats;
+    backlog_reported_depth = backlog.depth();
+
+    Serial.print("Backlog: ");
+    Serial.println(mqtt_payload);
+  }
+}
+
+void printBackoff() {
+  const ConnectState &state = connect_policy.state();
+
+  Serial.print("Connect: ");
+  Serial.print(state.failures);
+  Serial.print(" failed wakes (");
+  Serial.print(state.wifi_failures);
+  Serial.print(" WiFi), next attempt in ");
+  Serial.print(connect_policy.wait_s());
+  Serial.println(" s");
 }
 
 time_t syncClock() {
-  return rtc.getEpoch();
+  return timekeeper.now();
 }
 
 void mac2Char(byte mac[], char str[]) {
@@ -219,24 +683,33 @@ void mac2Char(byte mac[], char str[]) {
 
 void ntpClockUpdate() {
   Serial.print("Setting current time via NTP..");
-  ntp.begin();
-  ntp.update();
 
-  //@todo: Check to see if update successful?
-  rtc.begin();
-  rtc.setEpoch(ntp.getEpochTime());
+  bool was_synced = timekeeper.is_synced();
+  time_t unsynced_time = timekeeper.now();
 
-  // Release the NTP session.
-  ntp.end();
-  Serial.println("Done!");
+  if (!timekeeper.sync()) {
+    Serial.println("Failed");
+    return;
+  }
+
+  // Samples buffered while a failed start() left the clock unset carry the RTC's time since boot.
+  if (!was_synced) {
+    time_t offset = timekeeper.now() - unsynced_time;
+    for (int i = 0; i < sample_count; i++) samples[i].time += offset;
+  }
+
+  Serial.print("Done! RTC drift: ");
+  Serial.print(timekeeper.drift_ppm(), 1);
+  Serial.println(" ppm");
 }
 
 void syncClockToRtc() {
   Serial.print("Sync system clock to RTC..");
-  setSyncInterval(43200); // Seconds between resync of system clock to RTC.  43200 = 12h
-  setSyncProvider(syncClock); // Tells system clock how to sync
 
-  timeStatus() == timeSet ? Serial.println("Success!") : Serial.println("Failed");
+  // SysTick stops in deep sleep, so the system clock is behind after every wake.
+  setTime(syncClock());
+
+  timekeeper.is_synced() ? Serial.println("Success!") : Serial.println("Failed");
 }
 
 bool mqttConnect() {
@@ -252,21 +725,25 @@ bool mqttConnect() {
 
   mqtt.begin(mqtt_host, mqtt_port_int > 1 ? mqtt_port_int : 1883, net);
 
-  mqtt.setKeepAlive(1800); // 1800 seconds = 30 minutes
+  // The broker publishes the will 1.5 keep alive intervals after it last heard from us. Between wakes
+  // that is up to a heartbeat interval, so only a missed heartbeat marks the device offline.
+  mqtt.setKeepAlive(heartbeat_interval_s + max_update_interval_ms / 1000);
   // The will message here tells Home Assistant the device status is 'offline' if it can't be reached.
   mqtt.setWill(availability_topic, "offline", true, 1);
 
-  int max_attempts = 30;
-  int j = 0;
-  while (!mqtt.connect(clientId, mqtt_user, mqtt_pass) && j < max_attempts) {
-    Serial.print(".");
-    delay(1000);
-    j++;
-  }
+  // A refused connect is retried after a pause that doubles each time, less a random part of up to
+  // half of it, while the wake's connect budget lasts. A broker that stays down is left to a later
+  // wake (see ConnectPolicy), with the CPU idle in between instead of spinning.
+  unsigned long pause_ms = mqtt_retry_ms;
+  for (int attempt = 1; !mqtt.connect(clientId, mqtt_user, mqtt_pass); attempt++) {
+    if (attempt >= mqtt_connect_attempts || connect_policy.budget_left_ms() < pause_ms) {
+      Serial.println("Failed");
+      return false;
+    }
 
-  if (!mqtt.connected()) {
-    Serial.println("Failed");
-    return false;
+    Serial.print(".");
+    idle_delay(pause_ms - random(pause_ms / 2 + 1));
+    pause_ms *= 2;
   }
 
   Serial.println("Success!");
@@ -276,6 +753,11 @@ bool mqttConnect() {
   return true;
 }
 
+/**
+ * Publishes a retained discovery config for every sensor entity, generated into mqtt_payload.
+ * Publishing is skipped when the set is unchanged since the last time it was published (a hash of it
+ * is kept in flash) and the broker still holds every config.
+ */
 void mqttPublishDiscovery() {
   Serial.print("Publishing MQTT Discovery payloads for sensor..");
 
@@ -284,162 +766,113 @@ void mqttPublishDiscovery() {
     return;
   }
 
-  mqtt.publish(temperature_config_topic, temperature_disc_payload, true, 1);
-  mqtt.publish(humidity_config_topic, humidity_disc_payload, true, 1);
-  mqtt.publish(illuminance_config_topic, illuminance_disc_payload, true, 1);
-  mqtt.publish(battery_config_topic, battery_disc_payload, true, 1);
+  char name[32];
+  wifi.get_name(name);
 
-  Serial.println("Success!");
-}
+  DeviceInfo device = {clientId, name, "Tri-Sensor", "Jeremy Meier", FW_VERSION};
+  char topic[sizeof(DISCOVERY_PREFIX) + sizeof(clientId) + DISCOVERY_SUFFIX_MAX + sizeof("/config")];
 
-void buildTopicNames() {
-  strcat(temperature_config_topic, "homeassistant/sensor/logger_");
-  strcat(temperature_config_topic, clientId);
-  strcat(temperature_config_topic, "_t/config");
+  // Generating the set just to hash it is cheap next to the radio time of publishing it.
+  uint32_t hash = FNV1A_SEED;
 
-  strcat(humidity_config_topic, "homeassistant/sensor/logger_");
-  strcat(humidity_config_topic, clientId);
-  strcat(humidity_config_topic, "_h/config");
+  for (uint8_t i = 0; i < sensors.entity_count(); i++) {
+    const SensorDescriptor &sensor = sensors.entity(i);
+    size_t len = serialize_discovery(mqtt_payload, sizeof(mqtt_payload), sensor, device);
+    size_t topic_len = config_topic(topic, sizeof(topic), clientId, sensor);
 
-  strcat(illuminance_config_topic, "homeassistant/sensor/logger_");
-  strcat(illuminance_config_topic, clientId);
-  strcat(illuminance_config_topic, "_i/config");
+    if (len == 0 || topic_len == 0) {
+      Serial.println("Failed (Discovery doesn't fit the buffers.)");
+      return;
+    }
 
-  strcat(battery_config_topic, "homeassistant/sensor/logger_");
-  strcat(battery_config_topic, clientId);
-  strcat(battery_config_topic, "_b/config");
+    hash = fnv1a(hash, topic, topic_len);
+    hash = fnv1a(hash, mqtt_payload, len);
+  }
 
-  strcat(base_topic, "homeassistant/sensor/logger_");
-  strcat(base_topic, clientId);
+  state_log.begin();
 
-  strcat(state_topic, "homeassistant/sensor/logger_");
-  strcat(state_topic, clientId);
-  strcat(state_topic, "/state");
+  DiscoveryState state;
+  read_discovery_state(state_log, state);
 
-  strcat(availability_topic, "homeassistant/sensor/logger_");
-  strcat(availability_topic, clientId);
-  strcat(availability_topic, "/availability");
-}
+  if (state.hash == hash && discoveryRetained()) {
+    state.skipped++;
+    write_discovery_state(state_log, state);
+    discovery_checked = true;
 
-void buildDiscoveryPayloads() {
-  char name[32];
-  wifi.get_name(name);
+    Serial.print("Skipped (unchanged)");
+    printDiscoveryCounters(state);
+    return;
+  }
+
+  for (uint8_t i = 0; i < sensors.entity_count(); i++) {
+    const SensorDescriptor &sensor = sensors.entity(i);
+    size_t len = serialize_discovery(mqtt_payload, sizeof(mqtt_payload), sensor, device);
+    config_topic(topic, sizeof(topic), clientId, sensor);
+
+    if (!mqtt.publish(topic, mqtt_payload, len, true, 1)) {
+      Serial.println("Failed");
+      return;
+    }
+  }
+
+  state.hash = hash;
+  state.sent++;
+  write_discovery_state(state_log, state);
+  discovery_checked = true;
 
-  char sensor_name[48] = "";
-
-  strcat(sensor_name, name);
-  strcat(sensor_name, " Tri-Sensor");
-
-  Serial.print("Sensor Name: ");
-  Serial.println(sensor_name);
-
-  StaticJsonDocument<512> temperature_doc;
-  temperature_doc["~"] = base_topic;
-  temperature_doc["dev_cla"] = "temperature"; //device_class
-  char temperature_name[48];
-  strcpy(temperature_name, name);
-  temperature_doc["name"] = strcat(temperature_name, " Temperature");
-  temperature_doc["stat_t"] = "~/state"; //state_topic
-  temperature_doc["unit_of_meas"] = "°C"; //unit_of_measurement
-  temperature_doc["val_tpl"] = "{{value_json.temperature}}"; //value_template
-  temperature_doc["avty_t"] = "~/availability"; //availability_topic
-  temperature_doc["uniq_id"] = sensor_id_t; //unique_id
-  JsonObject temperature_dev = temperature_doc.createNestedObject("dev"); //device
-  temperature_dev["name"] = sensor_name; //name
-  temperature_dev["mf"] = "Jeremy Meier"; //manufacturer
-  temperature_dev["mdl"] = "Tri-Sensor"; //model
-  temperature_dev["sw"] = FW_VERSION; //sw_version
-  JsonArray temperature_ids = temperature_dev.createNestedArray("ids"); //identifiers
-  temperature_ids.add(clientId);
-
-  serializeJson(temperature_doc, temperature_disc_payload);
-
-  Serial.print("Temperature discovery:");
-  Serial.println(temperature_disc_payload);
-
-  StaticJsonDocument<512> humidity_doc;
-  humidity_doc["~"] = base_topic;
-  humidity_doc["dev_cla"] = "humidity"; //device_class
-  char humidity_name[48];
-  strcpy(humidity_name, name);
-  humidity_doc["name"] = strcat(humidity_name, " Humidity");
-  humidity_doc["stat_t"] = "~/state"; //state_topic
-  humidity_doc["unit_of_meas"] = "%"; //unit_of_measurement
-  humidity_doc["val_tpl"] = "{{value_json.humidity}}"; //value_template
-  humidity_doc["avty_t"] = "~/availability"; //availability_topic
-  humidity_doc["uniq_id"] = sensor_id_h; //unique_id
-  JsonObject humidity_dev = humidity_doc.createNestedObject("dev"); //device
-  humidity_dev["name"] = sensor_name; //name
-  humidity_dev["mf"] = "Jeremy Meier"; //manufacturer
-  humidity_dev["mdl"] = "Tri-Sensor"; //model
-  humidity_dev["sw"] = FW_VERSION; //sw_version
-  JsonArray humidity_ids = humidity_dev.createNestedArray("ids"); //identifiers
-  humidity_ids.add(clientId);
-
-  serializeJson(humidity_doc, humidity_disc_payload);
-
-  Serial.print("Humidity discovery:");
-  Serial.println(humidity_disc_payload);
-
-  StaticJsonDocument<512> illuminance_doc;
-  illuminance_doc["~"] = base_topic;
-  illuminance_doc["dev_cla"] = "illuminance"; //device_class
-  char illuminance_name[48];
-  strcpy(illuminance_name, name);
-  illuminance_doc["name"] = strcat(illuminance_name, " Illuminance");
-  illuminance_doc["stat_t"] = "~/state"; //state_topic
-  illuminance_doc["unit_of_meas"] = "%"; //unit_of_measurement
-  illuminance_doc["val_tpl"] = "{{value_json.illuminance}}"; //value_template
-  illuminance_doc["avty_t"] = "~/availability"; //availability_topic
-  illuminance_doc["uniq_id"] = sensor_id_i; //unique_id
-  JsonObject illuminance_dev = illuminance_doc.createNestedObject("dev"); //device
-  illuminance_dev["name"] = sensor_name; //name
-  illuminance_dev["mf"] = "Jeremy Meier"; //manufacturer
-  illuminance_dev["mdl"] = "Tri-Sensor"; //model
-  illuminance_dev["sw"] = FW_VERSION; //sw_version
-  JsonArray illuminance_ids = illuminance_dev.createNestedArray("ids"); //identifiers
-  illuminance_ids.add(clientId);
-
-  serializeJson(illuminance_doc, illuminance_disc_payload);
-
-  Serial.print("Illuminance discovery:");
-  Serial.println(illuminance_disc_payload);
-
-  StaticJsonDocument<512> battery_doc;
-  battery_doc["~"] = base_topic;
-  battery_doc["dev_cla"] = "battery"; //device_class
-  char battery_name[64];
-  strcpy(battery_name, name);
-  battery_doc["name"] = strcat(battery_name, " Tri-Sensor Battery");
-  battery_doc["stat_t"] = "~/state"; //state_topic
-  battery_doc["unit_of_meas"] = "%"; //unit_of_measurement
-  battery_doc["val_tpl"] = "{{value_json.battery}}"; //value_template
-  battery_doc["avty_t"] = "~/availability"; //availability_topic
-  battery_doc["uniq_id"] = sensor_id_b; //unique_id
-  JsonObject battery_dev = battery_doc.createNestedObject("dev"); //device
-  battery_dev["name"] = sensor_name; //name
-  battery_dev["mf"] = "Jeremy Meier"; //manufacturer
-  battery_dev["mdl"] = "Tri-Sensor"; //model
-  battery_dev["sw"] = FW_VERSION; //sw_version
-  JsonArray battery_ids = battery_dev.createNestedArray("ids"); //identifiers
-  battery_ids.add(clientId);
-
-  serializeJson(battery_doc, battery_disc_payload);
-
-  Serial.print("Battery discovery:");
-  Serial.println(battery_disc_payload);
+  Serial.print("Success!");
+  printDiscoveryCounters(state);
 }
 
-void buildSensorIds() {
-  strcat(sensor_id_t, clientId);
-  strcat(sensor_id_t, "_t");
+/**
+ * Checks that the broker still holds every discovery config, by subscribing to the config topics and
+ * counting the retained messages it sends back.
+ * @return true if all of them arrived within discovery_verify_ms.
+ */
+bool discoveryRetained() {
+  char topic[sizeof(DISCOVERY_PREFIX) + sizeof(clientId) + DISCOVERY_SUFFIX_MAX + sizeof("/config")];
+
+  discovery_retained = 0;
+  mqtt.onMessage(countRetainedDiscovery);
+
+  for (uint8_t i = 0; i < sensors.entity_count(); i++) {
+    config_topic(topic, sizeof(topic), clientId, sensors.entity(i));
+    mqtt.subscribe(topic, 0);
+  }
+
+  unsigned long start_ms = millis();
+  while (discovery_retained < sensors.entity_count() && millis() - start_ms < (unsigned long) discovery_verify_ms) {
+    mqtt.loop();
+    idle_delay(discovery_poll_ms);
+  }
+
+  for (uint8_t i = 0; i < sensors.entity_count(); i++) {
+    config_topic(topic, sizeof(topic), clientId, sensors.entity(i));
+    mqtt.unsubscribe(topic);
+  }
+  mqtt.onMessage(NULL);
+
+  return discovery_retained >= sensors.entity_count();
+}
 
-  strcat(sensor_id_h, clientId);
-  strcat(sensor_id_h, "_h");
+void countRetainedDiscovery(String &, String &payload) {
+  if (payload.length() > 0) {
+    discovery_retained++;
+  }
+}
 
-  strcat(sensor_id_i, clientId);
-  strcat(sensor_id_i, "_i");
+void printDiscoveryCounters(const DiscoveryState &state) {
+  Serial.print(" Discovery rounds sent: ");
+  Serial.print(state.sent);
+  Serial.print(", skipped: ");
+  Serial.println(state.skipped);
+}
 
-  strcat(sensor_id_b, clientId);
-  strcat(sensor_id_b, "_b");
+void buildTopicNames() {
+  snprintf(base_topic, sizeof(base_topic), DISCOVERY_PREFIX "%s", clientId);
+  snprintf(state_topic, sizeof(state_topic), DISCOVERY_PREFIX "%s/state", clientId);
+  snprintf(packed_state_topic, sizeof(packed_state_topic), DISCOVERY_PREFIX "%s/packed", clientId);
+  snprintf(availability_topic, sizeof(availability_topic), DISCOVERY_PREFIX "%s/availability", clientId);
+  snprintf(backfill_topic, sizeof(backfill_topic), DISCOVERY_PREFIX "%s/backfill", clientId);
+  snprintf(backlog_topic, sizeof(backlog_topic), DISCOVERY_PREFIX "%s/backlog", clientId);
 }